@@ -49,6 +49,17 @@ typedef struct _dl_info {
  */
 __BEGIN_DECLS
 void	*dlopen(const char *, int);
+/*
+ * Load on the loader task. The callback is called on the loader task with
+ * the handle, or NULL if the load failed and dlerror() has the reason.
+ */
+typedef void (*dlopen_callback)(void *, void *);
+int	dlopen_async(const char *, int, dlopen_callback, void *);
+/*
+ * Load a batch of modules with one resolve. The handle of each name is set
+ * and is NULL if its load failed. Returns the number of modules loaded.
+ */
+int	dlopen_batch(const char **, int, int, void **);
 int	dlclose(void *);
 void	*dlsym(void * __restrict, const char * __restrict);
 #if defined(_NETBSD_SOURCE)
@@ -0,0 +1,148 @@
+/*
+ *  The license and distribution terms for this file may be
+ *  found in the file LICENSE in this distribution or at
+ *  http://www.rtems.org/license/LICENSE.
+ */
+/**
+ * @file
+ *
+ * @ingroup rtems_rtl
+ *
+ * @brief RTEMS Run-Time Linker Allocation Recorder
+ *
+ * The recorder is an allocator hook that records each allocation and free
+ * in a ring buffer and passes the request to the previous allocator. The
+ * allocations made in a memory region, a slab cache or an arena do not call
+ * the allocator and are recorded by the allocator. The records can be
+ * written to a file and replayed off target against other allocators with
+ * the host replayer in libdl/host.
+ *
+ * This header is included by the host replayer and only depends on the C
+ * library.
+ */
+
+#if !defined (_RTEMS_RTL_ALLOC_RECORD_H_)
+#define _RTEMS_RTL_ALLOC_RECORD_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * The magic number at the start of a record file, "RTLA".
+ */
+#define RTEMS_RTL_ALLOC_RECORD_MAGIC (0x414c5452UL)
+
+/**
+ * The version of the record file.
+ */
+#define RTEMS_RTL_ALLOC_RECORD_VERSION (2)
+
+/**
+ * The record times are the run time stats counter. If not set the times are
+ * the tick count.
+ */
+#define RTEMS_RTL_ALLOC_RECORD_RUN_TIME (1 << 0)
+
+/**
+ * The record commands are the allocator's new and delete commands.
+ */
+#define RTEMS_RTL_ALLOC_RECORD_NEW (0)
+#define RTEMS_RTL_ALLOC_RECORD_DEL (1)
+
+/**
+ * The source of the memory in a record.
+ */
+#define RTEMS_RTL_ALLOC_RECORD_HEAP        (0) /**< The allocator. */
+#define RTEMS_RTL_ALLOC_RECORD_REGION      (1) /**< A memory region. */
+#define RTEMS_RTL_ALLOC_RECORD_SLAB        (2) /**< A slab cache object. */
+#define RTEMS_RTL_ALLOC_RECORD_ARENA       (3) /**< An arena allocation or
+                                                *   release. */
+#define RTEMS_RTL_ALLOC_RECORD_SOURCE_MASK (0x7f)
+
+/**
+ * The memory holds slabs or arena chunks. The requests made by the loader
+ * are the records without this flag.
+ */
+#define RTEMS_RTL_ALLOC_RECORD_BACKING     (1 << 7)
+
+/**
+ * An allocation record. A free's size is 0. An arena is released with a
+ * single free record with an address of 0. The record is 32 bytes and the
+ * fields are in the target's byte order.
+ */
+typedef struct rtems_rtl_alloc_record
+{
+  uint64_t address;  /**< The address allocated or freed. */
+  uint64_t owner;    /**< The arena of an arena record, otherwise 0. */
+  uint32_t time;     /**< The time the request was made. */
+  uint32_t duration; /**< The time the allocator took. The time of a
+                      *   region, slab or arena request is 0. */
+  uint32_t size;     /**< The size of the allocation. */
+  uint8_t  cmd;      /**< The record command. */
+  uint8_t  tag;      /**< The allocation tag. */
+  uint8_t  source;   /**< The source of the memory and flags. */
+  uint8_t  reserved; /**< Reserved, 0. */
+} rtems_rtl_alloc_record;
+
+/**
+ * The header of a record file. The records follow the header oldest first.
+ */
+typedef struct rtems_rtl_alloc_record_header
+{
+  uint32_t magic;       /**< RTEMS_RTL_ALLOC_RECORD_MAGIC. */
+  uint16_t version;     /**< RTEMS_RTL_ALLOC_RECORD_VERSION. */
+  uint16_t record_size; /**< The size of a record. */
+  uint32_t flags;       /**< The record flags. */
+  uint32_t count;       /**< The number of records in the file. */
+  uint32_t dropped;     /**< The oldest records overwritten in the ring
+                         *   buffer. */
+  uint32_t heap_size;   /**< The size of the RTL heap. */
+} rtems_rtl_alloc_record_header;
+
+/**
+ * Start recording the allocations. The recorder hooks the allocator and
+ * passes the requests to the current allocator. The buffer is a ring and
+ * the oldest records are overwritten when it is full.
+ *
+ * @param buffer The ring buffer for the records.
+ * @param size The size of the buffer in bytes.
+ * @retval true Recording has started.
+ * @retval false The buffer is too small or recording has already started.
+ */
+bool rtems_rtl_alloc_record_start (void* buffer, size_t size);
+
+/**
+ * Stop recording the allocations. The previous allocator is restored if the
+ * recorder is the current allocator otherwise the recorder stops recording
+ * and passes the requests on. The records are held until recording is
+ * started again.
+ */
+void rtems_rtl_alloc_record_stop (void);
+
+/**
+ * Get the header for the records held.
+ *
+ * @param header The header to fill in.
+ */
+void rtems_rtl_alloc_record_header_get (rtems_rtl_alloc_record_header* header);
+
+/**
+ * Write the records held to a file. The file has a header followed by the
+ * records oldest first.
+ *
+ * @param name The file name.
+ * @retval true The records have been written.
+ * @retval false The file could not be written. The error is set.
+ */
+bool rtems_rtl_alloc_record_write (const char* name);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif
@@ -88,6 +88,178 @@ typedef void (*rtems_rtl_allocator)(rtems_rtl_alloc_cmd cmd,
                                     void**              address,
                                     size_t              size);
 
+/**
+ * The default module image setting. A module image holds a module's text,
+ * const, eh, data and bss in a single allocation. MPU compartments need the
+ * fewest regions for a module so default to a module image.
+ */
+#if !defined (RTEMS_RTL_ALLOC_MODULE_IMAGE)
+#if configMPU_COMPARTMENTALIZATION
+#define RTEMS_RTL_ALLOC_MODULE_IMAGE true
+#else
+#define RTEMS_RTL_ALLOC_MODULE_IMAGE false
+#endif
+#endif
+
+/**
+ * The alignment of each part of a module image. It is the alignment the
+ * allocator gives a module's parts when they are separately allocated.
+ */
+#define RTEMS_RTL_ALLOC_MODULE_ALIGN (16)
+
+/**
+ * The number of slab size classes. The smallest class is
+ * RTEMS_RTL_SLAB_MIN_SIZE and each class is twice the size of the previous
+ * class.
+ */
+#define RTEMS_RTL_SLAB_CLASSES (4)
+
+/**
+ * The size of the smallest slab size class.
+ */
+#define RTEMS_RTL_SLAB_MIN_SIZE (32)
+
+/**
+ * The size of the largest slab size class. Larger allocations are passed to
+ * the allocator.
+ */
+#define RTEMS_RTL_SLAB_MAX_SIZE \
+  (RTEMS_RTL_SLAB_MIN_SIZE << (RTEMS_RTL_SLAB_CLASSES - 1))
+
+/**
+ * The memory in a slab for objects. A slab holds no more than 32 objects.
+ */
+#define RTEMS_RTL_SLAB_SIZE (1024)
+
+/**
+ * A slab. The objects follow the header.
+ */
+typedef struct rtems_rtl_slab
+{
+  struct rtems_rtl_slab* next; /**< The next slab in the cache. */
+  uint32_t               free; /**< A bit is set for each free object. */
+} rtems_rtl_slab;
+
+/**
+ * A slab cache holds objects of a single size class in slabs obtained from
+ * the allocator. There is no heap header for each object and an object is
+ * allocated by finding the first set bit in a slab's free bitmap.
+ */
+typedef struct rtems_rtl_slab_cache
+{
+  size_t          size;    /**< The size of an object. */
+  uint32_t        objects; /**< The number of objects in a slab. */
+  rtems_rtl_slab* slabs;   /**< The slabs. */
+  rtems_rtl_slab* current; /**< A slab with free objects or NULL. */
+  size_t          count;   /**< The number of slabs. */
+  size_t          allocs;  /**< The number of objects allocated. */
+} rtems_rtl_slab_cache;
+
+/**
+ * The memory accounting for a tag. The bytes are the bytes of the RTL heap
+ * an allocation takes including the heap's block header. Memory an
+ * allocator hook obtains from elsewhere is counted with no bytes.
+ */
+typedef struct rtems_rtl_alloc_tag_stats
+{
+  size_t live;   /**< The bytes allocated. */
+  size_t peak;   /**< The most bytes allocated at any time. */
+  size_t allocs; /**< The number of allocations. */
+  size_t frees;  /**< The number of frees. */
+} rtems_rtl_alloc_tag_stats;
+
+/**
+ * The allocator statistics.
+ */
+typedef struct rtems_rtl_alloc_stats
+{
+  rtems_rtl_alloc_tag_stats tags[RTEMS_RTL_ALLOC_TAGS]; /**< The tags. */
+  size_t   heap_size;     /**< The size of the RTL heap. */
+  size_t   free;          /**< The bytes free in the heap. */
+  size_t   min_free;      /**< The fewest bytes free at any time. */
+  size_t   largest_free;  /**< The largest free block. */
+  size_t   free_blocks;   /**< The number of free blocks. */
+  uint32_t fragmentation; /**< The percentage of the free memory not in the
+                           *   largest free block. */
+} rtems_rtl_alloc_stats;
+
+/**
+ * A movable allocation. The memory is held by an indirect handle and the
+ * allocator can move it to a lower address to reduce the fragmentation of
+ * the heap.
+ */
+typedef struct rtems_rtl_alloc_movable rtems_rtl_alloc_movable;
+
+/**
+ * A movable allocation's mover. It is called after the memory has been
+ * copied to its new address and before the old memory is freed. It updates
+ * the references to the memory.
+ *
+ * @param movable The movable allocation. The handle holds the new address.
+ * @param old The address the memory has moved from.
+ */
+typedef void (*rtems_rtl_alloc_mover) (rtems_rtl_alloc_movable* movable,
+                                       void*                    old);
+
+struct rtems_rtl_alloc_movable {
+  rtems_rtl_sptr        handle; /**< The memory and its size. */
+  rtems_rtl_alloc_tag   tag;    /**< The tag the memory was allocated with. */
+  rtems_rtl_alloc_mover mover;  /**< The mover. */
+  void*                 arg;    /**< The mover's argument. */
+};
+
+/**
+ * The parts of a module a placement can put in a region.
+ */
+enum rtems_rtl_alloc_parts {
+  RTEMS_RTL_ALLOC_PART_TEXT,  /**< The text. */
+  RTEMS_RTL_ALLOC_PART_CONST, /**< The const data. */
+  RTEMS_RTL_ALLOC_PART_EH,    /**< The exception tables. */
+  RTEMS_RTL_ALLOC_PART_DATA,  /**< The data. */
+  RTEMS_RTL_ALLOC_PART_BSS    /**< The bss. */
+};
+
+/**
+ * The number of module parts.
+ */
+#define RTEMS_RTL_ALLOC_PARTS ((size_t) (RTEMS_RTL_ALLOC_PART_BSS + 1))
+
+/**
+ * The mask of a tag for a region's tags.
+ */
+#define RTEMS_RTL_ALLOC_TAG_MASK(_t) (1UL << (_t))
+
+/**
+ * A named memory region, for example a tightly coupled or on-chip RAM. A
+ * region has a heap of its own in its memory. Allocations with one of the
+ * region's tags are made in the region and fall back to the allocator when
+ * the region is full.
+ */
+typedef struct rtems_rtl_alloc_region
+{
+  ListItem_t  node;  /**< The region's link in the regions. */
+  const char* name;  /**< The region's name. */
+  void*       base;  /**< The base of the region's memory. */
+  size_t      size;  /**< The size of the region's memory. */
+  uint32_t    tags;  /**< The tags allocated in the region. */
+  void*       heap;  /**< The region's heap. */
+} rtems_rtl_alloc_region;
+
+/**
+ * A placement puts the parts of the modules that match its name in
+ * regions. The name is a pattern matched to a module's archive name or to
+ * its object name. A part with no region is allocated by tag.
+ */
+typedef struct rtems_rtl_alloc_placement
+{
+  ListItem_t  node;                           /**< The placement's link. */
+  const char* name;                           /**< The name pattern. */
+  const char* regions[RTEMS_RTL_ALLOC_PARTS]; /**< The region of each part
+                                               *   or NULL. */
+  bool        config;                         /**< The placement is from
+                                               *   the configuration. */
+} rtems_rtl_alloc_placement;
+
 /**
  * The allocator data.
  */
@@ -96,6 +268,18 @@ struct rtems_rtl_alloc_data {
   rtems_rtl_allocator allocator;
   /**< The indirect pointer chains. */
   List_t indirects[RTEMS_RTL_ALLOC_TAGS];
+  /**< The movable allocations. */
+  List_t movables;
+  /**< The memory regions. */
+  List_t regions;
+  /**< The module placements. */
+  List_t placements;
+  /**< Allocate modules as a single image. */
+  bool module_image;
+  /**< The memory accounting for each tag. */
+  rtems_rtl_alloc_tag_stats stats[RTEMS_RTL_ALLOC_TAGS];
+  /**< The slab caches for each tag. */
+  rtems_rtl_slab_cache slabs[RTEMS_RTL_ALLOC_TAGS][RTEMS_RTL_SLAB_CLASSES];
 };
 
 typedef struct rtems_rtl_alloc_data rtems_rtl_alloc_data;
@@ -191,6 +375,236 @@ void rtems_rtl_alloc_indirect_new (rtems_rtl_alloc_tag tag,
 void rtems_rtl_alloc_indirect_del (rtems_rtl_alloc_tag tag,
                                    rtems_rtl_ptr*      handle);
 
+/**
+ * Initialise a movable allocation.
+ *
+ * @param movable The movable allocation to initialise.
+ */
+void rtems_rtl_alloc_movable_init (rtems_rtl_alloc_movable* movable);
+
+/**
+ * Make allocated memory movable. The memory must have been allocated with
+ * rtems_rtl_alloc_new and the tag. Only the mover can update references to
+ * the memory once it is movable.
+ *
+ * @param movable The movable allocation to hold the memory.
+ * @param tag The tag the memory was allocated with.
+ * @param address The memory.
+ * @param size The size of the memory.
+ * @param mover The mover called when the memory is moved.
+ * @param arg The mover's argument.
+ */
+void rtems_rtl_alloc_movable_add (rtems_rtl_alloc_movable* movable,
+                                  rtems_rtl_alloc_tag      tag,
+                                  void*                    address,
+                                  size_t                   size,
+                                  rtems_rtl_alloc_mover    mover,
+                                  void*                    arg);
+
+/**
+ * Stop the memory held by a movable allocation moving. The memory is not
+ * freed. A movable allocation that is not holding memory is ignored.
+ *
+ * @param movable The movable allocation.
+ */
+void rtems_rtl_alloc_movable_remove (rtems_rtl_alloc_movable* movable);
+
+/**
+ * Compact the heap by moving the movable allocations to lower addresses. A
+ * movable allocation is moved if the allocator returns a lower address for
+ * a copy of it. The loader compacts the heap when the memory for a module
+ * cannot be allocated.
+ *
+ * @retval true Memory was moved.
+ * @retval false No memory was moved.
+ */
+bool rtems_rtl_alloc_compact (void);
+
+/**
+ * Get the allocator statistics. The tag accounting is held by the allocator
+ * and the heap figures are taken from the RTL heap.
+ *
+ * @param stats The statistics to fill in.
+ * @retval true The statistics have been filled in.
+ * @retval false The RTL could not be locked.
+ */
+bool rtems_rtl_alloc_stats_get (rtems_rtl_alloc_stats* stats);
+
+/**
+ * Add a named memory region. The memory is given to the region and holds the
+ * region's heap. Allocations with a tag in the tags mask are made in the
+ * region before the allocator. A tags mask of 0 only places the parts of
+ * modules a placement names the region for.
+ *
+ * @param name The region's name.
+ * @param base The base of the region's memory.
+ * @param size The size of the region's memory.
+ * @param tags The mask of tags allocated in the region. Use
+ *             RTEMS_RTL_ALLOC_TAG_MASK to create a tag's mask.
+ * @retval true The region has been added.
+ * @retval false The region could not be added. The error is set.
+ */
+bool rtems_rtl_alloc_region_add (const char* name,
+                                 void*       base,
+                                 size_t      size,
+                                 uint32_t    tags);
+
+/**
+ * Find a memory region by name.
+ *
+ * @param name The region's name.
+ * @retval NULL No region has the name.
+ * @return rtems_rtl_alloc_region* The region.
+ */
+rtems_rtl_alloc_region* rtems_rtl_alloc_region_find (const char* name);
+
+/**
+ * Allocate memory in a named region. If there is no region with the name or
+ * it is full the memory is allocated by tag.
+ *
+ * @param name The region's name. A NULL name allocates by tag.
+ * @param tag The type of allocation request.
+ * @param size The size of the allocation.
+ * @param zero If true the memory is cleared.
+ * @return void* The memory address or NULL is not memory available.
+ */
+void* rtems_rtl_alloc_region_new (const char*         name,
+                                  rtems_rtl_alloc_tag tag,
+                                  size_t              size,
+                                  bool                zero);
+
+/**
+ * Add a module placement. The placement is a list of part and region name
+ * pairs separated by white space or commas, for example "text=itcm
+ * data=dtcm". The parts are text, const, eh, data and bss, and all names
+ * every part. Regions are found by name when a module is allocated so a
+ * region can be added after the placement.
+ *
+ * @param name The pattern matched to a module's archive or object name.
+ * @param placement The placement.
+ * @param config The placement is from the configuration and is removed
+ *               when the configuration is reloaded.
+ * @retval true The placement has been added.
+ * @retval false The placement is not valid or there is no memory. The error
+ *               is set.
+ */
+bool rtems_rtl_alloc_placement_add (const char* name,
+                                    const char* placement,
+                                    bool        config);
+
+/**
+ * Remove the module placements with a name, or the placements from the
+ * configuration if the name is NULL.
+ *
+ * @param name The placement name or NULL.
+ */
+void rtems_rtl_alloc_placement_remove (const char* name);
+
+/**
+ * Find the first module placement that matches a name.
+ *
+ * @param name The module's archive or object name. A NULL is not matched.
+ * @retval NULL No placement matches the name.
+ * @return const rtems_rtl_alloc_placement* The placement.
+ */
+const rtems_rtl_alloc_placement* rtems_rtl_alloc_placement_find (const char* name);
+
+/**
+ * Allocate a small fixed size object from the tag's slab caches. Use it for
+ * records of a few sizes allocated and freed one at a time. A size larger
+ * than RTEMS_RTL_SLAB_MAX_SIZE or a tag for module memory is passed to the
+ * allocator.
+ *
+ * @param tag The type of allocation request.
+ * @param size The size of the allocation.
+ * @param zero If true the memory is cleared.
+ * @return void* The memory address or NULL is not memory available.
+ */
+void* rtems_rtl_alloc_slab_new (rtems_rtl_alloc_tag tag, size_t size, bool zero);
+
+/**
+ * Delete an object allocated from the slab caches. The tag and size must be
+ * the ones the object was allocated with.
+ *
+ * @param tag The type of allocation request.
+ * @param size The size of the allocation.
+ * @param address The memory address to delete. A NULL is ignored.
+ */
+void rtems_rtl_alloc_slab_del (rtems_rtl_alloc_tag tag,
+                               size_t              size,
+                               void*               address);
+
+/**
+ * The default size of an arena chunk.
+ */
+#define RTEMS_RTL_ARENA_CHUNK_SIZE (1024)
+
+/**
+ * An arena chunk. The memory handed out follows the header.
+ */
+typedef struct rtems_rtl_arena_chunk
+{
+  struct rtems_rtl_arena_chunk* next; /**< The next chunk in the arena. */
+  size_t                        size; /**< The size of the chunk's memory. */
+  size_t                        used; /**< The memory used in the chunk. */
+} rtems_rtl_arena_chunk;
+
+/**
+ * An arena hands out memory from chunks obtained from the allocator. The
+ * memory is not freed piece by piece, all of it is released with the
+ * arena. It suits the loader's data that lives as long as an object file.
+ */
+typedef struct rtems_rtl_arena
+{
+  rtems_rtl_alloc_tag    tag;        /**< The tag the chunks are allocated
+                                      *   with. */
+  size_t                 chunk_size; /**< The size of a chunk. */
+  rtems_rtl_arena_chunk* chunks;     /**< The chunks, the current chunk is
+                                      *   first. */
+  size_t                 allocs;     /**< The number of allocations. */
+  size_t                 bytes;      /**< The bytes allocated. */
+} rtems_rtl_arena;
+
+/**
+ * Initialise an arena. No memory is allocated until the first allocation.
+ *
+ * @param arena The arena to initialise.
+ * @param tag The tag the arena's chunks are allocated with.
+ * @param chunk_size The size of a chunk. A size of 0 uses the default.
+ */
+void rtems_rtl_arena_init (rtems_rtl_arena*    arena,
+                           rtems_rtl_alloc_tag tag,
+                           size_t              chunk_size);
+
+/**
+ * Allocate memory from an arena. The memory is aligned to hold any of the
+ * loader's data. An allocation larger than half a chunk is given a chunk
+ * of its own.
+ *
+ * @param arena The arena to allocate from.
+ * @param size The size of the allocation.
+ * @param zero If true the memory is cleared.
+ * @return void* The memory address or NULL is not memory available.
+ */
+void* rtems_rtl_arena_alloc (rtems_rtl_arena* arena, size_t size, bool zero);
+
+/**
+ * Duplicate a string in an arena.
+ *
+ * @param arena The arena to allocate from.
+ * @param s The string to duplicate.
+ * @return char* The duplicated string or NULL is not memory available.
+ */
+char* rtems_rtl_arena_strdup (rtems_rtl_arena* arena, const char* s);
+
+/**
+ * Release all the memory allocated from an arena. The arena can be used
+ * again.
+ *
+ * @param arena The arena to release.
+ */
+void rtems_rtl_arena_release (rtems_rtl_arena* arena);
+
 /**
  * Return the default tag for text sections.
  *
@@ -226,11 +640,35 @@ rtems_rtl_alloc_tag rtems_rtl_alloc_data_tag (void);
  */
 rtems_rtl_alloc_tag rtems_rtl_alloc_bss_tag (void);
 
+/**
+ * Set if modules are allocated as a single image.
+ *
+ * @param image If true allocate a module as a single image.
+ * @return bool The previous setting.
+ */
+bool rtems_rtl_alloc_module_image_set (bool image);
+
+/**
+ * Get if modules are allocated as a single image.
+ *
+ * @retval true Modules are allocated as a single image.
+ * @retval false Each part of a module is allocated separately.
+ */
+bool rtems_rtl_alloc_module_image (void);
+
 /**
  * Allocate the memory for a module given the size of the text, const, data and
  * bss sections. If any part of the allocation fails the no memory is
  * allocated.
  *
+ * A module image is a single allocation with the text tag. The parts are
+ * laid out in the order text, const, eh, data and bss, each aligned to
+ * RTEMS_RTL_ALLOC_MODULE_ALIGN. The allocator is called with each part's
+ * tag and base to set its permissions.
+ *
+ * A placement puts each part in its region and an image in the text part's
+ * region. A part is allocated by tag if its region is full.
+ *
  * @param text_base Pointer to the text base pointer.
  * @param text_size The size of the read/exec section.
  * @param const_base Pointer to the const base pointer.
@@ -241,6 +679,8 @@ rtems_rtl_alloc_tag rtems_rtl_alloc_bss_tag (void);
  * @param data_size The size of the read/write secton.
  * @param bss_base Pointer to the bss base pointer.
  * @param bss_size The size of the read/write.
+ * @param image If true allocate the module as a single image.
+ * @param placement The module's placement or NULL to allocate by tag.
  * @retval true The memory has been allocated.
  * @retval false The allocation of memory has failed.
  */
@@ -248,7 +688,9 @@ bool rtems_rtl_alloc_module_new (void** text_base, size_t text_size,
                                  void** const_base, size_t const_size,
                                  void** eh_base, size_t eh_size,
                                  void** data_base, size_t data_size,
-                                 void** bss_base, size_t bss_size);
+                                 void** bss_base, size_t bss_size,
+                                 bool   image,
+                                 const rtems_rtl_alloc_placement* placement);
 
 /**
  * Free the memory allocated to a module.
@@ -258,10 +700,11 @@ bool rtems_rtl_alloc_module_new (void** text_base, size_t text_size,
  * @param eh_base Pointer to the eh base pointer.
  * @param data_base Pointer to the data base pointer.
  * @param bss_base Pointer to the bss base pointer.
+ * @param image If true the module was allocated as a single image.
  */
 void rtems_rtl_alloc_module_del (void** text_base, void** const_base,
                                  void** eh_base, void** data_base,
-                                 void** bss_base);
+                                 void** bss_base, bool image);
 
 #ifdef __cplusplus
 }
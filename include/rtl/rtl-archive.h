@@ -20,7 +20,8 @@
  * directory of `/etc`. The file is a line per glob'ed path to archives to
  * search for symbols.
  *
- * The archive symbols are held in a per archive cache for searching.
+ * The archive symbols are held in a per archive cache and a directory of the
+ * symbols in all archives for searching.
  *
  * @note Errors in the reading of a config file, locating archives, reading
  *       symbol tables and loading object files are not considered RTL error
@@ -44,6 +45,8 @@ extern "C" {
 #define RTEMS_RTL_ARCHIVE_USER_LOAD (1 << 0) /**< User forced load. */
 #define RTEMS_RTL_ARCHIVE_REMOVE    (1 << 1) /**< The achive is not found. */
 #define RTEMS_RTL_ARCHIVE_LOAD      (1 << 2) /**< Load the achive. */
+#define RTEMS_RTL_ARCHIVE_DIRECTORY (1 << 3) /**< Symbols are in the
+                                              *   archives directory. */
 
 /**
  * Symbol search and loading results.
@@ -61,6 +64,36 @@ typedef enum rtems_rtl_archive_search
                                           *   invalid. */
 } rtems_rtl_archive_search;
 
+/**
+ * Archive refresh modes. A refresh checks the configuration file, scans the
+ * configured paths for archives and checks each archive for changes. This is
+ * file system I/O so it can be limited.
+ */
+typedef enum rtems_rtl_archive_refresh
+{
+  rtems_rtl_archive_refresh_always = 0,   /**< Refresh on every load. */
+  rtems_rtl_archive_refresh_interval = 1, /**< Refresh on a load if the
+                                               interval has elapsed. */
+  rtems_rtl_archive_refresh_explicit = 2  /**< Refresh on a load only after
+                                           *   the archives are marked as
+                                           *   changed. */
+} rtems_rtl_archive_refresh;
+
+/**
+ * The default refresh mode.
+ */
+#if !defined (RTEMS_RTL_ARCHIVE_REFRESH_MODE)
+#define RTEMS_RTL_ARCHIVE_REFRESH_MODE rtems_rtl_archive_refresh_always
+#endif
+
+/**
+ * The default batch load setting. Batch loading collects the object files
+ * needed by all the unresolved symbols and loads them in archive file order.
+ */
+#if !defined (RTEMS_RTL_ARCHIVE_BATCH_LOAD)
+#define RTEMS_RTL_ARCHIVE_BATCH_LOAD false
+#endif
+
 /**
  * RTL Archive symbols.
  */
@@ -70,18 +103,55 @@ typedef struct rtems_rtl_archive_symbol
   const char* label;  /**< The symbol's label. */
 } rtems_rtl_archive_symbol;
 
+/**
+ * RTL Archive symbol hash slot. The hash is held so a probe only compares
+ * the names when the hashes match. A symbol of 0 is an empty slot.
+ */
+typedef struct rtems_rtl_archive_hash_slot
+{
+  uint32_t hash;    /**< The symbol label's hash. */
+  uint32_t symbol;  /**< Index + 1 in the sorted symbol table. */
+} rtems_rtl_archive_hash_slot;
+
 /**
  * RTL Archive symbols.
  */
 typedef struct rtems_rtl_archive_symbols
 {
-  void*                     base;     /**< Base of the symbol table. */
-  size_t                    size;     /**< Size of the symbol table. */
-  size_t                    entries;  /**< Entries in the symbol table. */
-  const char*               names;    /**< Start of the symbol names. */
-  rtems_rtl_archive_symbol* symbols;  /**< Sorted symbol table. */
+  void*                        base;       /**< Base of the symbol table. */
+  size_t                       size;       /**< Size of the symbol table. */
+  size_t                       entries;    /**< Entries in the symbol table. */
+  const char*                  names;      /**< Start of the symbol names. */
+  rtems_rtl_archive_symbol*    symbols;    /**< Sorted symbol table. */
+  rtems_rtl_archive_hash_slot* hash;       /**< Open addressed symbol hash. */
+  size_t                       hash_size;  /**< Hash slots, a power of 2. */
 } rtems_rtl_archive_symbols;
 
+/**
+ * RTL Archive member.
+ */
+typedef struct rtems_rtl_archive_member
+{
+  UBaseType_t offset;  /**< Offset of the member's header in the archive. */
+  size_t      size;    /**< Size of the member. */
+  const char* name;    /**< The member's name. */
+} rtems_rtl_archive_member;
+
+/**
+ * RTL Archive members. The members are read from the archive's headers the
+ * first time a member is loaded and are in archive offset order. The short
+ * names follow the members in the same allocation and the extended names
+ * point into the archive's extended file names table which is read once and
+ * held.
+ */
+typedef struct rtems_rtl_archive_members
+{
+  rtems_rtl_archive_member* members;      /**< The members. */
+  size_t                    count;        /**< Number of members. */
+  char*                     enames;       /**< Extended file names table. */
+  size_t                    enames_size;  /**< Size of the names table. */
+} rtems_rtl_archive_members;
+
 /**
  * RTL Archive data.
  */
@@ -93,8 +163,11 @@ typedef struct rtems_rtl_archive
   UBaseType_t               mtime;    /**< Archive's last modified time. */
   UBaseType_t               enames;   /**< Extended file name offset, lazy load. */
   rtems_rtl_archive_symbols symbols;  /**< Ranlib symbol table. */
+  rtems_rtl_archive_members members;  /**< Member cache. */
+  int                       fd;       /**< Open file descriptor or -1. */
   size_t                    refs;     /**< Loaded object modules. */
   uint32_t                  flags;    /**< Some flags. */
+  uint32_t                  order;    /**< Search order, lower is first. */
 #if configCHERI_COMPARTMENTALIZATION_MODE == 2
   void**                   captable;  /* Capability table per library */
   #if configCHERI_COMPARTMENTALIZATION_FAULT_RESTART
@@ -113,28 +186,88 @@ typedef struct rtems_rtl_archive
 #endif
 } rtems_rtl_archive;
 
+/**
+ * RTL Archive directory slot. A slot with no archive and a symbol is a
+ * removed entry and a probe continues past it. A symbol of 0 is an empty
+ * slot and ends a probe.
+ */
+typedef struct rtems_rtl_archive_dir_slot
+{
+  rtems_rtl_archive* archive;  /**< The archive the symbol is in. */
+  uint32_t           hash;     /**< The symbol label's hash. */
+  uint32_t           symbol;   /**< Index + 1 in the archive's sorted
+                                *   symbol table. */
+} rtems_rtl_archive_dir_slot;
+
+/**
+ * RTL Archive directory. The symbols of all loaded archives are held in a
+ * single open addressed hash so the cost of a search does not depend on the
+ * number of archives. A symbol in more than one archive has an entry for each
+ * archive and the archive first in the search order is used.
+ */
+typedef struct rtems_rtl_archive_dir
+{
+  rtems_rtl_archive_dir_slot* slots;  /**< The hash slots. */
+  size_t                      size;   /**< Number of slots, a power of 2. */
+  size_t                      used;   /**< Slots in use or removed. */
+  bool                        valid;  /**< The directory holds all archives. */
+} rtems_rtl_archive_dir;
+
 /**
  * RTL Archive data.
  */
 typedef struct rtems_rtl_archives
 {
-  const char*         config_name;    /**< Config file name. */
-  UBaseType_t         config_mtime;   /**< Config last modified time. */
-  size_t              config_length;  /**< Length the config data. */
-  char*               config;         /**< Config file contents. */
-  List_t              archives;       /**< The located archives. */
+  const char*               config_name;        /**< Config file name. */
+  UBaseType_t               config_mtime;       /**< Config last modified time. */
+  size_t                    config_length;      /**< Length the config data. */
+  char*                     config;             /**< Config file contents. */
+  List_t                    archives;           /**< The located archives. */
+  uint32_t                  order;              /**< Next archive search order. */
+  rtems_rtl_archive_dir     directory;          /**< Symbol directory. */
+  rtems_rtl_archive_refresh refresh_mode;       /**< When to refresh. */
+  TickType_t                refresh_interval;   /**< Ticks between refreshes. */
+  TickType_t                refresh_tick;       /**< Tick of the last refresh. */
+  uint32_t                  generation;         /**< Bumped when changed. */
+  uint32_t                  refresh_generation; /**< Generation refreshed. */
+  bool                      refreshed;          /**< Refreshed at least once. */
+  bool                      batch_load;         /**< Batch load members. */
 } rtems_rtl_archives;
 
+/**
+ * RTL Archive batch member. An object file in an archive to load.
+ */
+typedef struct rtems_rtl_archive_batch_member
+{
+  rtems_rtl_archive* archive;  /**< The archive the object file is in. */
+  UBaseType_t        offset;   /**< The offset of the object file. */
+} rtems_rtl_archive_batch_member;
+
+/**
+ * RTL Archive batch. The object files found for a set of symbols. A symbol
+ * is found using the archive symbol tables only so an object file can be in
+ * the batch more than once.
+ */
+typedef struct rtems_rtl_archive_batch
+{
+  rtems_rtl_archive_batch_member* members;  /**< The members to load. */
+  size_t                          count;    /**< The number of members. */
+  size_t                          size;     /**< The size of the table. */
+} rtems_rtl_archive_batch;
+
 /*
  * Find an object file in archive that contains the symbol we are
  * searching for.
  *
  * The symbol search is performance sensitive. The archive's symbol table being
  * searched is the symbol table in the archive created by ranlib. This table is
- * not sorted so a sorted table of pointeres to the symbols is generated after
- * loading if there are enough symbols. For small symbol tables the search is
- * linear. The entire table is held in memory. At the time of writing this code
- * the symbol table for the SPARC architecture's libc is 16k.
+ * not sorted so a sorted table of pointeres to the symbols and an open
+ * addressed hash of the sorted table are generated after loading. Most
+ * searches are for symbols not in the archive and the hash answers those
+ * without comparing any names. If there is no memory for the hash the sorted
+ * table is searched and if there is no sorted table the search is linear. The
+ * entire table is held in memory. At the time of writing this code the symbol
+ * table for the SPARC architecture's libc is 16k.
  *
  * The ranlib table is:
  *
@@ -193,6 +326,37 @@ void rtems_rtl_archives_close (rtems_rtl_archives* archives);
  */
 bool rtems_rtl_archives_refresh (rtems_rtl_archives* archives);
 
+/**
+ * Refresh the archives data if the refresh mode requires it. The first call
+ * always refreshes. After that the @ref rtems_rtl_archive_refresh_always mode
+ * refreshes on every call, the @ref rtems_rtl_archive_refresh_interval mode
+ * refreshes if the interval has elapsed and all modes refresh if the archives
+ * have been marked as changed since the last refresh.
+ *
+ * @param archives The archives data to refresh.
+ * @retval false The refresh failed, an error will have been set.
+ */
+bool rtems_rtl_archives_refresh_check (rtems_rtl_archives* archives);
+
+/**
+ * Set the refresh mode.
+ *
+ * @param archives The archives data.
+ * @param mode     The refresh mode.
+ * @param interval The ticks between refreshes in the interval mode.
+ */
+void rtems_rtl_archives_set_refresh (rtems_rtl_archives*       archives,
+                                     rtems_rtl_archive_refresh mode,
+                                     TickType_t                interval);
+
+/**
+ * Mark the archives as changed. The next refresh check refreshes the
+ * archives data.
+ *
+ * @param archives The archives data.
+ */
+void rtems_rtl_archives_changed (rtems_rtl_archives* archives);
+
 /**
  * Load an archive.
  *
@@ -214,6 +378,54 @@ rtems_rtl_archive_search rtems_rtl_archive_obj_load (rtems_rtl_archives* archive
                                                      const char*         symbol,
                                                      bool                load);
 
+/**
+ * Set the batch load mode.
+ *
+ * @param archives The archives data.
+ * @param batch    If @true unresolved symbols are loaded as a batch.
+ */
+void rtems_rtl_archives_set_batch (rtems_rtl_archives* archives, bool batch);
+
+/**
+ * Initialise a batch.
+ *
+ * @param batch The batch to initialise.
+ */
+void rtems_rtl_archive_batch_init (rtems_rtl_archive_batch* batch);
+
+/**
+ * Free a batch's table.
+ *
+ * @param batch The batch to free.
+ */
+void rtems_rtl_archive_batch_free (rtems_rtl_archive_batch* batch);
+
+/**
+ * Search for a symbol and add the object file that has the symbol to the
+ * batch. Nothing is loaded.
+ *
+ * @param archives The archives data to search.
+ * @param batch    The batch to add the object file to.
+ * @param symbol   The symbol name to search for.
+ * @retval rtems_rtl_archive_search_found The object file has been added.
+ */
+rtems_rtl_archive_search rtems_rtl_archive_batch_add (rtems_rtl_archives*      archives,
+                                                      rtems_rtl_archive_batch* batch,
+                                                      const char*              symbol);
+
+/**
+ * Load the batch's object files. The object files are loaded in archive
+ * search order and file offset order in each archive. Each object file is
+ * loaded once and the caches are flushed after all are loaded.
+ *
+ * @param archives The archives data.
+ * @param batch    The batch to load.
+ * @retval rtems_rtl_archive_search_loaded An object file has been loaded.
+ * @retval rtems_rtl_archive_search_error An object file failed to load.
+ */
+rtems_rtl_archive_search rtems_rtl_archive_batch_load (rtems_rtl_archives*      archives,
+                                                       rtems_rtl_archive_batch* batch);
+
 /**
  * Find a module in an archive returning the offset in the archive and
  * the size. If the name field is pointing to a string pointer and
@@ -245,6 +457,43 @@ rtems_rtl_archive*
 rtems_rtl_archive_find (rtems_rtl_archives* archives,
                         const char*         path);
 
+/**
+ * Get the archive's file descriptor opening the archive if it is not open.
+ * The descriptor is held open so a series of object files can be loaded from
+ * the archive without opening it for each object file. The descriptor is
+ * closed by @ref rtems_rtl_archives_release.
+ *
+ * @param archive The archive.
+ * @return int The file descriptor or -1 if the archive cannot be opened.
+ */
+int rtems_rtl_archive_fd (rtems_rtl_archive* archive);
+
+/**
+ * Close the file descriptors of all archives. Call this at the end of a load.
+ *
+ * @param archives The archives data.
+ */
+void rtems_rtl_archives_release (rtems_rtl_archives* archives);
+
+/**
+ * Locate a member of the archive using the archive's member cache. The
+ * arguments are the same as @ref rtems_rtl_obj_archive_find_obj. The cache is
+ * loaded if this is the first member located.
+ *
+ * @param archive The archive.
+ * @param name Pointer to the name string. If NULL the member's name is
+ *             returned in allocated memory.
+ * @param offset The offset of the member's header in the archive or 0 to
+ *               locate by name. The offset of the member's data is returned.
+ * @param size The size of the member is returned.
+ * @retval true The member was found.
+ * @retval false The member was not found or the cache could not be loaded.
+ */
+bool rtems_rtl_archive_member_locate (rtems_rtl_archive* archive,
+                                      const char**       name,
+                                      UBaseType_t*       offset,
+                                      size_t*            size);
+
 /**
  * Selectively load an object from an archive without relying on the dependency
  * symbol resolving to load an object. This is helpful to always load an object
@@ -18,6 +18,7 @@
 
 #include <FreeRTOS.h>
 #include "list.h"
+#include <rtl/rtl-allocator.h>
 #include <rtl/rtl-sym.h>
 #include <rtl/rtl-archive.h>
 #include <rtl/rtl-unresolved.h>
@@ -173,6 +174,18 @@ typedef bool (*rtems_rtl_obj_depends_iterator) (rtems_rtl_obj* obj,
                                              *   parsing. */
 #define RTEMS_RTL_OBJ_DEP_VISITED  (1 << 4) /**< Dependency loop detection. */
 #define RTEMS_RTL_OBJ_CTOR_RUN     (1 << 5) /**< Constructors have been called. */
+#define RTEMS_RTL_OBJ_RESOLVE_NEW  (1 << 6) /**< The global symbols have not been
+                                             *   probed in the unresolved table. */
+#define RTEMS_RTL_OBJ_IMAGE        (1 << 7) /**< The module memory is a single
+                                             *   image. */
+#define RTEMS_RTL_OBJ_LAZY         (1 << 8) /**< Calls to unresolved functions
+                                             *   are bound on the first call. */
+#define RTEMS_RTL_OBJ_LOCAL        (1 << 9) /**< The global symbols are only
+                                             *   exported to the object files
+                                             *   loaded with it. */
+#define RTEMS_RTL_OBJ_RELOC_DONE   (1 << 10) /**< The relocations are applied
+                                              *   and the relocation state is
+                                              *   released. */
 
 /**
  * RTL Object. There is one for each object module loaded plus one for the base
@@ -184,6 +197,8 @@ struct rtems_rtl_obj
   uint32_t            flags;        /**< The status of the object file. */
   size_t              users;        /**< Users of this object file, number of loads. */
   size_t              refs;         /**< References to the object file. */
+  uint32_t            load_group;   /**< The load the object file was loaded
+                                     *   in. */
   int                 format;       /**< The format of the object file. */
   const char*         fname;        /**< The file name for the object. */
   const char*         oname;        /**< The object file name. Can be
@@ -215,7 +230,16 @@ struct rtems_rtl_obj
   size_t              externals_syms;  /**< Externals symbol count. */
 
   size_t              global_size;  /**< Global symbol memory usage. */
+  rtems_rtl_alloc_movable local_movable;  /**< The movable local symbol
+                                           *   table. */
+  rtems_rtl_alloc_movable global_movable; /**< The movable global symbol
+                                           *   table. */
   size_t              unresolved;   /**< The number of unresolved relocations. */
+  List_t              lazy_list;    /**< The lazy binding slots. */
+  rtems_rtl_arena     reloc_arena;  /**< The relocation state's memory. Held
+                                     *   until the relocations are resolved. */
+  void*               reloc_state;  /**< Architecture relocation state held
+                                     *   between relocation passes. */
   void*               text_base;    /**< The base address of the text section
                                      *   in memory. */
   size_t              text_size;    /**< The size of the text section. */
@@ -262,6 +286,8 @@ struct rtems_rtl_obj
                                      *   relocs. The remainder are for
                                      *   unresolved symbols. */
   struct link_map*    linkmap;      /**< For GDB. */
+  rtems_rtl_arena     arena;        /**< The object file's metadata. Released
+                                     *   when the object file is freed. */
   void*               loader;       /**< The file details specific to a
                                      *   loader. */
 #if configCHERI_COMPARTMENTALIZATION_MODE == 1
@@ -59,6 +59,15 @@ static inline bool rtems_rtl_symbol_name_valid (const char* name) {
   return ((name != NULL) && name[0]);
 }
 
+/**
+ * Hash a symbol name. This is the hash used by the global symbol table and
+ * any other table keyed by symbol name.
+ *
+ * @param name The name as an ASCIIZ string.
+ * @return uint_fast32_t The 32bit hash of the name.
+ */
+uint_fast32_t rtems_rtl_symbol_hash (const char* name);
+
 /**
  * Open a symbol table with the specified number of buckets.
  *
@@ -226,6 +235,14 @@ rtems_rtl_obj_sym* rtems_rtl_symbol_obj_extract (rtems_rtl_obj* obj,
  */
 void rtems_rtl_symbol_obj_add (rtems_rtl_obj* obj);
 
+/**
+ * Make the object file's symbol tables movable so the heap can be compacted.
+ * The tables must not be resized or freed without being erased.
+ *
+ * @param obj The object file the symbol tables belong to.
+ */
+void rtems_rtl_symbol_obj_movable (rtems_rtl_obj* obj);
+
 /**
  * Erase the object file's local symbols.
  *
@@ -19,27 +19,27 @@
  * loaded. There is no load order that resolves this.
  *
  * The unresolved relocation table is a single table used by all object files
- * with unresolved symbols. It made of blocks linked together where blocks are
- * allocated as requiered. The table is always maintained compacted. That is as
- * relocations are resolved and removed the table is compacted. The only
- * pointer in the table is the object file poniter. This is used to identify
- * which object the relocation belongs to. There are no linking or back
- * pointers in the unresolved relocations table. The table is scanned for each
- * object file's relocations. This is not fast but the table should be small
- * and if it happens to grow large you have other more pressing issues to
- * resolve in your application.
- *
- * The table holds two (2) types of records:
+ * with unresolved symbols. Symbol names are held in a hash table and each
+ * name owns a chain of the relocation records that reference it. Resolving a
+ * name only touches the relocation records in its chain.
+ *
+ * The table holds three (3) types of records:
  *
  *  # Symbol name strings.
  *  # Relocations.
+ *  # Trampoline relocations.
+ *
+ * A symbol name is allocated separately because the name is variable in
+ * length. The name counts the number of relocations referencing it and the
+ * name is removed from the table when the reference count reaches 0.
  *
- * The symbol name a relocation references is held in a specific symbol name
- * string record in the table the relocation record references. The record
- * counts the number of references and the string is removed from the table
- * when the reference count reaches 0. There can be many relocations
- * referencing the symbol. The strings are referenced by a single 16bit
- * unsigned integer which is the count of the string in the table.
+ * The relocations and trampoline relocations are held in separate pools so
+ * each record is only the size of its type. A pool is blocks of records
+ * linked together where blocks are allocated as required. Records do not move
+ * once allocated so a record can be linked into a chain. A free record is
+ * linked into the pool's free list and reused and a block with no records in
+ * use is released when the table is compacted. There are no 16bit indexes or
+ * counts in the table so its size is only limited by memory.
  *
  * The section the relocation is for in the object is the section number. The
  * relocation data is series of machine word sized fields:
@@ -67,7 +67,7 @@ extern "C" {
 typedef uint32_t rtems_rtl_word;
 
 /**
- * The types of records in the blocks.
+ * The types of records in the table.
  */
 typedef enum rtems_rtl_unresolved_rtype
 {
@@ -83,34 +83,62 @@ typedef enum rtems_rtl_unresolved_rtype
 #define RTEMS_RTL_UNRESOLV_SYM_SEARCH_ARCHIVE (1 << 0) /**< Search the archive. */
 #define RTEMS_RTL_UNRESOLV_SYM_HAS_ERROR      (1 << 1) /**< The symbol load
                                                         *   has an error. */
+#define RTEMS_RTL_UNRESOLV_SYM_NEW            (1 << 2) /**< The symbol has not
+                                                        *   been searched for. */
+
+/**
+ * Resolve by delta. Only the names added and the global symbols of the object
+ * files loaded since the last resolve are searched for. If 0 all names are
+ * searched for on each resolve.
+ */
+#if !defined (RTEMS_RTL_UNRESOLVED_DELTA)
+#define RTEMS_RTL_UNRESOLVED_DELTA 1
+#endif
 
 /**
  * Unresolved externals symbols. The symbols are reference counted and separate
  * from the relocation records because a number of records could reference the
  * same symbol.
  *
- * The name is extended in the allocator of the record in the unresolved data
- * block. The 10 is a minimum that is added to by joining more than one record.
+ * The name is extended in the allocation of the symbol.
  */
 typedef struct rtems_rtl_unresolv_symbol
 {
-  uint16_t   refs;     /**< The number of references to this name. */
-  uint16_t   flags;    /**< Flags to manage the symbol. */
-  uint16_t   length;   /**< The length of this name. */
-  const char name[];   /**< The symbol name. */
+  struct rtems_rtl_unresolv_symbol* next;   /**< The next name in the hash
+                                             *   bucket. */
+  struct rtems_rtl_unresolv_reloc*  relocs; /**< The relocations referencing
+                                             *   the name. */
+  struct rtems_rtl_unresolv_reloc*  last;   /**< The last relocation in the
+                                             *   chain. */
+  uint32_t                          hash;   /**< The hash of the name. */
+  uint32_t                          refs;   /**< The number of references to
+                                             *   this name. */
+  uint32_t                          length; /**< The length of this name. */
+  uint16_t                          flags;  /**< Flags to manage the symbol. */
+  const char                        name[]; /**< The symbol name. */
 } rtems_rtl_unresolv_symbol;
 
+/**
+ * The largest section number an unresolved relocation record can hold.
+ */
+#define RTEMS_RTL_UNRESOLV_RELOC_SECT_MAX ((1UL << 24) - 1)
+
 /**
  * Unresolved externals symbols require the relocation records to be held
- * and referenced.
+ * and referenced. The record is held in the name's chain so it does not
+ * reference the name. The format specific flags are 8 bits and share a word
+ * with the section.
  */
 typedef struct rtems_rtl_unresolv_reloc
 {
-  rtems_rtl_obj* obj;     /**< The relocation's object file. */
-  uint16_t       flags;   /**< Format specific flags. */
-  uint16_t       name;    /**< The symbol's name. */
-  uint16_t       sect;    /**< The target section. */
-  rtems_rtl_word rel[3];  /**< Relocation record. */
+  rtems_rtl_obj*                   obj;       /**< The relocation's object
+                                               *   file. */
+  struct rtems_rtl_unresolv_reloc* next;      /**< The next relocation for
+                                               *   the name or the next free
+                                               *   record. */
+  uint32_t                         sect : 24; /**< The target section. */
+  uint32_t                         flags : 8; /**< Format specific flags. */
+  rtems_rtl_word                   rel[3];    /**< Relocation record. */
 } rtems_rtl_unresolv_reloc;
 
 /**
@@ -118,45 +146,69 @@ typedef struct rtems_rtl_unresolv_reloc
  */
 typedef struct rtems_rtl_tramp_reloc
 {
-  rtems_rtl_obj* obj;      /**< The relocation's object file. */
-  uint16_t       flags;    /**< Format specific flags. */
-  uint16_t       sect;     /**< The target section. */
-  rtems_rtl_word symvalue; /**< The symbol's value. */
-  rtems_rtl_word rel[3];   /**< Relocation record. */
+  rtems_rtl_obj*                obj;      /**< The relocation's object file. */
+  struct rtems_rtl_tramp_reloc* next;     /**< The next free record. */
+  uint32_t                      sect;     /**< The target section. */
+  uint16_t                      flags;    /**< Format specific flags. */
+  rtems_rtl_word                symvalue; /**< The symbol's value. */
+  rtems_rtl_word                rel[3];   /**< Relocation record. */
 } rtems_rtl_tramp_reloc;
 
 /**
- * Unresolved externals records.
+ * Unresolved externals records. A record is passed to an iterator and
+ * references the symbol or relocation held in the table.
  */
 typedef struct rtems_rtl_unresolv_rec
 {
   rtems_rtl_unresolved_rtype type;
   union
   {
-    rtems_rtl_unresolv_symbol name;   /**< The symbol, or */
-    rtems_rtl_unresolv_reloc  reloc;  /**< The relocation record. */
-    rtems_rtl_tramp_reloc     tramp;  /**< The trampoline relocation record. */
+    rtems_rtl_unresolv_symbol* name;   /**< The symbol, or */
+    rtems_rtl_unresolv_reloc*  reloc;  /**< The relocation record, or */
+    rtems_rtl_tramp_reloc*     tramp;  /**< The trampoline relocation record. */
   } rec;
 } rtems_rtl_unresolv_rec;
 
 /**
- * Unresolved blocks.
+ * Unresolved blocks. The records in a block are the size of the pool's
+ * record.
  */
 typedef struct rtems_rtl_unresolv_block
 {
-  ListItem_t             link;  /**< Blocks are chained. */
-  uint32_t               recs;  /**< The number of records in the block. */
-  rtems_rtl_unresolv_rec rec[]; /**< The records. More follow. */
+  ListItem_t link;  /**< Blocks are chained. */
+  uint32_t   recs;  /**< The number of records allocated from the block.
+                     *   Some may be free. */
+  void*      rec[]; /**< The records. More follow. */
 } rtems_rtl_unresolv_block;
 
+/**
+ * Unresolved pool of records of one type. A record starts with the object
+ * file and a link. A free record has no object file and the link is the next
+ * free record.
+ */
+typedef struct rtems_rtl_unresolv_pool
+{
+  List_t blocks;     /**< List of blocks. */
+  size_t rec_size;   /**< The size of a record. */
+  size_t block_recs; /**< The records per blocks allocated. */
+  void*  free;       /**< The free records. */
+  size_t released;   /**< Records released since the last compaction. */
+} rtems_rtl_unresolv_pool;
+
 /**
  * Unresolved table holds the names and relocations.
  */
 typedef struct rtems_rtl_unresolved
 {
-  uint32_t            marker;     /**< Block marker. */
-  size_t              block_recs; /**< The records per blocks allocated. */
-  List_t              blocks;     /**< List of blocks. */
+  uint32_t                    marker;   /**< Block marker. */
+  rtems_rtl_unresolv_symbol** names;    /**< The name hash buckets. */
+  size_t                      nbuckets; /**< The number of buckets, a power
+                                         *   of 2. */
+  size_t                      nnames;   /**< The number of names. */
+  rtems_rtl_unresolv_pool     relocs;   /**< The relocation records. */
+  rtems_rtl_unresolv_pool     tramps;   /**< The trampoline relocation
+                                         *   records. */
+  bool                        delta;    /**< Resolve by delta. */
 } rtems_rtl_unresolved;
 
 /**
@@ -190,7 +242,8 @@ bool rtems_rtl_unresolved_table_open (rtems_rtl_unresolved* unresolved,
 void rtems_rtl_unresolved_table_close (rtems_rtl_unresolved* unresolved);
 
 /**
- * Iterate over the table of unresolved entries.
+ * Iterate over the table of unresolved entries. The names are iterated then
+ * the relocation records.
  */
 bool rtems_rtl_unresolved_iterate (rtems_rtl_unresolved_iterator iterator,
                                    void*                         data);
@@ -210,7 +263,7 @@ bool rtems_rtl_unresolved_iterate (rtems_rtl_unresolved_iterator iterator,
 bool rtems_rtl_unresolved_add (rtems_rtl_obj*        obj,
                                const uint16_t        flags,
                                const char*           name,
-                               const uint16_t        sect,
+                               const uint32_t        sect,
                                const rtems_rtl_word* rel);
 
 /**
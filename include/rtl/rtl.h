@@ -81,6 +81,46 @@ extern "C" {
  */
 #define RTEMS_RTL_DEPENDENCY_BLOCK_SIZE (16)
 
+/**
+ * The size of a chunk of the load scratch memory.
+ */
+#define RTEMS_RTL_SCRATCH_CHUNK_SIZE (4096)
+
+/**
+ * The work a load does before it yields the processor. A unit of work is a
+ * section, a relocation record, a symbol, an unresolved name or
+ * RTEMS_RTL_LOAD_WORK_BYTES bytes of a section read from the file. The
+ * default of 0 does not yield.
+ */
+#ifndef configRTL_LOAD_SLICE_WORK
+  #define configRTL_LOAD_SLICE_WORK 0
+#endif
+
+/**
+ * The ticks a load delays for when it yields. The default of 0 yields to
+ * the ready tasks of the same priority.
+ */
+#ifndef configRTL_LOAD_SLICE_DELAY
+  #define configRTL_LOAD_SLICE_DELAY 0
+#endif
+
+/**
+ * The bytes of a section read from a file that are a unit of load work.
+ */
+#define RTEMS_RTL_LOAD_WORK_BYTES (1024)
+
+/**
+ * The RTL clock. The run time stats counter has the resolution to time short
+ * operations. If it is not available the tick count is used.
+ */
+#if configGENERATE_RUN_TIME_STATS
+#define rtems_rtl_clock() ((uint32_t) portGET_RUN_TIME_COUNTER_VALUE ())
+#define RTEMS_RTL_CLOCK_RUN_TIME 1
+#else
+#define rtems_rtl_clock() ((uint32_t) xTaskGetTickCount ())
+#define RTEMS_RTL_CLOCK_RUN_TIME 0
+#endif
+
 /**
  * The global debugger interface variable.
  */
@@ -97,6 +137,20 @@ extern void _rtld_debug_state (void);
  */
 typedef void (*rtems_rtl_cdtor)(void);
 
+/**
+ * The load slice. A load holds the RTL lock and yields the processor at
+ * the end of each slice of work. The times are the RTL clock.
+ */
+typedef struct rtems_rtl_load_slice
+{
+  uint32_t   work;    /**< The work in a slice, 0 does not yield. */
+  TickType_t delay;   /**< The ticks to delay for when yielding. */
+  uint32_t   done;    /**< The work done in the current slice. */
+  uint32_t   start;   /**< The time the current slice started. */
+  uint32_t   longest; /**< The time of the longest slice. */
+  uint32_t   yields;  /**< The number of times a load has yielded. */
+} rtems_rtl_load_slice;
+
 /**
  * The global RTL data. This structure is allocated on the heap when the first
  * call to the RTL is made and never released.
@@ -108,6 +162,13 @@ typedef void (*rtems_rtl_cdtor)(void);
 struct rtems_rtl_data
 {
   SemaphoreHandle_t     lock;           /**< The RTL lock */
+  SemaphoreHandle_t     writer;         /**< Held by a writer to hold off new
+                                         *   readers. */
+  SemaphoreHandle_t     drained;        /**< Given when the last reader
+                                         *   leaves and a writer waits. */
+  volatile UBaseType_t  readers;        /**< The readers holding a read
+                                         *   lock. */
+  volatile UBaseType_t  writing;        /**< The write lock nesting. */
   rtems_rtl_alloc_data  allocator;      /**< The allocator data. */
   List_t                objects;        /**< List if loaded object files. */
   List_t                pending;        /**< Listof object files needing work. */
@@ -120,6 +181,10 @@ struct rtems_rtl_data
   rtems_rtl_obj_cache   strings;        /**< Strings object file cache. */
   rtems_rtl_obj_cache   relocs;         /**< Relocations object file cache. */
   rtems_rtl_obj_comp    decomp;         /**< The decompression compressor. */
+  rtems_rtl_arena       scratch;        /**< Scratch memory for a load. */
+  uint32_t              scratch_gen;    /**< Scratch memory generation. */
+  rtems_rtl_load_slice  slice;          /**< The load slice. */
+  uint32_t              load_group;     /**< The current load. */
   int                   last_errno;     /**< Last error number. */
   char                  last_error[64]; /**< Last error string. */
 };
@@ -184,6 +249,26 @@ rtems_rtl_unresolved* rtems_rtl_unresolved_unprotected (void);
  */
 rtems_rtl_archives* rtems_rtl_archives_unprotected (void);
 
+/**
+ * Allocate scratch memory. Scratch memory is for data only needed while
+ * loading. It is released when the load finishes and is not freed by the
+ * caller. This call assumes the RTL is locked.
+ *
+ * @param size The size of the allocation.
+ * @param zero If true the memory is cleared.
+ * @return void* The memory address or NULL is not memory available.
+ */
+void* rtems_rtl_scratch_alloc (size_t size, bool zero);
+
+/**
+ * Get the scratch memory generation. The generation changes each time the
+ * scratch memory is released so a holder of scratch memory can tell it is
+ * no longer valid. This call assumes the RTL is locked.
+ *
+ * @return uint32_t The scratch memory generation.
+ */
+uint32_t rtems_rtl_scratch_generation (void);
+
 /**
  * Get the RTL symbols, strings, or relocations object file caches. This call
  * assmes the RTL is locked.
@@ -229,6 +314,33 @@ void rtems_rtl_obj_decompress (rtems_rtl_obj_comp** decomp,
  */
 void rtems_rtl_obj_update_flags (uint32_t clear, uint32_t set);
 
+/**
+ * Set the work in a load slice and the ticks to delay for when the load
+ * yields. A work of 0 does not yield. The longest slice and yield count are
+ * reset.
+ *
+ * @param work The work in a slice.
+ * @param delay The ticks to delay for, 0 yields to tasks of the same priority.
+ */
+void rtems_rtl_load_slice_set (uint32_t work, TickType_t delay);
+
+/**
+ * Get the load slice.
+ *
+ * @param slice The slice to copy the load slice into.
+ */
+void rtems_rtl_load_slice_get (rtems_rtl_load_slice* slice);
+
+/**
+ * Account for work done by a load. The load yields the processor when the
+ * work in the slice has been done. A load must not be in a write lock or
+ * have the scheduler suspended when it accounts for work. This call assumes
+ * the RTL is locked.
+ *
+ * @param work The work done.
+ */
+void rtems_rtl_load_work (uint32_t work);
+
 /**
  * Lock the Run-time Linker.
  *
@@ -243,6 +355,40 @@ rtems_rtl_data* rtems_rtl_lock (void);
  */
 void rtems_rtl_unlock (void);
 
+/**
+ * Read lock the Run-time Linker. Readers share the read lock and do not take
+ * the RTL lock so a lookup is not held up by a load or unload. A reader can
+ * search the objects list and the symbol tables. It must not lock the RTL or
+ * allocate memory while holding the read lock.
+ *
+ * @return rtems_rtl_data* The RTL data after being read locked.
+ * @retval NULL The RTL data could not be initialised.
+ */
+rtems_rtl_data* rtems_rtl_read_lock (void);
+
+/**
+ * Read unlock the Run-time Linker.
+ */
+void rtems_rtl_read_unlock (void);
+
+/**
+ * Write lock the Run-time Linker. Hold the write lock when changing the
+ * objects list or a symbol table a reader can see. The call waits for the
+ * readers to leave and new readers wait until the write lock is released so
+ * memory removed from the readers' view can be freed after the write lock is
+ * released. The write lock can be nested.
+ *
+ * Assumes the RTL has been locked.
+ */
+void rtems_rtl_write_lock (void);
+
+/**
+ * Write unlock the Run-time Linker.
+ *
+ * Assumes the RTL has been locked.
+ */
+void rtems_rtl_write_unlock (void);
+
 /**
  * Check a pointer is a valid object file descriptor returning the pointer as
  * that type.
@@ -264,7 +410,8 @@ rtems_rtl_obj* rtems_rtl_check_handle (void* handle);
 rtems_rtl_obj* rtems_rtl_find_obj (const char* name);
 
 /**
- * Find the object file a symbol is exported from.
+ * Find the object file a symbol is exported from. The object files loaded
+ * with RTLD_LOCAL are not searched.
  *
  * @param sym The symbol to search with.
  * @retval NULL No object file found.
@@ -272,6 +419,20 @@ rtems_rtl_obj* rtems_rtl_find_obj (const char* name);
  */
 rtems_rtl_obj* rtems_rtl_find_obj_with_symbol (const char* sym);
 
+/**
+ * Find the object file a symbol is exported to an object file from. An object
+ * file loaded with RTLD_LOCAL only exports its symbols to the object files
+ * loaded with it.
+ *
+ * @param sym The symbol to search with.
+ * @param obj The object file the symbol is for. If NULL only the object
+ *            files not loaded with RTLD_LOCAL are searched.
+ * @retval NULL No object file found.
+ * @return rtems_rtl_obj* Reference to the symbol.
+ */
+rtems_rtl_obj* rtems_rtl_find_obj_with_symbol_for (const char*          sym,
+                                                   const rtems_rtl_obj* obj);
+
 /**
  * Load an object file into memory relocating it. It will not be resolved
  * against other symbols in other object files or the base image.
@@ -329,6 +490,43 @@ bool rtems_rtl_unload_object (rtems_rtl_obj* obj);
  */
 rtems_rtl_obj* rtems_rtl_load (const char* name, int mode);
 
+/**
+ * Load a batch of object files. The object files are loaded then resolved,
+ * relocated and have their constructors run together. The archives are
+ * refreshed and the unresolved symbols are resolved once for the batch. See
+ * @rtems_rtl_load_object.
+ *
+ * Assumes the RTL has been locked.
+ *
+ * @param names The names of the object files.
+ * @param count The number of names.
+ * @param mode The mode of the load as defined by the dlopen call.
+ * @param objs The object file descriptor for each name. NULL is set if the
+ *             load of the name fails.
+ * @return size_t The number of object files loaded.
+ */
+size_t rtems_rtl_load_batch (const char**    names,
+                             size_t          count,
+                             int             mode,
+                             rtems_rtl_obj** objs);
+
+/**
+ * Load the object file that provides a symbol. The loaded object files are
+ * searched first and then the archives. An object file loaded from an
+ * archive is resolved, relocated and has its constructors run. The call can
+ * be made by a constructor a load runs.
+ *
+ * Assumes the RTL has been locked.
+ *
+ * @param name The symbol's name.
+ * @param scope The object file the symbol is for. An object file loaded is in
+ *              its load group. If NULL the load is a new load group.
+ * @return rtl_obj* The object file descriptor that provides the symbol. NULL
+ *                  is returned if the symbol cannot be found.
+ */
+rtems_rtl_obj* rtems_rtl_load_symbol (const char*          name,
+                                      const rtems_rtl_obj* scope);
+
 /**
  * Unload an object file. This is the user accessable interface to unloading an
  * object file. See @rtems_rtl_unload_object.
@@ -372,6 +570,42 @@ bool rtems_rtl_path_append (const char* path);
 
 bool rtems_rtl_path_prepend (const char* path);
 
+/**
+ * Set when the archives are refreshed on a load. Refreshing the archives
+ * reads the archive configuration and scans the file system so it can be
+ * limited to an interval or to loads after @ref rtems_rtl_archives_update
+ * is called.
+ *
+ * @param mode The refresh mode.
+ * @param interval The ticks between refreshes in the interval mode.
+ * @retval false The RTL could not be locked.
+ * @retval true The refresh mode is set.
+ */
+bool rtems_rtl_archives_refresh_mode (rtems_rtl_archive_refresh mode,
+                                      TickType_t                interval);
+
+/**
+ * Mark the archives as changed so the next load refreshes them. Call this
+ * after changing the archive configuration or installing an archive.
+ *
+ * @retval false The RTL could not be locked.
+ * @retval true The archives are marked as changed.
+ */
+bool rtems_rtl_archives_update (void);
+
+/**
+ * Set if the object files needed to resolve the unresolved symbols are
+ * loaded from the archives as a batch. A batch is all the object files the
+ * archive symbol tables say are needed and they are loaded in archive file
+ * order before resolving. The symbols those object files need are resolved
+ * in the next batch.
+ *
+ * @param batch If true load the object files as a batch.
+ * @retval false The RTL could not be locked.
+ * @retval true The batch load mode is set.
+ */
+bool rtems_rtl_archives_batch_load (bool batch);
+
 /**
  * Add an exported symbol table to the global symbol table. This call is
  * normally used by an object file when loaded that contains a global symbol
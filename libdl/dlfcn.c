@@ -15,12 +15,17 @@
  * This is the POSIX interface to run-time loading of code into RTEMS.
  */
 
+#include <errno.h>
 #include <stdint.h>
+#include <string.h>
 #include <dlfcn.h>
 #include <rtl/rtl.h>
 #include <sys/exec_elf.h>
 
 #include <FreeRTOSConfig.h>
+#include <FreeRTOS.h>
+#include "queue.h"
+#include "task.h"
 
 #include "rtl-alloc-heap.h"
 
@@ -29,6 +34,44 @@
 #include <cheri/cheri-utility.h>
 #endif
 
+/**
+ * The priority of the loader task that runs the dlopen_async requests.
+ */
+#ifndef configRTL_LOADER_TASK_PRIORITY
+  #define configRTL_LOADER_TASK_PRIORITY (tskIDLE_PRIORITY + 1)
+#endif
+
+/**
+ * The stack size of the loader task in words. A load needs a deep stack.
+ */
+#ifndef configRTL_LOADER_TASK_STACK_SIZE
+  #define configRTL_LOADER_TASK_STACK_SIZE (configMINIMAL_STACK_SIZE * 8)
+#endif
+
+/**
+ * The number of dlopen_async requests that can be queued.
+ */
+#ifndef configRTL_LOADER_QUEUE_LENGTH
+  #define configRTL_LOADER_QUEUE_LENGTH (4)
+#endif
+
+/**
+ * A dlopen_async request. The name is held after the request.
+ */
+typedef struct dl_async_request
+{
+  const char*     name;     /**< The name to load, NULL is the base image. */
+  int             mode;     /**< The dlopen mode. */
+  dlopen_callback callback; /**< Called with the handle of the load. */
+  void*           arg;      /**< The callback's argument. */
+} dl_async_request;
+
+/**
+ * The loader task's request queue. It is created with the task by the first
+ * dlopen_async call.
+ */
+static QueueHandle_t dl_loader_queue;
+
 static rtems_rtl_obj*
 dl_get_obj_from_handle (void* handle)
 {
@@ -89,6 +132,153 @@ dlopen (const char* name, int mode)
   return obj;
 }
 
+int
+dlopen_batch (const char** names, int count, int mode, void** handles)
+{
+  int loaded;
+  int n;
+
+  if (count < 0 || (count > 0 && (!names || !handles)))
+    return -1;
+
+  if (!rtems_rtl_lock ())
+    return -1;
+
+  _rtld_debug.r_state = RT_ADD;
+
+  loaded = rtems_rtl_load_batch (names, count, mode,
+                                 (rtems_rtl_obj**) handles);
+
+  _rtld_debug.r_state = RT_CONSISTENT;
+
+  #if configLIBDL_GDB_DEBUG
+    _rtld_debug_state ();
+  #endif
+
+  #if configCHERI_COMPARTMENTALIZATION
+    if (!rtl_cherifreertos_compartments_snapshot()) {
+      printf("Failed to snapshot the compartmentalized system\n");
+      rtems_rtl_unlock ();
+      return -1;
+    }
+  #endif
+  #if configCHERI_COMPARTMENTALIZATION || configMPU_COMPARTMENTALIZATION
+    rtl_cherifreertos_debug_print_compartments();
+  #endif
+
+  rtems_rtl_unlock ();
+
+  return loaded;
+}
+
+static void
+dl_loader_task (void* arg)
+{
+  QueueHandle_t queue = (QueueHandle_t) arg;
+
+  while (true)
+  {
+    dl_async_request* request;
+    if (xQueueReceive (queue, &request, portMAX_DELAY) == pdPASS)
+    {
+      void* handle = dlopen (request->name, request->mode);
+      request->callback (handle, request->arg);
+      vPortFree (request);
+    }
+  }
+}
+
+static bool
+dl_loader_start (void)
+{
+  bool started = true;
+
+  if (dl_loader_queue == NULL)
+  {
+    if (!rtems_rtl_lock ())
+      return false;
+
+    if (dl_loader_queue == NULL)
+    {
+      QueueHandle_t queue;
+      queue = xQueueCreate (configRTL_LOADER_QUEUE_LENGTH,
+                            sizeof (dl_async_request*));
+      if (queue == NULL)
+      {
+        started = false;
+      }
+      else if (xTaskCreate (dl_loader_task, "rtl-loader",
+                            configRTL_LOADER_TASK_STACK_SIZE, queue,
+                            configRTL_LOADER_TASK_PRIORITY, NULL) != pdPASS)
+      {
+        vQueueDelete (queue);
+        started = false;
+      }
+      else
+      {
+        dl_loader_queue = queue;
+      }
+    }
+
+    rtems_rtl_unlock ();
+  }
+
+  return started;
+}
+
+int
+dlopen_async (const char* name, int mode, dlopen_callback callback, void* arg)
+{
+  dl_async_request* request;
+  size_t            size = sizeof (dl_async_request);
+
+  if (!callback)
+  {
+    errno = EINVAL;
+    return -1;
+  }
+
+  if (!dl_loader_start ())
+  {
+    errno = ENOMEM;
+    return -1;
+  }
+
+  /*
+   * The request is allocated from the FreeRTOS heap and queued without
+   * waiting so the caller is not held up by a load that is running.
+   */
+  if (name)
+    size += strlen (name) + 1;
+
+  request = pvPortMalloc (size);
+  if (!request)
+  {
+    errno = ENOMEM;
+    return -1;
+  }
+
+  request->name = NULL;
+  if (name)
+  {
+    char* copy = (char*) (request + 1);
+    strcpy (copy, name);
+    request->name = copy;
+  }
+  request->mode = mode;
+  request->callback = callback;
+  request->arg = arg;
+
+  if (xQueueSend (dl_loader_queue, &request, 0) != pdPASS)
+  {
+    vPortFree (request);
+    errno = EAGAIN;
+    return -1;
+  }
+
+  return 0;
+}
+
 int
 dlclose (void* handle)
 {
@@ -124,14 +314,69 @@ dlclose (void* handle)
   return r;
 }
 
+#if !configCHERI_COMPARTMENTALIZATION && !configMPU_COMPARTMENTALIZATION
+/*
+ * Find a symbol with the RTL read locked. The object file's symbol tables and
+ * the global symbol table are searched. Finding a base image symbol for an
+ * object file mints it into the object file and that needs the RTL locked.
+ */
+static rtems_rtl_obj_sym*
+dl_sym_find_shared (rtems_rtl_data* rtl, void* handle, const char* symbol)
+{
+  rtems_rtl_obj*     obj;
+  rtems_rtl_obj_sym* sym;
+
+  if (handle == RTLD_DEFAULT)
+    return rtems_rtl_symbol_global_find (symbol);
+
+  if (handle == RTLD_SELF)
+    obj = rtl->base;
+  else
+    obj = rtems_rtl_check_handle (handle);
+
+  if (!obj)
+    return NULL;
+
+  sym = rtems_rtl_lsymbol_obj_find (obj, symbol);
+  if (!sym)
+    sym = rtems_rtl_gsymbol_obj_find (obj, symbol);
+  if (!sym && obj->externals_syms)
+    sym = rtems_rtl_esymbol_obj_find (obj, symbol);
+
+  return sym;
+}
+#endif
+
 void*
 dlsym (void* handle, const char *symbol)
 {
-  rtems_rtl_obj*     obj;
+  rtems_rtl_data*    rtl;
+  rtems_rtl_obj*     obj = NULL;
   rtems_rtl_obj_sym* sym = NULL;
   uintptr_t          symval = 0;
 
-  if (!rtems_rtl_lock ())
+#if !configCHERI_COMPARTMENTALIZATION && !configMPU_COMPARTMENTALIZATION
+  /*
+   * Search with the RTL read locked so a load or unload does not hold up the
+   * lookup. A compartment needs a trampoline for a function and that needs
+   * the RTL locked.
+   */
+  rtl = rtems_rtl_read_lock ();
+  if (!rtl)
+    return NULL;
+
+  sym = dl_sym_find_shared (rtl, handle, symbol);
+  if (sym)
+    symval = sym->value;
+
+  rtems_rtl_read_unlock ();
+
+  if (sym || handle == RTLD_DEFAULT)
+    return (void*) symval;
+#endif
+
+  rtl = rtems_rtl_lock ();
+  if (!rtl)
     return NULL;
 
   /*
@@ -148,12 +393,14 @@ dlsym (void* handle, const char *symbol)
       sym = rtems_rtl_symbol_obj_find (obj, symbol);
   }
 
-  if (sym)
-    symval = sym->value;
-  else {
+  if (!sym)
+  {
+    rtems_rtl_unlock ();
     return NULL;
   }
 
+  symval = sym->value;
+
 #if configCHERI_COMPARTMENTALIZATION
     void* tramp_cap;
     void** captable = rtl_cherifreertos_compartment_obj_get_captable(obj);
@@ -161,9 +408,10 @@ dlsym (void* handle, const char *symbol)
     /* Setup a compartment switch trampoline if it is a function */
     if (ELF_ST_TYPE(sym->data >> 16) == STT_FUNC) {
       tramp_cap = rtl_cherifreertos_compartments_setup_ecall((void*) symval, rtl_cherifreertos_compartment_get_compid(obj));
-      if (tramp_cap == NULL)
+      if (tramp_cap == NULL) {
+        rtems_rtl_unlock ();
         return NULL;
-      else
+      } else
         symval = (uintptr_t) tramp_cap;
     }
 #endif
@@ -174,9 +422,10 @@ dlsym (void* handle, const char *symbol)
     /* Setup a compartment switch trampoline if it is a function */
     if (ELF_ST_TYPE(sym->data >> 16) == STT_FUNC) {
       tramp_cap = rtl_cherifreertos_compartments_setup_ecall((void*) symval, rtl_cherifreertos_compartment_get_compid(obj));
-      if (tramp_cap == NULL)
+      if (tramp_cap == NULL) {
+        rtems_rtl_unlock ();
         return NULL;
-      else
+      } else
         symval = (uintptr_t) tramp_cap;
     }
 #endif
@@ -0,0 +1,70 @@
+/*
+ *  The license and distribution terms for this file may be
+ *  found in the file LICENSE in this distribution or at
+ *  http://www.rtems.org/license/LICENSE.
+ */
+/**
+ * @file
+ *
+ * @ingroup rtems_rtl
+ *
+ * @brief RTEMS Run-Time Linker Host FreeRTOS Header
+ *
+ * The parts of FreeRTOS the RTL heaps use so the heaps can be built on the
+ * host. The host tools are single threaded.
+ */
+
+#if !defined (INC_FREERTOS_H)
+#define INC_FREERTOS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef long          BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t      TickType_t;
+
+#define pdFALSE ((BaseType_t) 0)
+#define pdTRUE  ((BaseType_t) 1)
+
+/*
+ * The RTL heap is allocated by the host tool. Build with a heap size to
+ * match a target's configTOTAL_RTL_HEAP_SIZE.
+ */
+#define configSUPPORT_DYNAMIC_ALLOCATION 1
+#define configAPPLICATION_ALLOCATED_HEAP 1
+#define configUSE_MALLOC_FAILED_HOOK     0
+#ifndef configTOTAL_RTL_HEAP_SIZE
+#define configTOTAL_RTL_HEAP_SIZE        (256 * 1024)
+#endif
+#ifndef configRTL_HEAP_TLSF
+#define configRTL_HEAP_TLSF              1
+#endif
+
+#define portBYTE_ALIGNMENT      8
+#define portBYTE_ALIGNMENT_MASK (portBYTE_ALIGNMENT - 1)
+#define portMAX_DELAY           ((size_t) -1)
+
+#define PRIVILEGED_FUNCTION
+#define PRIVILEGED_DATA
+#define PRIVILEGED_HEAP
+
+#define configASSERT(_x)         do { } while (0)
+#define mtCOVERAGE_TEST_MARKER() do { } while (0)
+#define traceMALLOC(_p, _s)      do { } while (0)
+#define traceFREE(_p, _s)        do { } while (0)
+#define taskENTER_CRITICAL()     do { } while (0)
+#define taskEXIT_CRITICAL()      do { } while (0)
+
+typedef struct xHeapStats
+{
+  size_t xAvailableHeapSpaceInBytes;
+  size_t xSizeOfLargestFreeBlockInBytes;
+  size_t xSizeOfSmallestFreeBlockInBytes;
+  size_t xNumberOfFreeBlocks;
+  size_t xMinimumEverFreeBytesRemaining;
+  size_t xNumberOfSuccessfulAllocations;
+  size_t xNumberOfSuccessfulFrees;
+} HeapStats_t;
+
+#endif
@@ -0,0 +1,22 @@
+/*
+ *  The license and distribution terms for this file may be
+ *  found in the file LICENSE in this distribution or at
+ *  http://www.rtems.org/license/LICENSE.
+ */
+/**
+ * @file
+ *
+ * @ingroup rtems_rtl
+ *
+ * @brief RTEMS Run-Time Linker Host FreeRTOS Task Header
+ *
+ * The host tools are single threaded so there is no scheduler to suspend.
+ */
+
+#if !defined (INC_TASK_H)
+#define INC_TASK_H
+
+#define vTaskSuspendAll() do { } while (0)
+#define xTaskResumeAll()  (pdFALSE)
+
+#endif
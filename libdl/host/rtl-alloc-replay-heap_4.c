@@ -0,0 +1,18 @@
+/*
+ *  The license and distribution terms for this file may be
+ *  found in the file LICENSE in this distribution or at
+ *  http://www.rtems.org/license/LICENSE.
+ */
+/**
+ * @file
+ *
+ * @ingroup rtems_rtl
+ *
+ * @brief RTEMS Run-Time Linker Allocation Replay heap_4
+ *
+ * The heap_4 region heap built for the host.
+ */
+
+#include "rtl-alloc-replay.h"
+
+#include "../rtl-heap_4.c"
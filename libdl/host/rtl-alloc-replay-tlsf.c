@@ -0,0 +1,18 @@
+/*
+ *  The license and distribution terms for this file may be
+ *  found in the file LICENSE in this distribution or at
+ *  http://www.rtems.org/license/LICENSE.
+ */
+/**
+ * @file
+ *
+ * @ingroup rtems_rtl
+ *
+ * @brief RTEMS Run-Time Linker Allocation Replay TLSF
+ *
+ * The TLSF heap built for the host. It is the RTL heap in ucRTLHeap.
+ */
+
+#include "rtl-alloc-replay.h"
+
+#include "../rtl-heap-tlsf.c"
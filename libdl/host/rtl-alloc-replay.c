@@ -0,0 +1,984 @@
+/*
+ *  The license and distribution terms for this file may be
+ *  found in the file LICENSE in this distribution or at
+ *  http://www.rtems.org/license/LICENSE.
+ */
+/**
+ * @file
+ *
+ * @ingroup rtems_rtl
+ *
+ * @brief RTEMS Run-Time Linker Allocation Replay
+ *
+ * Replay a file written by the allocation recorder against the heap_4 and
+ * TLSF heaps, the slab caches and the arenas and report the peak memory
+ * used, the fragmentation and the time each request takes. The heaps are
+ * the RTL's heap sources built for the host. Build and run from the top of
+ * the tree with:
+ *
+ *   cc -O2 -Iinclude -Ilibdl/host/include \
+ *      -DconfigTOTAL_RTL_HEAP_SIZE=<target heap size> \
+ *      libdl/host/rtl-alloc-replay.c libdl/host/rtl-alloc-replay-heap_4.c \
+ *      libdl/host/rtl-alloc-replay-tlsf.c -o rtl-alloc-replay
+ *   ./rtl-alloc-replay <record file>
+ *
+ * The heap size defaults to 256K and each allocator is given the same heap.
+ * The requests the loader made are replayed. The records of the memory the
+ * allocator takes to hold slabs and arena chunks are not replayed as the
+ * slab and arena models allocate their own. The file must be in the host's
+ * byte order.
+ *
+ * The allocators are:
+ *
+ *  heap_4  Each request is made to a heap_4 heap.
+ *  tlsf    Each request is made to the TLSF heap.
+ *  slab    The small object, symbol and external requests are held in slab
+ *          caches like the RTL's. The other requests and the slabs are made
+ *          to a heap_4 heap.
+ *  arena   The arena requests are held in chunks like the RTL's arenas and
+ *          the other requests and the chunks are made to a heap_4 heap.
+ *
+ * The peak is the most memory the heap has had allocated including the
+ * heap's block headers. The fragmentation is 1 less the largest free block
+ * divided by the free memory. The maximum fragmentation is sampled every 64
+ * requests.
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <rtl/rtl-alloc-record.h>
+
+#include "rtl-alloc-replay.h"
+
+/*
+ * The RTL's tags and the slab and arena sizes in rtl-allocator.h. The
+ * allocator's header needs the FreeRTOS lists so the values are repeated.
+ */
+#define REPLAY_TAG_OBJECT     (0)
+#define REPLAY_TAG_CAPTAB     (1)
+#define REPLAY_TAG_SYMBOL     (2)
+#define REPLAY_TAG_EXTERNAL   (3)
+#define REPLAY_MODULE_ALIGN   (16)
+#define REPLAY_SLAB_CLASSES   (4)
+#define REPLAY_SLAB_MIN_SIZE  (32)
+#define REPLAY_SLAB_MAX_SIZE  (REPLAY_SLAB_MIN_SIZE << (REPLAY_SLAB_CLASSES - 1))
+#define REPLAY_SLAB_SIZE      (1024)
+#define REPLAY_TAGS           (7)
+#define REPLAY_ARENA_CHUNK    (1024)
+#define REPLAY_ARENA_ALIGN    (8)
+
+#define replay_round(_s) \
+  (((_s) + (REPLAY_ARENA_ALIGN - 1)) & ~((size_t) REPLAY_ARENA_ALIGN - 1))
+
+#define REPLAY_SAMPLE  (64)
+#define REPLAY_REPEATS (5)
+
+/*
+ * A replay operation.
+ */
+typedef enum
+{
+  REPLAY_NEW,
+  REPLAY_DEL,
+  REPLAY_RELEASE
+} replay_op_type;
+
+typedef struct
+{
+  replay_op_type type;
+  uint32_t       index; /**< The slot of a new or delete, or the first
+                         *   slot index of a release. */
+  uint32_t       count; /**< The number of slots a release frees. */
+  uint32_t       owner; /**< The arena of a release. */
+} replay_op;
+
+/*
+ * An allocation. The slot holds the replayed address.
+ */
+typedef struct
+{
+  void*    address;
+  void*    aux;    /**< The slab of a slab allocation. */
+  uint32_t size;
+  uint32_t owner;  /**< The arena plus 1, 0 if not an arena allocation. */
+  uint8_t  tag;
+  uint8_t  source;
+} replay_slot;
+
+typedef struct
+{
+  replay_op*   ops;
+  size_t       op_count;
+  replay_slot* slots;
+  size_t       slot_count;
+  uint32_t*    released;   /**< The slots each release frees. */
+  size_t       released_count;
+  size_t       owners;
+  size_t       records;
+  size_t       backing;
+  size_t       news;
+  size_t       dels;
+  size_t       releases;
+  size_t       unmatched;
+} replay_trace;
+
+typedef struct
+{
+  size_t peak;
+  double frag_max;
+  double frag_end;
+  size_t failed;
+  double ns;
+} replay_result;
+
+/*
+ * An allocator replayed.
+ */
+typedef struct
+{
+  const char* name;
+  bool        (*open) (const replay_trace* trace);
+  void        (*close) (void);
+  void*       (*alloc) (replay_slot* slot);
+  void        (*free) (replay_slot* slot);
+  void        (*release) (uint32_t owner);
+  size_t      (*free_size) (void);
+  void        (*stats) (HeapStats_t* stats);
+} replay_allocator;
+
+/*
+ * A chained hash of the recorded addresses or arenas to an index.
+ */
+typedef struct
+{
+  uint64_t key;
+  uint32_t value;
+  uint32_t next;
+} replay_hash_node;
+
+typedef struct
+{
+  uint32_t*         buckets;
+  size_t            bucket_count;
+  replay_hash_node* nodes;
+  uint32_t          free_node;
+  uint32_t          node_count;
+} replay_hash;
+
+#define REPLAY_HASH_NONE (0xffffffffU)
+
+uint8_t ucRTLHeap[ configTOTAL_RTL_HEAP_SIZE ];
+
+static bool
+replay_hash_init (replay_hash* hash, size_t size)
+{
+  size_t b;
+  hash->bucket_count = 1;
+  while (hash->bucket_count < size)
+    hash->bucket_count <<= 1;
+  hash->buckets = malloc (hash->bucket_count * sizeof (uint32_t));
+  hash->nodes = malloc ((size + 1) * sizeof (replay_hash_node));
+  if (hash->buckets == NULL || hash->nodes == NULL)
+    return false;
+  for (b = 0; b < hash->bucket_count; ++b)
+    hash->buckets[b] = REPLAY_HASH_NONE;
+  hash->free_node = REPLAY_HASH_NONE;
+  hash->node_count = 0;
+  return true;
+}
+
+static void
+replay_hash_close (replay_hash* hash)
+{
+  free (hash->buckets);
+  free (hash->nodes);
+}
+
+static uint32_t*
+replay_hash_bucket (replay_hash* hash, uint64_t key)
+{
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  return &hash->buckets[key & (hash->bucket_count - 1)];
+}
+
+static uint32_t
+replay_hash_find (replay_hash* hash, uint64_t key)
+{
+  uint32_t n = *replay_hash_bucket (hash, key);
+  while (n != REPLAY_HASH_NONE)
+  {
+    if (hash->nodes[n].key == key)
+      return hash->nodes[n].value;
+    n = hash->nodes[n].next;
+  }
+  return REPLAY_HASH_NONE;
+}
+
+static void
+replay_hash_set (replay_hash* hash, uint64_t key, uint32_t value)
+{
+  uint32_t* bucket = replay_hash_bucket (hash, key);
+  uint32_t  n = *bucket;
+  while (n != REPLAY_HASH_NONE)
+  {
+    if (hash->nodes[n].key == key)
+    {
+      hash->nodes[n].value = value;
+      return;
+    }
+    n = hash->nodes[n].next;
+  }
+  if (hash->free_node != REPLAY_HASH_NONE)
+  {
+    n = hash->free_node;
+    hash->free_node = hash->nodes[n].next;
+  }
+  else
+  {
+    n = hash->node_count++;
+  }
+  hash->nodes[n].key = key;
+  hash->nodes[n].value = value;
+  hash->nodes[n].next = *bucket;
+  *bucket = n;
+}
+
+static void
+replay_hash_remove (replay_hash* hash, uint64_t key)
+{
+  uint32_t* link = replay_hash_bucket (hash, key);
+  while (*link != REPLAY_HASH_NONE)
+  {
+    uint32_t n = *link;
+    if (hash->nodes[n].key == key)
+    {
+      *link = hash->nodes[n].next;
+      hash->nodes[n].next = hash->free_node;
+      hash->free_node = n;
+      return;
+    }
+    link = &hash->nodes[n].next;
+  }
+}
+
+/*
+ * Load the records and turn them into the operations to replay. A free is
+ * matched to its allocation and an arena's release to the arena's
+ * allocations so the replay only indexes arrays.
+ */
+static bool
+replay_load (const char* name, replay_trace* trace)
+{
+  rtems_rtl_alloc_record_header header;
+  rtems_rtl_alloc_record*       records;
+  replay_hash                   live;
+  replay_hash                   owners;
+  uint32_t*                     owner_next;
+  uint32_t*                     owner_head;
+  FILE*                         file;
+  size_t                        r;
+  bool                          ok;
+
+  memset (trace, 0, sizeof (*trace));
+
+  file = fopen (name, "rb");
+  if (file == NULL)
+  {
+    printf ("error: %s: %s\n", name, strerror (errno));
+    return false;
+  }
+
+  if (fread (&header, sizeof (header), 1, file) != 1)
+  {
+    printf ("error: %s: no header\n", name);
+    fclose (file);
+    return false;
+  }
+
+  if (header.magic != RTEMS_RTL_ALLOC_RECORD_MAGIC ||
+      header.version != RTEMS_RTL_ALLOC_RECORD_VERSION ||
+      header.record_size != sizeof (rtems_rtl_alloc_record))
+  {
+    printf ("error: %s: not a version %d record file in the host's byte order\n",
+            name, RTEMS_RTL_ALLOC_RECORD_VERSION);
+    fclose (file);
+    return false;
+  }
+
+  records = malloc ((header.count + 1) * sizeof (rtems_rtl_alloc_record));
+  if (records == NULL)
+  {
+    printf ("error: no memory\n");
+    fclose (file);
+    return false;
+  }
+
+  trace->records = fread (records, sizeof (rtems_rtl_alloc_record),
+                          header.count, file);
+  fclose (file);
+
+  if (trace->records != header.count)
+    printf ("warning: %s: %zu of %" PRIu32 " records read\n",
+            name, trace->records, header.count);
+  if (header.dropped != 0)
+    printf ("warning: %s: %" PRIu32 " oldest records were dropped\n",
+            name, header.dropped);
+  if (header.heap_size != configTOTAL_RTL_HEAP_SIZE)
+    printf ("warning: the target heap is %" PRIu32 " bytes and the replay " \
+            "heap is %d bytes\n", header.heap_size, configTOTAL_RTL_HEAP_SIZE);
+
+  trace->ops = malloc ((trace->records + 1) * sizeof (replay_op));
+  trace->slots = malloc ((trace->records + 1) * sizeof (replay_slot));
+  trace->released = malloc ((trace->records + 1) * sizeof (uint32_t));
+  owner_next = malloc ((trace->records + 1) * sizeof (uint32_t));
+  owner_head = malloc ((trace->records + 1) * sizeof (uint32_t));
+  ok = trace->ops != NULL && trace->slots != NULL && trace->released != NULL &&
+    owner_next != NULL && owner_head != NULL &&
+    replay_hash_init (&live, trace->records + 1) &&
+    replay_hash_init (&owners, trace->records + 1);
+  if (!ok)
+  {
+    printf ("error: no memory\n");
+    free (records);
+    return false;
+  }
+
+  for (r = 0; r < trace->records; ++r)
+  {
+    const rtems_rtl_alloc_record* record = &records[r];
+    uint32_t                      owner = 0;
+    replay_op*                    op;
+
+    if ((record->source & RTEMS_RTL_ALLOC_RECORD_BACKING) != 0)
+    {
+      ++trace->backing;
+      continue;
+    }
+
+    if ((record->source & RTEMS_RTL_ALLOC_RECORD_SOURCE_MASK) ==
+        RTEMS_RTL_ALLOC_RECORD_ARENA)
+    {
+      owner = replay_hash_find (&owners, record->owner);
+      if (owner == REPLAY_HASH_NONE)
+      {
+        owner = trace->owners++;
+        owner_head[owner] = REPLAY_HASH_NONE;
+        replay_hash_set (&owners, record->owner, owner);
+      }
+    }
+
+    op = &trace->ops[trace->op_count];
+
+    if (record->cmd == RTEMS_RTL_ALLOC_RECORD_NEW)
+    {
+      replay_slot* slot = &trace->slots[trace->slot_count];
+      if (record->address == 0)
+        continue;
+      slot->address = NULL;
+      slot->aux = NULL;
+      slot->size = record->size;
+      slot->tag = record->tag;
+      slot->source = record->source & RTEMS_RTL_ALLOC_RECORD_SOURCE_MASK;
+      slot->owner = 0;
+      if (slot->source == RTEMS_RTL_ALLOC_RECORD_ARENA)
+      {
+        slot->owner = owner + 1;
+        owner_next[trace->slot_count] = owner_head[owner];
+        owner_head[owner] = trace->slot_count;
+      }
+      else
+      {
+        replay_hash_set (&live, record->address, trace->slot_count);
+      }
+      op->type = REPLAY_NEW;
+      op->index = trace->slot_count++;
+      ++trace->news;
+      ++trace->op_count;
+    }
+    else if (record->source == RTEMS_RTL_ALLOC_RECORD_ARENA)
+    {
+      uint32_t s = owner_head[owner];
+      op->type = REPLAY_RELEASE;
+      op->index = trace->released_count;
+      op->owner = owner;
+      while (s != REPLAY_HASH_NONE)
+      {
+        trace->released[trace->released_count++] = s;
+        s = owner_next[s];
+      }
+      op->count = trace->released_count - op->index;
+      owner_head[owner] = REPLAY_HASH_NONE;
+      ++trace->releases;
+      ++trace->op_count;
+    }
+    else
+    {
+      uint32_t s = replay_hash_find (&live, record->address);
+      if (s == REPLAY_HASH_NONE)
+      {
+        /*
+         * The allocation was made before recording started or its record
+         * was dropped.
+         */
+        ++trace->unmatched;
+        continue;
+      }
+      replay_hash_remove (&live, record->address);
+      op->type = REPLAY_DEL;
+      op->index = s;
+      ++trace->dels;
+      ++trace->op_count;
+    }
+  }
+
+  replay_hash_close (&live);
+  replay_hash_close (&owners);
+  free (owner_next);
+  free (owner_head);
+  free (records);
+
+  return true;
+}
+
+static size_t
+replay_align (uint8_t tag)
+{
+  return tag == REPLAY_TAG_OBJECT || tag == REPLAY_TAG_SYMBOL ||
+    tag == REPLAY_TAG_EXTERNAL ? 0 : REPLAY_MODULE_ALIGN;
+}
+
+/*
+ * The heap_4 heap. The slab and arena models allocate from it.
+ */
+static uint8_t*        heap_4_memory;
+static RTLHeapHandle_t heap_4;
+
+static bool
+heap_4_open (const replay_trace* trace)
+{
+  (void) trace;
+  heap_4_memory = malloc (configTOTAL_RTL_HEAP_SIZE);
+  if (heap_4_memory == NULL)
+    return false;
+  heap_4 = xRTLHeapCreate (heap_4_memory, configTOTAL_RTL_HEAP_SIZE);
+  return heap_4 != NULL;
+}
+
+static void
+heap_4_close (void)
+{
+  free (heap_4_memory);
+  heap_4_memory = NULL;
+  heap_4 = NULL;
+}
+
+static void*
+heap_4_alloc (replay_slot* slot)
+{
+  return pvRTLHeapMallocAligned (heap_4, slot->size, replay_align (slot->tag));
+}
+
+static void
+heap_4_free (replay_slot* slot)
+{
+  vRTLHeapFree (heap_4, slot->address);
+}
+
+static void
+heap_4_release (uint32_t owner)
+{
+  (void) owner;
+}
+
+static size_t
+heap_4_free_size (void)
+{
+  return xRTLHeapGetFreeSize (heap_4);
+}
+
+static void
+heap_4_stats (HeapStats_t* stats)
+{
+  vRTLHeapGetStats (heap_4, stats);
+}
+
+/*
+ * The TLSF heap. It is the RTL heap and is initialised once. The replay
+ * frees all its allocations so the heap is empty for the next replay.
+ */
+static bool
+tlsf_open (const replay_trace* trace)
+{
+  (void) trace;
+  vRTLInitialiseBlocks ();
+  return true;
+}
+
+static void
+tlsf_close (void)
+{
+}
+
+static void*
+tlsf_alloc (replay_slot* slot)
+{
+  return pvRTLMallocAligned (slot->size, replay_align (slot->tag));
+}
+
+static void
+tlsf_free (replay_slot* slot)
+{
+  vRTLFree (slot->address);
+}
+
+static size_t
+tlsf_free_size (void)
+{
+  return xRTLtGetFreeHeapSize ();
+}
+
+/*
+ * The slab caches. They follow rtems_rtl_alloc_slab_new and
+ * rtems_rtl_alloc_slab_del.
+ */
+typedef struct replay_slab
+{
+  struct replay_slab* next;
+  uint32_t            free;
+} replay_slab;
+
+typedef struct
+{
+  replay_slab* slabs;
+  replay_slab* current;
+  size_t       size;
+  size_t       objects;
+  size_t       count;
+} replay_slab_cache;
+
+static replay_slab_cache slab_caches[REPLAY_TAGS][REPLAY_SLAB_CLASSES];
+
+#define replay_slab_base(_s) (((char*) (_s)) + replay_round (sizeof (replay_slab)))
+#define replay_slab_full_map(_c) \
+  ((_c)->objects == 32 ? 0xffffffffUL : ((1UL << (_c)->objects) - 1))
+
+static replay_slab_cache*
+slab_cache (const replay_slot* slot)
+{
+  int sc = 0;
+  if ((slot->tag != REPLAY_TAG_OBJECT &&
+       slot->tag != REPLAY_TAG_SYMBOL &&
+       slot->tag != REPLAY_TAG_EXTERNAL) ||
+      slot->size > REPLAY_SLAB_MAX_SIZE)
+    return NULL;
+  while ((uint32_t) (REPLAY_SLAB_MIN_SIZE << sc) < slot->size)
+    ++sc;
+  return &slab_caches[slot->tag][sc];
+}
+
+static bool
+slab_open (const replay_trace* trace)
+{
+  int t;
+  for (t = 0; t < REPLAY_TAGS; ++t)
+  {
+    int sc;
+    for (sc = 0; sc < REPLAY_SLAB_CLASSES; ++sc)
+    {
+      replay_slab_cache* cache = &slab_caches[t][sc];
+      cache->slabs = NULL;
+      cache->current = NULL;
+      cache->size = REPLAY_SLAB_MIN_SIZE << sc;
+      cache->objects = REPLAY_SLAB_SIZE / cache->size;
+      if (cache->objects > 32)
+        cache->objects = 32;
+      cache->count = 0;
+    }
+  }
+  return heap_4_open (trace);
+}
+
+static void*
+slab_alloc (replay_slot* slot)
+{
+  replay_slab_cache* cache = slab_cache (slot);
+  replay_slab*       slab;
+  int                obj;
+
+  if (cache == NULL)
+    return heap_4_alloc (slot);
+
+  slab = cache->current;
+
+  if (slab == NULL)
+  {
+    slab = cache->slabs;
+    while (slab != NULL && slab->free == 0)
+      slab = slab->next;
+  }
+
+  if (slab == NULL)
+  {
+    slab = pvRTLHeapMallocAligned (heap_4,
+                                   replay_round (sizeof (replay_slab)) +
+                                   (cache->objects * cache->size),
+                                   0);
+    if (slab == NULL)
+      return NULL;
+    slab->free = replay_slab_full_map (cache);
+    slab->next = cache->slabs;
+    cache->slabs = slab;
+    ++cache->count;
+  }
+
+  obj = __builtin_ctz (slab->free);
+  slab->free &= ~(1UL << obj);
+  cache->current = slab->free != 0 ? slab : NULL;
+
+  slot->aux = slab;
+
+  return replay_slab_base (slab) + (obj * cache->size);
+}
+
+static void
+slab_free (replay_slot* slot)
+{
+  replay_slab_cache* cache = slab_cache (slot);
+  replay_slab*       slab = slot->aux;
+  replay_slab**      link;
+  size_t             obj;
+
+  if (cache == NULL)
+  {
+    heap_4_free (slot);
+    return;
+  }
+
+  obj = ((char*) slot->address - replay_slab_base (slab)) / cache->size;
+  slab->free |= 1UL << obj;
+
+  if (slab->free == replay_slab_full_map (cache) && cache->count > 1)
+  {
+    link = &cache->slabs;
+    while (*link != slab)
+      link = &(*link)->next;
+    *link = slab->next;
+    --cache->count;
+    if (cache->current == slab)
+      cache->current = NULL;
+    vRTLHeapFree (heap_4, slab);
+  }
+  else
+  {
+    cache->current = slab;
+  }
+}
+
+/*
+ * The arenas. They follow rtems_rtl_arena_alloc and rtems_rtl_arena_release.
+ */
+typedef struct replay_chunk
+{
+  struct replay_chunk* next;
+  size_t               size;
+  size_t               used;
+} replay_chunk;
+
+static replay_chunk** arenas;
+
+#define replay_chunk_base(_c) (((char*) (_c)) + replay_round (sizeof (replay_chunk)))
+
+static bool
+arena_open (const replay_trace* trace)
+{
+  arenas = calloc (trace->owners + 1, sizeof (replay_chunk*));
+  if (arenas == NULL)
+    return false;
+  return heap_4_open (trace);
+}
+
+static void
+arena_close (void)
+{
+  free (arenas);
+  arenas = NULL;
+  heap_4_close ();
+}
+
+static void*
+arena_alloc (replay_slot* slot)
+{
+  replay_chunk** arena;
+  replay_chunk*  chunk;
+  size_t         size;
+  void*          address;
+
+  if (slot->owner == 0)
+    return heap_4_alloc (slot);
+
+  arena = &arenas[slot->owner - 1];
+  chunk = *arena;
+  size = replay_round (slot->size == 0 ? 1 : slot->size);
+
+  if (chunk == NULL || (chunk->size - chunk->used) < size)
+  {
+    size_t chunk_size = REPLAY_ARENA_CHUNK;
+
+    if (size > (REPLAY_ARENA_CHUNK / 2))
+      chunk_size = size;
+
+    chunk = pvRTLHeapMallocAligned (heap_4,
+                                    replay_round (sizeof (replay_chunk)) + chunk_size,
+                                    0);
+    if (chunk == NULL)
+      return NULL;
+
+    chunk->size = chunk_size;
+    chunk->used = 0;
+
+    if (chunk_size == size && *arena != NULL)
+    {
+      chunk->next = (*arena)->next;
+      (*arena)->next = chunk;
+    }
+    else
+    {
+      chunk->next = *arena;
+      *arena = chunk;
+    }
+  }
+
+  address = replay_chunk_base (chunk) + chunk->used;
+  chunk->used += size;
+
+  return address;
+}
+
+static void
+arena_free (replay_slot* slot)
+{
+  if (slot->owner == 0)
+    heap_4_free (slot);
+}
+
+static void
+arena_release (uint32_t owner)
+{
+  replay_chunk* chunk = arenas[owner];
+  while (chunk != NULL)
+  {
+    replay_chunk* next = chunk->next;
+    vRTLHeapFree (heap_4, chunk);
+    chunk = next;
+  }
+  arenas[owner] = NULL;
+}
+
+static const replay_allocator allocators[] =
+{
+  { "heap_4", heap_4_open, heap_4_close, heap_4_alloc, heap_4_free,
+    heap_4_release, heap_4_free_size, heap_4_stats },
+  { "tlsf", tlsf_open, tlsf_close, tlsf_alloc, tlsf_free,
+    heap_4_release, tlsf_free_size, vRTLGetHeapStats },
+  { "slab", slab_open, heap_4_close, slab_alloc, slab_free,
+    heap_4_release, heap_4_free_size, heap_4_stats },
+  { "arena", arena_open, arena_close, arena_alloc, arena_free,
+    arena_release, heap_4_free_size, heap_4_stats }
+};
+
+#define REPLAY_ALLOCATORS (sizeof (allocators) / sizeof (allocators[0]))
+
+static double
+replay_now (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (ts.tv_sec * 1e9) + ts.tv_nsec;
+}
+
+static double
+replay_frag (const HeapStats_t* stats)
+{
+  if (stats->xAvailableHeapSpaceInBytes == 0)
+    return 0;
+  return 1.0 - ((double) stats->xSizeOfLargestFreeBlockInBytes /
+                stats->xAvailableHeapSpaceInBytes);
+}
+
+/*
+ * Run the operations once. The fragmentation is sampled if a result is
+ * passed. All allocations are freed at the end.
+ */
+static double
+replay_run (const replay_allocator* allocator,
+            replay_trace*           trace,
+            replay_result*          result)
+{
+  double start;
+  double ns = 0;
+  size_t o;
+  size_t s;
+
+  start = replay_now ();
+
+  for (o = 0; o < trace->op_count; ++o)
+  {
+    const replay_op* op = &trace->ops[o];
+    replay_slot*     slot;
+    uint32_t         r;
+
+    switch (op->type)
+    {
+      case REPLAY_NEW:
+        slot = &trace->slots[op->index];
+        slot->address = allocator->alloc (slot);
+        if (slot->address == NULL && result != NULL)
+          ++result->failed;
+        break;
+      case REPLAY_DEL:
+        slot = &trace->slots[op->index];
+        if (slot->address != NULL)
+          allocator->free (slot);
+        slot->address = NULL;
+        break;
+      case REPLAY_RELEASE:
+        for (r = 0; r < op->count; ++r)
+        {
+          slot = &trace->slots[trace->released[op->index + r]];
+          if (slot->address != NULL)
+            allocator->free (slot);
+          slot->address = NULL;
+        }
+        allocator->release (op->owner);
+        break;
+    }
+
+    if (result != NULL && (o % REPLAY_SAMPLE) == 0)
+    {
+      HeapStats_t stats;
+      ns += replay_now () - start;
+      allocator->stats (&stats);
+      if (replay_frag (&stats) > result->frag_max)
+        result->frag_max = replay_frag (&stats);
+      start = replay_now ();
+    }
+  }
+
+  ns += replay_now () - start;
+
+  if (result != NULL)
+  {
+    HeapStats_t stats;
+    allocator->stats (&stats);
+    result->frag_end = replay_frag (&stats);
+    if (result->frag_end > result->frag_max)
+      result->frag_max = result->frag_end;
+  }
+
+  /*
+   * Free what is still allocated so the TLSF heap is empty for the next
+   * run.
+   */
+  for (s = 0; s < trace->slot_count; ++s)
+  {
+    replay_slot* slot = &trace->slots[s];
+    if (slot->address != NULL)
+      allocator->free (slot);
+    slot->address = NULL;
+  }
+  for (s = 0; s < trace->owners; ++s)
+    allocator->release (s);
+
+  return ns;
+}
+
+static bool
+replay (const replay_allocator* allocator,
+        replay_trace*           trace,
+        replay_result*          result)
+{
+  HeapStats_t stats;
+  size_t      initial;
+  int         r;
+
+  memset (result, 0, sizeof (*result));
+
+  if (!allocator->open (trace))
+  {
+    printf ("error: %s: open failed\n", allocator->name);
+    return false;
+  }
+
+  initial = allocator->free_size ();
+
+  replay_run (allocator, trace, result);
+
+  allocator->stats (&stats);
+  result->peak = initial - stats.xMinimumEverFreeBytesRemaining;
+
+  for (r = 0; r < REPLAY_REPEATS; ++r)
+  {
+    double ns = replay_run (allocator, trace, NULL);
+    if (r == 0 || ns < result->ns)
+      result->ns = ns;
+  }
+
+  if (trace->op_count != 0)
+    result->ns /= trace->op_count;
+
+  allocator->close ();
+
+  return true;
+}
+
+int
+main (int argc, char* argv[])
+{
+  replay_trace trace;
+  size_t       a;
+
+  if (argc != 2)
+  {
+    printf ("usage: rtl-alloc-replay <record file>\n");
+    return 1;
+  }
+
+  if (!replay_load (argv[1], &trace))
+    return 1;
+
+  printf ("records: %zu: new=%zu del=%zu arena-release=%zu backing=%zu " \
+          "unmatched-del=%zu\n",
+          trace.records, trace.news, trace.dels, trace.releases,
+          trace.backing, trace.unmatched);
+  printf ("heap: %d bytes\n", configTOTAL_RTL_HEAP_SIZE);
+  printf ("%-8s %10s %9s %9s %7s %8s\n",
+          "alloc", "peak", "frag-max", "frag-end", "failed", "ns/op");
+
+  for (a = 0; a < REPLAY_ALLOCATORS; ++a)
+  {
+    replay_result result;
+    if (!replay (&allocators[a], &trace, &result))
+      break;
+    printf ("%-8s %10zu %8.1f%% %8.1f%% %7zu %8.1f\n",
+            allocators[a].name, result.peak,
+            result.frag_max * 100, result.frag_end * 100,
+            result.failed, result.ns);
+  }
+
+  free (trace.ops);
+  free (trace.slots);
+  free (trace.released);
+
+  return a == REPLAY_ALLOCATORS ? 0 : 1;
+}
@@ -0,0 +1,50 @@
+/*
+ *  The license and distribution terms for this file may be
+ *  found in the file LICENSE in this distribution or at
+ *  http://www.rtems.org/license/LICENSE.
+ */
+/**
+ * @file
+ *
+ * @ingroup rtems_rtl
+ *
+ * @brief RTEMS Run-Time Linker Allocation Replay Host Heaps
+ *
+ * The heap_4 and TLSF heaps are built for the host in their own files as
+ * their private names clash. The heap header includes the allocator header
+ * which needs the FreeRTOS lists so the heap calls are declared here.
+ */
+
+#if !defined (_RTEMS_RTL_ALLOC_REPLAY_H_)
+#define _RTEMS_RTL_ALLOC_REPLAY_H_
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+#define _RTEMS_RTL_ALLOC_HEAP_H_
+
+/*
+ * The TLSF heap. It is the RTL heap and uses ucRTLHeap.
+ */
+void * pvRTLMalloc( size_t xWantedSize );
+void * pvRTLMallocAligned( size_t xWantedSize, size_t xAlignment );
+void vRTLFree( void * pv );
+size_t xRTLtGetFreeHeapSize( void );
+void vRTLGetHeapStats( HeapStats_t * pxHeapStats );
+void vRTLInitialiseBlocks( void );
+
+/*
+ * The heap_4 region heap.
+ */
+typedef struct RTL_HEAP * RTLHeapHandle_t;
+
+RTLHeapHandle_t xRTLHeapCreate( void * pvMemory, size_t xSize );
+void * pvRTLHeapMallocAligned( RTLHeapHandle_t xHeap, size_t xWantedSize, size_t xAlignment );
+void vRTLHeapFree( RTLHeapHandle_t xHeap, void * pv );
+size_t xRTLHeapGetFreeSize( RTLHeapHandle_t xHeap );
+void vRTLHeapGetStats( RTLHeapHandle_t xHeap, HeapStats_t * pxHeapStats );
+
+extern uint8_t ucRTLHeap[ configTOTAL_RTL_HEAP_SIZE ];
+
+#endif
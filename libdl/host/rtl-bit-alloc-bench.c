@@ -0,0 +1,280 @@
+/*
+ *  The license and distribution terms for this file may be
+ *  found in the file LICENSE in this distribution or at
+ *  http://www.rtems.org/license/LICENSE.
+ */
+/**
+ * @file
+ *
+ * @ingroup rtems_rtl
+ *
+ * @brief RTEMS Run-Time Linker Bit Allocator Host Benchmark
+ *
+ * Compare the bit allocator's word at a time search with the bit at a time
+ * search it replaced. The allocator is built for the host with the RTL's
+ * allocator, error and trace calls replaced. Build and run from the top of
+ * the tree with:
+ *
+ *   cc -O2 -Iinclude -Ilibdl libdl/host/rtl-bit-alloc-bench.c \
+ *      -o rtl-bit-alloc-bench
+ *   ./rtl-bit-alloc-bench
+ *
+ * The random allocations and frees are checked to return the same blocks
+ * from both searches. The time to allocate and free a run of blocks is then
+ * reported for a range of fill levels.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <time.h>
+
+/*
+ * The host replacements for the RTL headers the allocator includes.
+ */
+#define _RTEMS_RTL_ALLOCATOR_H_
+#define _RTEMS_RTL_ERROR_H_
+#define _RTEMS_RTL_TRACE_H_
+
+#define RTEMS_RTL_ALLOC_OBJECT         0
+#define RTEMS_RTL_TRACE_BIT_ALLOC      0
+#define rtems_rtl_trace(_m)            (false)
+#define rtems_rtl_set_error(_e, _f)    do { } while (0)
+#define rtems_rtl_alloc_new(_t, _s, _z) calloc (1, (_s))
+#define rtems_rtl_alloc_del(_t, _p)    free (_p)
+
+#include "../rtl-bit-alloc.c"
+
+/*
+ * The bit at a time search. It uses the same bit map so an allocator opened
+ * by the RTL can be searched by either. The full word map is not used.
+ */
+static void
+ref_bit_set (rtems_rtl_bit_alloc* balloc, size_t start, size_t bits)
+{
+  size_t b;
+  for (b = start; b < (start + bits); ++b)
+    balloc->bits[b / BITS_PER_WORD] |= 1U << (b % BITS_PER_WORD);
+}
+
+static void
+ref_bit_clear (rtems_rtl_bit_alloc* balloc, size_t start, size_t bits)
+{
+  size_t b;
+  for (b = start; b < (start + bits); ++b)
+    balloc->bits[b / BITS_PER_WORD] &= ~(1U << (b % BITS_PER_WORD));
+}
+
+static ssize_t
+ref_bit_find_clear (rtems_rtl_bit_alloc* balloc, size_t blocks)
+{
+  size_t base = 0;
+  size_t clear = 0;
+  size_t b;
+
+  for (b = 0; b < balloc->blocks; ++b)
+  {
+    if (balloc->bits[b] != 0xffffffff)
+    {
+      uint32_t word = balloc->bits[b];
+      size_t   o;
+      for (o = 0; o < BITS_PER_WORD; ++o, word >>= 1)
+      {
+        if ((word & 1) == 0)
+        {
+          if (clear == 0)
+            base = (b * BITS_PER_WORD) + o;
+          ++clear;
+          if (clear == blocks)
+            return base;
+        }
+        else
+          clear = 0;
+      }
+    }
+    else
+      clear = 0;
+  }
+
+  return -1;
+}
+
+static void*
+ref_balloc (rtems_rtl_bit_alloc* balloc, size_t size)
+{
+  size_t  blocks = bit_blocks (balloc, size);
+  ssize_t block = ref_bit_find_clear (balloc, blocks);
+  if (block < 0)
+    return NULL;
+  ref_bit_set (balloc, block, blocks);
+  return (void*) (balloc->base + (block * balloc->block_size));
+}
+
+static void
+ref_bfree (rtems_rtl_bit_alloc* balloc, void* addr, size_t size)
+{
+  const uint8_t* a = (const uint8_t*) addr;
+  if (addr != NULL && a >= balloc->base && a < balloc->base + balloc->size)
+    ref_bit_clear (balloc, bit_blocks (balloc, a - balloc->base),
+                   bit_blocks (balloc, size));
+}
+
+typedef void* (*bench_balloc) (rtems_rtl_bit_alloc* balloc, size_t size);
+typedef void  (*bench_bfree) (rtems_rtl_bit_alloc* balloc, void* addr, size_t size);
+
+#define BENCH_BLOCK_SIZE (16)
+#define BENCH_BLOCKS     (8192)
+#define BENCH_SIZE       (BENCH_BLOCK_SIZE * BENCH_BLOCKS)
+#define BENCH_SLOTS      (300)
+#define BENCH_OPS        (300000)
+#define BENCH_RUN        (64)
+#define BENCH_REPEATS    (200)
+
+static double
+bench_now (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (ts.tv_sec * 1e9) + ts.tv_nsec;
+}
+
+/*
+ * Make the same random allocations and frees with both searches and check
+ * the same blocks are returned.
+ */
+static bool
+bench_check (void)
+{
+  rtems_rtl_bit_alloc* word;
+  rtems_rtl_bit_alloc* bit;
+  size_t               word_off[BENCH_SLOTS];
+  size_t               bit_off[BENCH_SLOTS];
+  size_t               sizes[BENCH_SLOTS];
+  bool                 held[BENCH_SLOTS];
+  int                  op;
+  bool                 ok = true;
+
+  word = rtems_rtl_bit_alloc_open (NULL, BENCH_SIZE, BENCH_BLOCK_SIZE, 100);
+  bit = rtems_rtl_bit_alloc_open (NULL, BENCH_SIZE, BENCH_BLOCK_SIZE, 100);
+  if (word == NULL || bit == NULL)
+  {
+    printf ("error: no memory\n");
+    return false;
+  }
+
+  memset (held, 0, sizeof (held));
+  srand (7);
+
+  for (op = 0; ok && op < BENCH_OPS; ++op)
+  {
+    int s = rand () % BENCH_SLOTS;
+    if (held[s])
+    {
+      rtems_rtl_bit_alloc_bfree (word, word->base + word_off[s], sizes[s]);
+      ref_bfree (bit, bit->base + bit_off[s], sizes[s]);
+      held[s] = false;
+    }
+    else
+    {
+      uint8_t* wa;
+      uint8_t* ba;
+      sizes[s] = 1 + rand () % ((rand () % 4) == 0 ? 4000 : 200);
+      wa = rtems_rtl_bit_alloc_balloc (word, sizes[s]);
+      ba = ref_balloc (bit, sizes[s]);
+      if ((wa == NULL) != (ba == NULL) ||
+          (wa != NULL && (wa - word->base) != (ba - bit->base)))
+      {
+        printf ("error: op %d: size %zu: word=%td bit=%td\n",
+                op, sizes[s],
+                wa == NULL ? (ptrdiff_t) -1 : wa - word->base,
+                ba == NULL ? (ptrdiff_t) -1 : ba - bit->base);
+        ok = false;
+      }
+      if (wa != NULL)
+      {
+        word_off[s] = wa - word->base;
+        bit_off[s] = ba - bit->base;
+        held[s] = true;
+      }
+    }
+  }
+
+  rtems_rtl_bit_alloc_close (word);
+  rtems_rtl_bit_alloc_close (bit);
+
+  if (ok)
+    printf ("check: %d random allocations and frees match\n", BENCH_OPS);
+
+  return ok;
+}
+
+/*
+ * Fill the allocator to a level with single blocks, free every 16th of them
+ * to fragment the filled part and time allocating and freeing a run that
+ * only fits above the fill level.
+ */
+static double
+bench_time (int fill, bool solid, bench_balloc balloc, bench_bfree bfree)
+{
+  rtems_rtl_bit_alloc* ba;
+  size_t               blocks = (BENCH_BLOCKS * fill) / 100;
+  size_t               b;
+  double               start;
+  int                  r;
+
+  ba = rtems_rtl_bit_alloc_open (NULL, BENCH_SIZE, BENCH_BLOCK_SIZE, 0);
+  if (ba == NULL)
+    return 0;
+
+  for (b = 0; b < blocks; ++b)
+    balloc (ba, BENCH_BLOCK_SIZE);
+  if (!solid)
+  {
+    for (b = 0; b < blocks; b += 16)
+      bfree (ba, ba->base + (b * BENCH_BLOCK_SIZE), BENCH_BLOCK_SIZE);
+  }
+
+  start = bench_now ();
+  for (r = 0; r < BENCH_REPEATS; ++r)
+  {
+    void* p = balloc (ba, BENCH_RUN * BENCH_BLOCK_SIZE);
+    bfree (ba, p, BENCH_RUN * BENCH_BLOCK_SIZE);
+  }
+
+  rtems_rtl_bit_alloc_close (ba);
+
+  return (bench_now () - start) / BENCH_REPEATS;
+}
+
+int
+main (void)
+{
+  int fill;
+  int solid;
+
+  if (!bench_check ())
+    return 1;
+
+  printf ("%d blocks, alloc and free of a %d block run, ns per pair:\n",
+          BENCH_BLOCKS, BENCH_RUN);
+
+  for (solid = 0; solid < 2; ++solid)
+  {
+    printf (" %s:\n", solid ? "solid fill" : "fragmented fill");
+    for (fill = 0; fill <= 95; fill += 19)
+    {
+      double bit = bench_time (fill, solid, ref_balloc, ref_bfree);
+      double word = bench_time (fill, solid, rtems_rtl_bit_alloc_balloc,
+                                rtems_rtl_bit_alloc_bfree);
+      printf ("  fill %3d%%: bit %8.0f  word %8.0f\n", fill, bit, word);
+    }
+  }
+
+  return 0;
+}
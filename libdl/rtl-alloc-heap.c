@@ -21,17 +21,10 @@
 #include <FreeRTOS.h>
 #include "semphr.h"
 
-static void*
-rtems_rtl_alloc_heap_aligned(size_t size, size_t alignment) {
-  void* address = NULL;
-  size_t new_size = (size + alignment + sizeof(void*));
-
-  address = pvPortMalloc(new_size);
-
-  void **ptr = (void**)((uintptr_t)(address + alignment + sizeof(void*)) & ~(alignment - 1));
-  ptr[-1] = address;
-  return ptr;
-}
+/**
+ * The alignment of module memory and captables.
+ */
+#define RTEMS_RTL_ALLOC_HEAP_ALIGN (16)
 
 void
 rtems_rtl_alloc_heap (rtems_rtl_alloc_cmd cmd,
@@ -46,20 +39,13 @@ rtems_rtl_alloc_heap (rtems_rtl_alloc_cmd cmd,
           tag == RTEMS_RTL_ALLOC_READ   ||
           tag == RTEMS_RTL_ALLOC_READ_WRITE ||
           tag == RTEMS_RTL_ALLOC_READ_EXEC) {
-        *address = rtems_rtl_alloc_heap_aligned (size, 16);
+        *address = pvRTLMallocAligned (size, RTEMS_RTL_ALLOC_HEAP_ALIGN);
       } else {
-        *address = pvRTLMalloc (size);
+        *address = pvRTLMallocAligned (size, 0);
       }
       break;
     case RTEMS_RTL_ALLOC_DEL:
-      if (tag == RTEMS_RTL_ALLOC_CAPTAB ||
-          tag == RTEMS_RTL_ALLOC_READ   ||
-          tag == RTEMS_RTL_ALLOC_READ_WRITE ||
-          tag == RTEMS_RTL_ALLOC_READ_EXEC) {
-        vPortFree(((void**) *address)[-1]);
-      } else {
-        vRTLFree (*address);
-      }
+      vRTLFree (*address);
       *address = NULL;
       break;
     case RTEMS_RTL_ALLOC_LOCK:
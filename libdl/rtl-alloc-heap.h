@@ -18,13 +18,37 @@
 
 #include <rtl/rtl-allocator.h>
 
+/**
+ * The RTL heap is heap_4 unless the TLSF heap is selected. Only one RTL heap
+ * is built as each reserves a static array of configTOTAL_RTL_HEAP_SIZE
+ * bytes. Region heaps are always heap_4 heaps.
+ */
+#ifndef configRTL_HEAP_TLSF
+  #define configRTL_HEAP_TLSF 0
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
 
 void * pvRTLMalloc( size_t xWantedSize );
+void * pvRTLMallocAligned( size_t xWantedSize, size_t xAlignment );
 void vRTLFree( void * pv );
 size_t xRTLtGetFreeHeapSize();
+void vRTLGetHeapStats( HeapStats_t * pxHeapStats );
+void vRTLInitialiseBlocks( void );
+
+/**
+ * A region heap. A region heap manages memory given to it, for example an
+ * on-chip RAM, and holds its control data at the start of the memory.
+ */
+typedef struct RTL_HEAP * RTLHeapHandle_t;
+
+RTLHeapHandle_t xRTLHeapCreate( void * pvMemory, size_t xSize );
+void * pvRTLHeapMallocAligned( RTLHeapHandle_t xHeap, size_t xWantedSize, size_t xAlignment );
+void vRTLHeapFree( RTLHeapHandle_t xHeap, void * pv );
+size_t xRTLHeapGetFreeSize( RTLHeapHandle_t xHeap );
+void vRTLHeapGetStats( RTLHeapHandle_t xHeap, HeapStats_t * pxHeapStats );
 
 /**
  * Allocator handler for the standard libc heap.
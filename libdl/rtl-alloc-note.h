@@ -0,0 +1,64 @@
+/*
+ *  The license and distribution terms for this file may be
+ *  found in the file LICENSE in this distribution or at
+ *  http://www.rtems.org/license/LICENSE.
+ */
+/**
+ * @file
+ *
+ * @ingroup rtems_rtl
+ *
+ * @brief RTEMS Run-Time Linker Allocation Recorder Notes.
+ *
+ * The allocations made in a memory region, a slab cache or an arena do not
+ * call the allocator so the recorder does not see them. The allocator notes
+ * them to the recorder. The memory the allocator takes to hold slabs and
+ * arena chunks is marked as backing memory so a replay can tell the loader's
+ * requests from the allocator's.
+ */
+
+#if !defined (_RTEMS_RTL_ALLOC_NOTE_H_)
+#define _RTEMS_RTL_ALLOC_NOTE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <rtl/rtl-allocator.h>
+#include <rtl/rtl-alloc-record.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Note an allocation or free that did not call the allocator. Nothing is
+ * recorded if the recorder is not recording.
+ *
+ * @param cmd The allocator command, new or delete.
+ * @param tag The allocation's tag.
+ * @param source The source of the memory, RTEMS_RTL_ALLOC_RECORD_REGION,
+ *               RTEMS_RTL_ALLOC_RECORD_SLAB or RTEMS_RTL_ALLOC_RECORD_ARENA.
+ * @param address The address allocated or freed. An arena release is 0.
+ * @param size The size of an allocation.
+ * @param owner The arena of an arena allocation or release, otherwise NULL.
+ */
+void rtems_rtl_alloc_record_note (rtems_rtl_alloc_cmd cmd,
+                                  rtems_rtl_alloc_tag tag,
+                                  uint8_t             source,
+                                  const void*         address,
+                                  size_t              size,
+                                  const void*         owner);
+
+/**
+ * Mark the allocations that follow as backing memory for slabs or arena
+ * chunks. The calls nest and are made with the RTL locked.
+ *
+ * @param backing True to start marking allocations, false to stop.
+ */
+void rtems_rtl_alloc_record_backing (bool backing);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif
@@ -0,0 +1,309 @@
+/*
+ *  The license and distribution terms for this file may be
+ *  found in the file LICENSE in this distribution or at
+ *  http://www.rtems.org/license/LICENSE.
+ */
+/**
+ * @file
+ *
+ * @ingroup rtems_rtl
+ *
+ * @brief RTEMS Run-Time Linker Allocation Recorder
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <rtl/rtl.h>
+#include <rtl/rtl-alloc-record.h>
+#include "rtl-alloc-note.h"
+#include "rtl-error.h"
+#include <rtl/rtl-trace.h>
+
+#include <FreeRTOS.h>
+#include "task.h"
+
+/**
+ * The record times are the RTL clock. The run time stats counter has the
+ * resolution to time a request. The tick count only orders them.
+ */
+#if RTEMS_RTL_CLOCK_RUN_TIME
+#define RTEMS_RTL_ALLOC_RECORD_FLAGS RTEMS_RTL_ALLOC_RECORD_RUN_TIME
+#else
+#define RTEMS_RTL_ALLOC_RECORD_FLAGS 0
+#endif
+
+/**
+ * The recorder's data. The allocator is called with the RTL locked so the
+ * data is protected by the RTL lock.
+ */
+typedef struct rtems_rtl_alloc_recorder
+{
+  rtems_rtl_allocator     previous;  /**< The allocator requests are passed
+                                      *   to. */
+  rtems_rtl_alloc_record* records;   /**< The ring buffer. */
+  size_t                  size;      /**< The number of records in the
+                                      *   ring. */
+  size_t                  head;      /**< The next record written. */
+  size_t                  count;     /**< The number of records held. */
+  uint32_t                dropped;   /**< The records overwritten. */
+  int                     backing;   /**< The allocations back slabs or
+                                      *   arena chunks. */
+  bool                    recording; /**< Requests are being recorded. */
+} rtems_rtl_alloc_recorder;
+
+static rtems_rtl_alloc_recorder recorder;
+
+/*
+ * Get the next record to write. The record's source is set.
+ */
+static rtems_rtl_alloc_record*
+rtems_rtl_alloc_record_next (uint8_t source)
+{
+  rtems_rtl_alloc_record* record = &recorder.records[recorder.head];
+  if (recorder.backing > 0)
+    source |= RTEMS_RTL_ALLOC_RECORD_BACKING;
+  record->owner = 0;
+  record->source = source;
+  record->reserved = 0;
+  return record;
+}
+
+/*
+ * Advance the ring over the record written.
+ */
+static void
+rtems_rtl_alloc_record_advance (void)
+{
+  ++recorder.head;
+  if (recorder.head >= recorder.size)
+    recorder.head = 0;
+  if (recorder.count < recorder.size)
+    ++recorder.count;
+  else
+    ++recorder.dropped;
+}
+
+static void
+rtems_rtl_alloc_record_handler (rtems_rtl_alloc_cmd cmd,
+                                rtems_rtl_alloc_tag tag,
+                                void**              address,
+                                size_t              size)
+{
+  rtems_rtl_alloc_record* record;
+  uint32_t                start;
+
+  if (!recorder.recording ||
+      (cmd != RTEMS_RTL_ALLOC_NEW && cmd != RTEMS_RTL_ALLOC_DEL))
+  {
+    recorder.previous (cmd, tag, address, size);
+    return;
+  }
+
+  /*
+   * The address of a free is cleared by the allocator so record it first.
+   */
+  record = rtems_rtl_alloc_record_next (RTEMS_RTL_ALLOC_RECORD_HEAP);
+  record->address = (uint64_t) (uintptr_t) *address;
+  record->size = cmd == RTEMS_RTL_ALLOC_NEW ? (uint32_t) size : 0;
+  record->cmd = (uint8_t) cmd;
+  record->tag = (uint8_t) tag;
+
+  start = rtems_rtl_clock ();
+  recorder.previous (cmd, tag, address, size);
+  record->time = start;
+  record->duration = rtems_rtl_clock () - start;
+
+  if (cmd == RTEMS_RTL_ALLOC_NEW)
+    record->address = (uint64_t) (uintptr_t) *address;
+
+  rtems_rtl_alloc_record_advance ();
+}
+
+void
+rtems_rtl_alloc_record_note (rtems_rtl_alloc_cmd cmd,
+                             rtems_rtl_alloc_tag tag,
+                             uint8_t             source,
+                             const void*         address,
+                             size_t              size,
+                             const void*         owner)
+{
+  rtems_rtl_alloc_record* record;
+
+  if (!recorder.recording)
+    return;
+
+  rtems_rtl_lock ();
+
+  if (recorder.recording)
+  {
+    record = rtems_rtl_alloc_record_next (source);
+    record->address = (uint64_t) (uintptr_t) address;
+    record->owner = (uint64_t) (uintptr_t) owner;
+    record->time = rtems_rtl_clock ();
+    record->duration = 0;
+    record->size = cmd == RTEMS_RTL_ALLOC_NEW ? (uint32_t) size : 0;
+    record->cmd = (uint8_t) cmd;
+    record->tag = (uint8_t) tag;
+    rtems_rtl_alloc_record_advance ();
+  }
+
+  rtems_rtl_unlock ();
+}
+
+void
+rtems_rtl_alloc_record_backing (bool backing)
+{
+  if (backing)
+    ++recorder.backing;
+  else if (recorder.backing > 0)
+    --recorder.backing;
+}
+
+bool
+rtems_rtl_alloc_record_start (void* buffer, size_t size)
+{
+  rtems_rtl_data* rtl = rtems_rtl_lock ();
+  bool            started = false;
+
+  if (rtl != NULL && !recorder.recording &&
+      buffer != NULL && size >= sizeof (rtems_rtl_alloc_record))
+  {
+    recorder.records = buffer;
+    recorder.size = size / sizeof (rtems_rtl_alloc_record);
+    recorder.head = 0;
+    recorder.count = 0;
+    recorder.dropped = 0;
+    recorder.recording = true;
+    /*
+     * The recorder may still be hooked if it was stopped after another
+     * allocator was hooked.
+     */
+    if (rtl->allocator.allocator != rtems_rtl_alloc_record_handler)
+      recorder.previous = rtems_rtl_alloc_hook (rtems_rtl_alloc_record_handler);
+    started = true;
+  }
+
+  rtems_rtl_unlock ();
+
+  if (rtems_rtl_trace (RTEMS_RTL_TRACE_ALLOCATOR))
+    printf ("rtl: alloc: record: start: records=%zu%s\n",
+            size / sizeof (rtems_rtl_alloc_record),
+            started ? "" : ": not started");
+
+  return started;
+}
+
+void
+rtems_rtl_alloc_record_stop (void)
+{
+  rtems_rtl_data* rtl = rtems_rtl_lock ();
+
+  if (rtl != NULL && recorder.recording)
+  {
+    recorder.recording = false;
+    if (rtl->allocator.allocator == rtems_rtl_alloc_record_handler)
+      rtems_rtl_alloc_hook (recorder.previous);
+  }
+
+  rtems_rtl_unlock ();
+
+  if (rtems_rtl_trace (RTEMS_RTL_TRACE_ALLOCATOR))
+    printf ("rtl: alloc: record: stop: records=%zu dropped=%" PRIu32 "\n",
+            recorder.count, recorder.dropped);
+}
+
+void
+rtems_rtl_alloc_record_header_get (rtems_rtl_alloc_record_header* header)
+{
+  rtems_rtl_lock ();
+  header->magic = RTEMS_RTL_ALLOC_RECORD_MAGIC;
+  header->version = RTEMS_RTL_ALLOC_RECORD_VERSION;
+  header->record_size = sizeof (rtems_rtl_alloc_record);
+  header->flags = RTEMS_RTL_ALLOC_RECORD_FLAGS;
+  header->count = recorder.count;
+  header->dropped = recorder.dropped;
+  header->heap_size = configTOTAL_RTL_HEAP_SIZE;
+  rtems_rtl_unlock ();
+}
+
+/*
+ * Write all of a buffer to the file.
+ */
+static bool
+rtems_rtl_alloc_record_write_data (int fd, const void* buffer, size_t size)
+{
+  const uint8_t* b = buffer;
+  while (size > 0)
+  {
+    ssize_t w = write (fd, b, size);
+    if (w <= 0)
+      return false;
+    b += w;
+    size -= w;
+  }
+  return true;
+}
+
+bool
+rtems_rtl_alloc_record_write (const char* name)
+{
+  rtems_rtl_alloc_record_header header;
+  size_t                        first;
+  size_t                        count;
+  int                           fd;
+  bool                          ok;
+
+  fd = open (name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+  {
+    rtems_rtl_set_error (errno, "record file open: %s", name);
+    return false;
+  }
+
+  /*
+   * Hold the lock so the records do not change as they are written. The
+   * file system does not allocate with the RTL allocator.
+   */
+  rtems_rtl_lock ();
+
+  rtems_rtl_alloc_record_header_get (&header);
+
+  first = recorder.count < recorder.size ? 0 : recorder.head;
+  count = recorder.count;
+
+  ok = rtems_rtl_alloc_record_write_data (fd, &header, sizeof (header));
+
+  /*
+   * The records are oldest first. If the ring has wrapped the oldest record
+   * is the head.
+   */
+  if (ok && count > 0)
+  {
+    size_t records = recorder.size - first;
+    if (records > count)
+      records = count;
+    ok = rtems_rtl_alloc_record_write_data (fd, &recorder.records[first],
+                                            records * sizeof (rtems_rtl_alloc_record));
+    if (ok && records < count)
+      ok = rtems_rtl_alloc_record_write_data (fd, &recorder.records[0],
+                                              (count - records) * sizeof (rtems_rtl_alloc_record));
+  }
+
+  rtems_rtl_unlock ();
+
+  close (fd);
+
+  if (!ok)
+    rtems_rtl_set_error (EIO, "record file write: %s", name);
+
+  if (rtems_rtl_trace (RTEMS_RTL_TRACE_ALLOCATOR))
+    printf ("rtl: alloc: record: write: %s: records=%zu%s\n",
+            name, count, ok ? "" : ": failed");
+
+  return ok;
+}
@@ -13,11 +13,17 @@
  * @brief RTEMS Run-Time Linker Allocator
  */
 
+#include <ctype.h>
+#include <errno.h>
+#include <fnmatch.h>
+#include <inttypes.h>
 #include <stdio.h>
 #include <string.h>
 
 #include <rtl/rtl.h>
 #include "rtl-alloc-heap.h"
+#include "rtl-alloc-note.h"
+#include "rtl-error.h"
 #include <rtl/rtl-trace.h>
 
 /**
@@ -39,6 +45,18 @@ static const char* tag_labels[7] =
 #define rtems_rtl_trace_tag_label(_l) ""
 #endif
 
+/**
+ * The module part labels used in a placement.
+ */
+static const char* part_labels[RTEMS_RTL_ALLOC_PARTS] =
+{
+  "text",
+  "const",
+  "eh",
+  "data",
+  "bss"
+};
+
 void
 rtems_rtl_alloc_initialise (rtems_rtl_alloc_data* data)
 {
@@ -46,6 +64,150 @@ rtems_rtl_alloc_initialise (rtems_rtl_alloc_data* data)
   data->allocator = rtems_rtl_alloc_heap;
   for (c = 0; c < RTEMS_RTL_ALLOC_TAGS; ++c)
     vListInitialise (&data->indirects[c]);
+  vListInitialise (&data->movables);
+  vListInitialise (&data->regions);
+  vListInitialise (&data->placements);
+  data->module_image = RTEMS_RTL_ALLOC_MODULE_IMAGE;
+  memset (data->stats, 0, sizeof (data->stats));
+  for (c = 0; c < RTEMS_RTL_ALLOC_TAGS; ++c)
+  {
+    int sc;
+    for (sc = 0; sc < RTEMS_RTL_SLAB_CLASSES; ++sc)
+    {
+      rtems_rtl_slab_cache* cache = &data->slabs[c][sc];
+      cache->size = RTEMS_RTL_SLAB_MIN_SIZE << sc;
+      cache->objects = RTEMS_RTL_SLAB_SIZE / cache->size;
+      if (cache->objects > 32)
+        cache->objects = 32;
+      cache->slabs = NULL;
+      cache->current = NULL;
+      cache->count = 0;
+      cache->allocs = 0;
+    }
+  }
+  /*
+   * Set up the heap so the free bytes are valid before the first allocation
+   * is accounted.
+   */
+  vRTLInitialiseBlocks ();
+}
+
+/*
+ * Account an allocation. The bytes taken are the change in the free bytes of
+ * the heap the memory is allocated from.
+ */
+static void
+rtems_rtl_alloc_account_new (rtems_rtl_data*     rtl,
+                             rtems_rtl_alloc_tag tag,
+                             size_t              free_before,
+                             size_t              free_after)
+{
+  rtems_rtl_alloc_tag_stats* stats = &rtl->allocator.stats[tag];
+  if (free_before > free_after)
+    stats->live += free_before - free_after;
+  if (stats->live > stats->peak)
+    stats->peak = stats->live;
+  ++stats->allocs;
+}
+
+static void
+rtems_rtl_alloc_account_del (rtems_rtl_data*     rtl,
+                             rtems_rtl_alloc_tag tag,
+                             size_t              free_before,
+                             size_t              free_after)
+{
+  rtems_rtl_alloc_tag_stats* stats = &rtl->allocator.stats[tag];
+  size_t                     freed;
+  freed = free_after > free_before ? free_after - free_before : 0;
+  stats->live = stats->live > freed ? stats->live - freed : 0;
+  ++stats->frees;
+}
+
+/*
+ * Module memory is aligned in a region as the heap allocator aligns it.
+ */
+static size_t
+rtems_rtl_alloc_region_align (rtems_rtl_alloc_tag tag)
+{
+  switch (tag)
+  {
+    case RTEMS_RTL_ALLOC_CAPTAB:
+    case RTEMS_RTL_ALLOC_READ:
+    case RTEMS_RTL_ALLOC_READ_WRITE:
+    case RTEMS_RTL_ALLOC_READ_EXEC:
+      return RTEMS_RTL_ALLOC_MODULE_ALIGN;
+    default:
+      break;
+  }
+  return 0;
+}
+
+static void*
+rtems_rtl_alloc_region_alloc (rtems_rtl_data*         rtl,
+                              rtems_rtl_alloc_region* region,
+                              rtems_rtl_alloc_tag     tag,
+                              size_t                  size)
+{
+  size_t free = xRTLHeapGetFreeSize (region->heap);
+  void*  address;
+
+  address = pvRTLHeapMallocAligned (region->heap, size,
+                                    rtems_rtl_alloc_region_align (tag));
+  if (address != NULL)
+  {
+    rtems_rtl_alloc_account_new (rtl, tag, free,
+                                 xRTLHeapGetFreeSize (region->heap));
+    rtems_rtl_alloc_record_note (RTEMS_RTL_ALLOC_NEW, tag,
+                                 RTEMS_RTL_ALLOC_RECORD_REGION,
+                                 address, size, NULL);
+  }
+
+  if (rtems_rtl_trace (RTEMS_RTL_TRACE_ALLOCATOR))
+    printf ("rtl: alloc: region: %s: %s addr=%p size=%zu\n",
+            region->name, rtems_rtl_trace_tag_label (tag), address, size);
+
+  return address;
+}
+
+/*
+ * Allocate in the first region with space that holds the tag.
+ */
+static void*
+rtems_rtl_alloc_region_tag_alloc (rtems_rtl_data*     rtl,
+                                  rtems_rtl_alloc_tag tag,
+                                  size_t              size)
+{
+  ListItem_t* node = listGET_HEAD_ENTRY (&rtl->allocator.regions);
+  while (listGET_END_MARKER (&rtl->allocator.regions) != node)
+  {
+    rtems_rtl_alloc_region* region = listGET_LIST_ITEM_OWNER (node);
+    if ((region->tags & RTEMS_RTL_ALLOC_TAG_MASK (tag)) != 0)
+    {
+      void* address = rtems_rtl_alloc_region_alloc (rtl, region, tag, size);
+      if (address != NULL)
+        return address;
+    }
+    node = listGET_NEXT (node);
+  }
+  return NULL;
+}
+
+/*
+ * Find the region the memory is allocated in.
+ */
+static rtems_rtl_alloc_region*
+rtems_rtl_alloc_region_address (rtems_rtl_data* rtl, void* address)
+{
+  ListItem_t* node = listGET_HEAD_ENTRY (&rtl->allocator.regions);
+  while (listGET_END_MARKER (&rtl->allocator.regions) != node)
+  {
+    rtems_rtl_alloc_region* region = listGET_LIST_ITEM_OWNER (node);
+    if ((uintptr_t) address >= (uintptr_t) region->base &&
+        (uintptr_t) address < ((uintptr_t) region->base + region->size))
+      return region;
+    node = listGET_NEXT (node);
+  }
+  return NULL;
 }
 
 void*
@@ -55,11 +217,20 @@ rtems_rtl_alloc_new (rtems_rtl_alloc_tag tag, size_t size, bool zero)
   void*           address = NULL;
 
   /*
-   * Obtain memory from the allocator. The address field is set by the
-   * allocator.
+   * Obtain memory from a region that holds the tag or the allocator. The
+   * address field is set by the allocator.
    */
   if (rtl != NULL)
-    rtl->allocator.allocator (RTEMS_RTL_ALLOC_NEW, tag, &address, size);
+  {
+    address = rtems_rtl_alloc_region_tag_alloc (rtl, tag, size);
+    if (address == NULL)
+    {
+      size_t free = xRTLtGetFreeHeapSize ();
+      rtl->allocator.allocator (RTEMS_RTL_ALLOC_NEW, tag, &address, size);
+      if (address != NULL)
+        rtems_rtl_alloc_account_new (rtl, tag, free, xRTLtGetFreeHeapSize ());
+    }
+  }
 
   rtems_rtl_unlock ();
 
@@ -86,9 +257,328 @@ rtems_rtl_alloc_del (rtems_rtl_alloc_tag tag, void* address)
             rtems_rtl_trace_tag_label (tag), address);
 
   if (rtl != NULL && address != NULL)
-    rtl->allocator.allocator (RTEMS_RTL_ALLOC_DEL, tag, &address, 0);
+  {
+    rtems_rtl_alloc_region* region;
+    region = rtems_rtl_alloc_region_address (rtl, address);
+    if (region != NULL)
+    {
+      size_t free = xRTLHeapGetFreeSize (region->heap);
+      rtems_rtl_alloc_record_note (RTEMS_RTL_ALLOC_DEL, tag,
+                                   RTEMS_RTL_ALLOC_RECORD_REGION,
+                                   address, 0, NULL);
+      vRTLHeapFree (region->heap, address);
+      rtems_rtl_alloc_account_del (rtl, tag, free,
+                                   xRTLHeapGetFreeSize (region->heap));
+    }
+    else
+    {
+      size_t free = xRTLtGetFreeHeapSize ();
+      rtl->allocator.allocator (RTEMS_RTL_ALLOC_DEL, tag, &address, 0);
+      rtems_rtl_alloc_account_del (rtl, tag, free, xRTLtGetFreeHeapSize ());
+    }
+  }
+
+  rtems_rtl_unlock ();
+}
+
+bool
+rtems_rtl_alloc_region_add (const char* name,
+                            void*       base,
+                            size_t      size,
+                            uint32_t    tags)
+{
+  rtems_rtl_data*         rtl;
+  rtems_rtl_alloc_region* region;
+  size_t                  len;
+
+  if (rtems_rtl_trace (RTEMS_RTL_TRACE_ALLOCATOR))
+    printf ("rtl: alloc: region: add: %s base=%p size=%zu tags=%08" PRIx32 "\n",
+            name, base, size, tags);
+
+  if (rtems_rtl_alloc_region_find (name) != NULL)
+  {
+    rtems_rtl_set_error (EEXIST, "region already exists: %s", name);
+    return false;
+  }
+
+  len = strlen (name) + 1;
+
+  region = rtems_rtl_alloc_new (RTEMS_RTL_ALLOC_OBJECT,
+                                sizeof (rtems_rtl_alloc_region) + len, true);
+  if (region == NULL)
+  {
+    rtems_rtl_set_error (ENOMEM, "no memory for region");
+    return false;
+  }
+
+  region->heap = xRTLHeapCreate (base, size);
+  if (region->heap == NULL)
+  {
+    rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_OBJECT, region);
+    rtems_rtl_set_error (EINVAL, "region too small: %s", name);
+    return false;
+  }
+
+  memcpy (((char*) region) + sizeof (rtems_rtl_alloc_region), name, len);
+  region->name = ((char*) region) + sizeof (rtems_rtl_alloc_region);
+  region->base = base;
+  region->size = size;
+  region->tags = tags;
+
+  rtl = rtems_rtl_lock ();
+  vListInitialiseItem (&region->node);
+  listSET_LIST_ITEM_OWNER (&region->node, region);
+  vListInsertEnd (&rtl->allocator.regions, &region->node);
+  rtems_rtl_unlock ();
+
+  return true;
+}
+
+rtems_rtl_alloc_region*
+rtems_rtl_alloc_region_find (const char* name)
+{
+  rtems_rtl_data*         rtl = rtems_rtl_lock ();
+  rtems_rtl_alloc_region* found = NULL;
+
+  if (rtl != NULL && name != NULL)
+  {
+    ListItem_t* node = listGET_HEAD_ENTRY (&rtl->allocator.regions);
+    while (listGET_END_MARKER (&rtl->allocator.regions) != node)
+    {
+      rtems_rtl_alloc_region* region = listGET_LIST_ITEM_OWNER (node);
+      if (strcmp (region->name, name) == 0)
+      {
+        found = region;
+        break;
+      }
+      node = listGET_NEXT (node);
+    }
+  }
+
+  rtems_rtl_unlock ();
+
+  return found;
+}
+
+void*
+rtems_rtl_alloc_region_new (const char*         name,
+                            rtems_rtl_alloc_tag tag,
+                            size_t              size,
+                            bool                zero)
+{
+  rtems_rtl_data* rtl;
+  void*           address = NULL;
+
+  if (name == NULL)
+    return rtems_rtl_alloc_new (tag, size, zero);
+
+  rtl = rtems_rtl_lock ();
+
+  if (rtl != NULL)
+  {
+    rtems_rtl_alloc_region* region = rtems_rtl_alloc_region_find (name);
+    if (region != NULL)
+      address = rtems_rtl_alloc_region_alloc (rtl, region, tag, size);
+    if (address == NULL && rtems_rtl_trace (RTEMS_RTL_TRACE_ALLOCATOR))
+      printf ("rtl: alloc: region: %s: %s, allocate by tag\n",
+              name, region == NULL ? "not found" : "full");
+  }
 
   rtems_rtl_unlock ();
+
+  if (address == NULL)
+    return rtems_rtl_alloc_new (tag, size, zero);
+
+  if (zero)
+    memset (address, 0, size);
+
+  return address;
+}
+
+bool
+rtems_rtl_alloc_placement_add (const char* name,
+                               const char* placement,
+                               bool        config)
+{
+  rtems_rtl_data*            rtl;
+  rtems_rtl_alloc_placement* place;
+  size_t                     name_len = strlen (name) + 1;
+  size_t                     len = strlen (placement) + 1;
+  char*                      s;
+
+  if (rtems_rtl_trace (RTEMS_RTL_TRACE_ALLOCATOR))
+    printf ("rtl: alloc: placement: add: %s: %s%s\n",
+            name, placement, config ? " (config)" : "");
+
+  place = rtems_rtl_alloc_new (RTEMS_RTL_ALLOC_OBJECT,
+                               sizeof (rtems_rtl_alloc_placement) +
+                               name_len + len,
+                               true);
+  if (place == NULL)
+  {
+    rtems_rtl_set_error (ENOMEM, "no memory for placement");
+    return false;
+  }
+
+  s = ((char*) place) + sizeof (rtems_rtl_alloc_placement);
+  memcpy (s, name, name_len);
+  place->name = s;
+  s += name_len;
+  memcpy (s, placement, len);
+  place->config = config;
+
+  /*
+   * Split the placement into part and region pairs in place. The regions
+   * point into the placement's copy.
+   */
+  while (*s != '\0')
+  {
+    char*  part;
+    char*  region;
+    size_t p;
+
+    while (*s != '\0' && (isspace ((unsigned char) *s) || *s == ','))
+      ++s;
+    if (*s == '\0')
+      break;
+
+    part = s;
+    while (*s != '\0' && !isspace ((unsigned char) *s) && *s != ',')
+      ++s;
+    if (*s != '\0')
+      *s++ = '\0';
+
+    region = strchr (part, '=');
+    if (region == NULL || region[1] == '\0')
+    {
+      rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_OBJECT, place);
+      rtems_rtl_set_error (EINVAL, "invalid placement: %s", part);
+      return false;
+    }
+
+    *region = '\0';
+    ++region;
+
+    if (strcmp (part, "all") == 0)
+    {
+      for (p = 0; p < RTEMS_RTL_ALLOC_PARTS; ++p)
+        place->regions[p] = region;
+    }
+    else
+    {
+      for (p = 0; p < RTEMS_RTL_ALLOC_PARTS; ++p)
+      {
+        if (strcmp (part, part_labels[p]) == 0)
+        {
+          place->regions[p] = region;
+          break;
+        }
+      }
+      if (p >= RTEMS_RTL_ALLOC_PARTS)
+      {
+        rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_OBJECT, place);
+        rtems_rtl_set_error (EINVAL, "invalid placement part: %s", part);
+        return false;
+      }
+    }
+  }
+
+  rtl = rtems_rtl_lock ();
+  vListInitialiseItem (&place->node);
+  listSET_LIST_ITEM_OWNER (&place->node, place);
+  vListInsertEnd (&rtl->allocator.placements, &place->node);
+  rtems_rtl_unlock ();
+
+  return true;
+}
+
+void
+rtems_rtl_alloc_placement_remove (const char* name)
+{
+  rtems_rtl_data* rtl = rtems_rtl_lock ();
+
+  if (rtl != NULL)
+  {
+    ListItem_t* node = listGET_HEAD_ENTRY (&rtl->allocator.placements);
+    while (listGET_END_MARKER (&rtl->allocator.placements) != node)
+    {
+      rtems_rtl_alloc_placement* place = listGET_LIST_ITEM_OWNER (node);
+      node = listGET_NEXT (node);
+      if ((name == NULL && place->config) ||
+          (name != NULL && strcmp (place->name, name) == 0))
+      {
+        uxListRemove (&place->node);
+        rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_OBJECT, place);
+      }
+    }
+  }
+
+  rtems_rtl_unlock ();
+}
+
+const rtems_rtl_alloc_placement*
+rtems_rtl_alloc_placement_find (const char* name)
+{
+  rtems_rtl_data*                  rtl = rtems_rtl_lock ();
+  const rtems_rtl_alloc_placement* found = NULL;
+
+  if (rtl != NULL && name != NULL)
+  {
+    ListItem_t* node = listGET_HEAD_ENTRY (&rtl->allocator.placements);
+    while (listGET_END_MARKER (&rtl->allocator.placements) != node)
+    {
+      rtems_rtl_alloc_placement* place = listGET_LIST_ITEM_OWNER (node);
+      if (fnmatch (place->name, name, 0) == 0)
+      {
+        found = place;
+        break;
+      }
+      node = listGET_NEXT (node);
+    }
+  }
+
+  rtems_rtl_unlock ();
+
+  if (found != NULL && rtems_rtl_trace (RTEMS_RTL_TRACE_ALLOCATOR))
+    printf ("rtl: alloc: placement: %s: %s\n", name, found->name);
+
+  return found;
+}
+
+bool
+rtems_rtl_alloc_stats_get (rtems_rtl_alloc_stats* stats)
+{
+  rtems_rtl_data* rtl = rtems_rtl_lock ();
+  HeapStats_t     heap;
+
+  if (rtl == NULL)
+  {
+    rtems_rtl_unlock ();
+    return false;
+  }
+
+  memcpy (stats->tags, rtl->allocator.stats, sizeof (stats->tags));
+
+  rtems_rtl_unlock ();
+
+  vRTLGetHeapStats (&heap);
+
+  stats->heap_size = configTOTAL_RTL_HEAP_SIZE;
+  stats->free = heap.xAvailableHeapSpaceInBytes;
+  stats->min_free = heap.xMinimumEverFreeBytesRemaining;
+  stats->largest_free = heap.xSizeOfLargestFreeBlockInBytes;
+  stats->free_blocks = heap.xNumberOfFreeBlocks;
+
+  /*
+   * The fragmentation is the free memory that cannot be allocated in a
+   * single allocation. It is 0 if all the free memory is in one block.
+   */
+  stats->fragmentation = 0;
+  if (stats->free > 0 && stats->largest_free < stats->free)
+    stats->fragmentation =
+      (uint32_t) ((((uint64_t) (stats->free - stats->largest_free)) * 100) / stats->free);
+
+  return true;
 }
 
 void
@@ -232,8 +722,470 @@ rtems_rtl_alloc_indirect_del (rtems_rtl_alloc_tag tag,
   if (rtl && !rtems_rtl_ptr_null (handle))
   {
     uxListRemove (&handle->node);
-    rtems_rtl_alloc_del (tag, &handle->pointer);
+    rtems_rtl_alloc_del (tag, handle->pointer);
+    handle->pointer = NULL;
+  }
+
+  rtems_rtl_unlock ();
+}
+
+void
+rtems_rtl_alloc_movable_init (rtems_rtl_alloc_movable* movable)
+{
+  rtems_rtl_sptr_init (&movable->handle);
+  movable->tag = RTEMS_RTL_ALLOC_OBJECT;
+  movable->mover = NULL;
+  movable->arg = NULL;
+}
+
+void
+rtems_rtl_alloc_movable_add (rtems_rtl_alloc_movable* movable,
+                             rtems_rtl_alloc_tag      tag,
+                             void*                    address,
+                             size_t                   size,
+                             rtems_rtl_alloc_mover    mover,
+                             void*                    arg)
+{
+  rtems_rtl_data* rtl = rtems_rtl_lock ();
+
+  if (rtems_rtl_trace (RTEMS_RTL_TRACE_ALLOCATOR))
+    printf ("rtl: alloc: movable: add: %s addr=%p size=%zu\n",
+            rtems_rtl_trace_tag_label (tag), address, size);
+
+  if (rtl != NULL && address != NULL)
+  {
+    rtems_rtl_sptr_set (&movable->handle, address);
+    rtems_rtl_sptr_set_size (&movable->handle, size);
+    movable->tag = tag;
+    movable->mover = mover;
+    movable->arg = arg;
+    listSET_LIST_ITEM_OWNER (&movable->handle.ptr.node, movable);
+    vListInsertEnd (&rtl->allocator.movables, &movable->handle.ptr.node);
+  }
+
+  rtems_rtl_unlock ();
+}
+
+void
+rtems_rtl_alloc_movable_remove (rtems_rtl_alloc_movable* movable)
+{
+  rtems_rtl_lock ();
+  if (listLIST_ITEM_CONTAINER (&movable->handle.ptr.node) != NULL)
+    uxListRemove (&movable->handle.ptr.node);
+  rtems_rtl_sptr_init (&movable->handle);
+  rtems_rtl_unlock ();
+}
+
+/**
+ * Move a movable allocation if a copy of it can be allocated at a lower
+ * address.
+ */
+static bool
+rtems_rtl_alloc_movable_move (rtems_rtl_alloc_movable* movable)
+{
+  void*  old = rtems_rtl_sptr_get (&movable->handle);
+  size_t size = rtems_rtl_sptr_get_size (&movable->handle);
+  void*  address;
+
+  address = rtems_rtl_alloc_new (movable->tag, size, false);
+  if (address == NULL)
+    return false;
+
+  if ((uintptr_t) address > (uintptr_t) old)
+  {
+    rtems_rtl_alloc_del (movable->tag, address);
+    return false;
+  }
+
+  if (rtems_rtl_trace (RTEMS_RTL_TRACE_ALLOCATOR))
+    printf ("rtl: alloc: movable: move: %s %p -> %p size=%zu\n",
+            rtems_rtl_trace_tag_label (movable->tag), old, address, size);
+
+  memcpy (address, old, size);
+  rtems_rtl_sptr_set (&movable->handle, address);
+  if (movable->mover != NULL)
+    movable->mover (movable, old);
+  rtems_rtl_alloc_del (movable->tag, old);
+
+  return true;
+}
+
+bool
+rtems_rtl_alloc_compact (void)
+{
+  rtems_rtl_data* rtl = rtems_rtl_lock ();
+  uintptr_t       last = 0;
+  bool            moved = false;
+
+  if (rtl == NULL)
+  {
+    rtems_rtl_unlock ();
+    return false;
+  }
+
+  if (rtems_rtl_trace (RTEMS_RTL_TRACE_ALLOCATOR))
+    printf ("rtl: alloc: compact: movables=%u free=%zu\n",
+            (unsigned int) listCURRENT_LIST_LENGTH (&rtl->allocator.movables),
+            xRTLtGetFreeHeapSize ());
+
+  /*
+   * A reader may be searching a symbol table being moved.
+   */
+  rtems_rtl_write_lock ();
+
+  /*
+   * Move the allocations lowest address first. Moving an allocation down
+   * frees the space above it for the allocations after it. The list is
+   * searched for the next address so the order of the list does not matter.
+   */
+  while (true)
+  {
+    rtems_rtl_alloc_movable* next = NULL;
+    ListItem_t*              node;
+
+    node = listGET_HEAD_ENTRY (&rtl->allocator.movables);
+    while (listGET_END_MARKER (&rtl->allocator.movables) != node)
+    {
+      rtems_rtl_alloc_movable* movable = listGET_LIST_ITEM_OWNER (node);
+      uintptr_t                address;
+      address = (uintptr_t) rtems_rtl_sptr_get (&movable->handle);
+      if (address > last &&
+          (next == NULL ||
+           address < (uintptr_t) rtems_rtl_sptr_get (&next->handle)))
+        next = movable;
+      node = listGET_NEXT (node);
+    }
+
+    if (next == NULL)
+      break;
+
+    last = (uintptr_t) rtems_rtl_sptr_get (&next->handle);
+
+    if (rtems_rtl_alloc_movable_move (next))
+      moved = true;
+  }
+
+  if (rtems_rtl_trace (RTEMS_RTL_TRACE_ALLOCATOR))
+    printf ("rtl: alloc: compact: moved=%s free=%zu\n",
+            moved ? "yes" : "no", xRTLtGetFreeHeapSize ());
+
+  rtems_rtl_write_unlock ();
+
+  rtems_rtl_unlock ();
+
+  return moved;
+}
+
+/**
+ * The alignment of arena memory. It is a capability on CHERI.
+ */
+#define RTEMS_RTL_ARENA_ALIGN \
+  (sizeof (void*) > sizeof (uint64_t) ? sizeof (void*) : sizeof (uint64_t))
+
+#define rtems_rtl_arena_round(_s) \
+  (((_s) + (RTEMS_RTL_ARENA_ALIGN - 1)) & ~(RTEMS_RTL_ARENA_ALIGN - 1))
+
+#define rtems_rtl_arena_chunk_base(_c) \
+  (((char*) (_c)) + rtems_rtl_arena_round (sizeof (rtems_rtl_arena_chunk)))
+
+void
+rtems_rtl_arena_init (rtems_rtl_arena*    arena,
+                      rtems_rtl_alloc_tag tag,
+                      size_t              chunk_size)
+{
+  arena->tag = tag;
+  arena->chunk_size =
+    rtems_rtl_arena_round (chunk_size == 0 ? RTEMS_RTL_ARENA_CHUNK_SIZE : chunk_size);
+  arena->chunks = NULL;
+  arena->allocs = 0;
+  arena->bytes = 0;
+}
+
+void*
+rtems_rtl_arena_alloc (rtems_rtl_arena* arena, size_t size, bool zero)
+{
+  rtems_rtl_arena_chunk* chunk = arena->chunks;
+  void*                  address;
+
+  size = rtems_rtl_arena_round (size == 0 ? 1 : size);
+
+  if (chunk == NULL || (chunk->size - chunk->used) < size)
+  {
+    size_t chunk_size = arena->chunk_size;
+
+    if (size > (arena->chunk_size / 2))
+      chunk_size = size;
+
+    /*
+     * The chunk is recorded as backing memory. The allocations made in it
+     * are recorded as they are made.
+     */
+    rtems_rtl_lock ();
+    rtems_rtl_alloc_record_backing (true);
+    chunk = rtems_rtl_alloc_new (arena->tag,
+                                 rtems_rtl_arena_round (sizeof (rtems_rtl_arena_chunk)) +
+                                 chunk_size,
+                                 false);
+    rtems_rtl_alloc_record_backing (false);
+    rtems_rtl_unlock ();
+    if (chunk == NULL)
+      return NULL;
+
+    chunk->size = chunk_size;
+    chunk->used = 0;
+
+    /*
+     * A chunk for a single large allocation is placed after the current
+     * chunk so the space left in the current chunk can still be used.
+     */
+    if (chunk_size == size && arena->chunks != NULL)
+    {
+      chunk->next = arena->chunks->next;
+      arena->chunks->next = chunk;
+    }
+    else
+    {
+      chunk->next = arena->chunks;
+      arena->chunks = chunk;
+    }
+  }
+
+  address = rtems_rtl_arena_chunk_base (chunk) + chunk->used;
+  chunk->used += size;
+
+  ++arena->allocs;
+  arena->bytes += size;
+
+  rtems_rtl_alloc_record_note (RTEMS_RTL_ALLOC_NEW, arena->tag,
+                               RTEMS_RTL_ALLOC_RECORD_ARENA,
+                               address, size, arena);
+
+  if (rtems_rtl_trace (RTEMS_RTL_TRACE_ALLOCATOR))
+    printf ("rtl: alloc: arena: %s addr=%p size=%zu\n",
+            rtems_rtl_trace_tag_label (arena->tag), address, size);
+
+  if (zero)
+    memset (address, 0, size);
+
+  return address;
+}
+
+char*
+rtems_rtl_arena_strdup (rtems_rtl_arena* arena, const char* s)
+{
+  size_t len = strlen (s) + 1;
+  char*  d = rtems_rtl_arena_alloc (arena, len, false);
+  if (d != NULL)
+    memcpy (d, s, len);
+  return d;
+}
+
+void
+rtems_rtl_arena_release (rtems_rtl_arena* arena)
+{
+  rtems_rtl_arena_chunk* chunk = arena->chunks;
+
+  if (rtems_rtl_trace (RTEMS_RTL_TRACE_ALLOCATOR))
+    printf ("rtl: alloc: arena: release: %s allocs=%zu bytes=%zu\n",
+            rtems_rtl_trace_tag_label (arena->tag), arena->allocs, arena->bytes);
+
+  if (chunk == NULL)
+    return;
+
+  /*
+   * The arena's allocations are released with a single record.
+   */
+  rtems_rtl_alloc_record_note (RTEMS_RTL_ALLOC_DEL, arena->tag,
+                               RTEMS_RTL_ALLOC_RECORD_ARENA,
+                               NULL, 0, arena);
+
+  rtems_rtl_lock ();
+  rtems_rtl_alloc_record_backing (true);
+  while (chunk != NULL)
+  {
+    rtems_rtl_arena_chunk* next = chunk->next;
+    rtems_rtl_alloc_del (arena->tag, chunk);
+    chunk = next;
+  }
+  rtems_rtl_alloc_record_backing (false);
+  rtems_rtl_unlock ();
+
+  arena->chunks = NULL;
+  arena->allocs = 0;
+  arena->bytes = 0;
+}
+
+#define rtems_rtl_slab_base(_s) \
+  (((char*) (_s)) + rtems_rtl_arena_round (sizeof (rtems_rtl_slab)))
+
+#define rtems_rtl_slab_full_map(_c) \
+  ((_c)->objects == 32 ? 0xffffffffUL : ((1UL << (_c)->objects) - 1))
+
+/*
+ * Module memory has permissions set on it so it is not held in slabs.
+ */
+static bool
+rtems_rtl_alloc_slab_tag (rtems_rtl_alloc_tag tag)
+{
+  return tag == RTEMS_RTL_ALLOC_OBJECT ||
+    tag == RTEMS_RTL_ALLOC_SYMBOL ||
+    tag == RTEMS_RTL_ALLOC_EXTERNAL;
+}
+
+static rtems_rtl_slab_cache*
+rtems_rtl_alloc_slab_cache (rtems_rtl_data*     rtl,
+                            rtems_rtl_alloc_tag tag,
+                            size_t              size)
+{
+  int sc = 0;
+  if (!rtems_rtl_alloc_slab_tag (tag) || size > RTEMS_RTL_SLAB_MAX_SIZE)
+    return NULL;
+  while ((RTEMS_RTL_SLAB_MIN_SIZE << sc) < size)
+    ++sc;
+  return &rtl->allocator.slabs[tag][sc];
+}
+
+void*
+rtems_rtl_alloc_slab_new (rtems_rtl_alloc_tag tag, size_t size, bool zero)
+{
+  rtems_rtl_data*       rtl = rtems_rtl_lock ();
+  rtems_rtl_slab_cache* cache;
+  rtems_rtl_slab*       slab;
+  void*                 address = NULL;
+  int                   obj;
+
+  if (rtl == NULL)
+  {
+    rtems_rtl_unlock ();
+    return NULL;
+  }
+
+  cache = rtems_rtl_alloc_slab_cache (rtl, tag, size);
+  if (cache == NULL)
+  {
+    rtems_rtl_unlock ();
+    return rtems_rtl_alloc_new (tag, size, zero);
+  }
+
+  slab = cache->current;
+
+  if (slab == NULL)
+  {
+    slab = cache->slabs;
+    while (slab != NULL && slab->free == 0)
+      slab = slab->next;
+  }
+
+  if (slab == NULL)
+  {
+    rtems_rtl_alloc_record_backing (true);
+    slab = rtems_rtl_alloc_new (tag,
+                                rtems_rtl_arena_round (sizeof (rtems_rtl_slab)) +
+                                (cache->objects * cache->size),
+                                false);
+    rtems_rtl_alloc_record_backing (false);
+    if (slab == NULL)
+    {
+      rtems_rtl_unlock ();
+      return NULL;
+    }
+    slab->free = rtems_rtl_slab_full_map (cache);
+    slab->next = cache->slabs;
+    cache->slabs = slab;
+    ++cache->count;
+  }
+
+  obj = __builtin_ctz (slab->free);
+  slab->free &= ~(1UL << obj);
+  cache->current = slab->free != 0 ? slab : NULL;
+  ++cache->allocs;
+
+  address = rtems_rtl_slab_base (slab) + (obj * cache->size);
+
+  rtems_rtl_alloc_record_note (RTEMS_RTL_ALLOC_NEW, tag,
+                               RTEMS_RTL_ALLOC_RECORD_SLAB,
+                               address, size, NULL);
+
+  rtems_rtl_unlock ();
+
+  if (rtems_rtl_trace (RTEMS_RTL_TRACE_ALLOCATOR))
+    printf ("rtl: alloc: slab: new: %s addr=%p size=%zu\n",
+            rtems_rtl_trace_tag_label (tag), address, size);
+
+  if (zero)
+    memset (address, 0, size);
+
+  return address;
+}
+
+void
+rtems_rtl_alloc_slab_del (rtems_rtl_alloc_tag tag,
+                          size_t              size,
+                          void*               address)
+{
+  rtems_rtl_data*       rtl;
+  rtems_rtl_slab_cache* cache;
+  rtems_rtl_slab**      link;
+
+  if (address == NULL)
+    return;
+
+  rtl = rtems_rtl_lock ();
+
+  cache = rtl == NULL ? NULL : rtems_rtl_alloc_slab_cache (rtl, tag, size);
+  if (cache == NULL)
+  {
+    rtems_rtl_unlock ();
+    rtems_rtl_alloc_del (tag, address);
+    return;
   }
+
+  if (rtems_rtl_trace (RTEMS_RTL_TRACE_ALLOCATOR))
+    printf ("rtl: alloc: slab: del: %s addr=%p\n",
+            rtems_rtl_trace_tag_label (tag), address);
+
+  /*
+   * New slabs are added to the head of the list so the objects allocated
+   * most recently are found first.
+   */
+  link = &cache->slabs;
+  while (*link != NULL)
+  {
+    rtems_rtl_slab* slab = *link;
+    char*           base = rtems_rtl_slab_base (slab);
+    if ((char*) address >= base &&
+        (char*) address < (base + (cache->objects * cache->size)))
+    {
+      size_t obj = ((char*) address - base) / cache->size;
+      rtems_rtl_alloc_record_note (RTEMS_RTL_ALLOC_DEL, tag,
+                                   RTEMS_RTL_ALLOC_RECORD_SLAB,
+                                   address, 0, NULL);
+      slab->free |= 1UL << obj;
+      --cache->allocs;
+      /*
+       * Leave a single slab allocated so a cache that is used often does
+       * not allocate and free a slab each time.
+       */
+      if (slab->free == rtems_rtl_slab_full_map (cache) && cache->count > 1)
+      {
+        *link = slab->next;
+        --cache->count;
+        if (cache->current == slab)
+          cache->current = NULL;
+        rtems_rtl_alloc_record_backing (true);
+        rtems_rtl_alloc_del (tag, slab);
+        rtems_rtl_alloc_record_backing (false);
+      }
+      else
+      {
+        cache->current = slab;
+      }
+      break;
+    }
+    link = &slab->next;
+  }
+
+  rtems_rtl_unlock ();
 }
 
 rtems_rtl_alloc_tag
@@ -267,18 +1219,135 @@ rtems_rtl_alloc_bss_tag (void)
 }
 
 bool
-rtems_rtl_alloc_module_new (void** text_base, size_t text_size,
-                            void** const_base, size_t const_size,
-                            void** eh_base, size_t eh_size,
-                            void** data_base, size_t data_size,
-                            void** bss_base, size_t bss_size)
+rtems_rtl_alloc_module_image_set (bool image)
+{
+  rtems_rtl_data* rtl = rtems_rtl_lock ();
+  bool            previous = false;
+  if (rtl != NULL)
+  {
+    previous = rtl->allocator.module_image;
+    rtl->allocator.module_image = image;
+  }
+  rtems_rtl_unlock ();
+  return previous;
+}
+
+bool
+rtems_rtl_alloc_module_image (void)
+{
+  rtems_rtl_data* rtl = rtems_rtl_lock ();
+  bool            image = false;
+  if (rtl != NULL)
+    image = rtl->allocator.module_image;
+  rtems_rtl_unlock ();
+  return image;
+}
+
+#define rtems_rtl_alloc_module_round(_s) \
+  (((_s) + (RTEMS_RTL_ALLOC_MODULE_ALIGN - 1)) & ~(RTEMS_RTL_ALLOC_MODULE_ALIGN - 1))
+
+/**
+ * Set the base of a part of a module image and the part's permissions.
+ */
+static void
+rtems_rtl_alloc_module_part (rtems_rtl_alloc_tag tag,
+                             uint8_t*            image,
+                             size_t*             offset,
+                             void**              base,
+                             size_t              size)
+{
+  if (size)
+  {
+    *base = image + *offset;
+    *offset += rtems_rtl_alloc_module_round (size);
+    rtems_rtl_alloc_set_perms (tag, *base);
+  }
+}
+
+/*
+ * Allocate a module part in the region the placement puts it in. With no
+ * placement or region the part is allocated by tag.
+ */
+static void*
+rtems_rtl_alloc_module_part_new (const rtems_rtl_alloc_placement* placement,
+                                 enum rtems_rtl_alloc_parts       part,
+                                 rtems_rtl_alloc_tag              tag,
+                                 size_t                           size)
+{
+  const char* region = placement == NULL ? NULL : placement->regions[part];
+  return rtems_rtl_alloc_region_new (region, tag, size, false);
+}
+
+static bool
+rtems_rtl_alloc_module_image_new (void** text_base, size_t text_size,
+                                  void** const_base, size_t const_size,
+                                  void** eh_base, size_t eh_size,
+                                  void** data_base, size_t data_size,
+                                  void** bss_base, size_t bss_size,
+                                  const rtems_rtl_alloc_placement* placement)
+{
+  uint8_t* image;
+  size_t   size;
+  size_t   offset = 0;
+
+  size = rtems_rtl_alloc_module_round (text_size) +
+    rtems_rtl_alloc_module_round (const_size) +
+    rtems_rtl_alloc_module_round (eh_size) +
+    rtems_rtl_alloc_module_round (data_size) +
+    rtems_rtl_alloc_module_round (bss_size);
+
+  if (size == 0)
+    return true;
+
+  image = rtems_rtl_alloc_module_part_new (placement,
+                                           RTEMS_RTL_ALLOC_PART_TEXT,
+                                           rtems_rtl_alloc_text_tag (),
+                                           size);
+  if (image == NULL)
+    return false;
+
+  if (rtems_rtl_trace (RTEMS_RTL_TRACE_ALLOCATOR))
+    printf ("rtl: alloc: module image: addr=%p size=%zu\n", image, size);
+
+  rtems_rtl_alloc_module_part (rtems_rtl_alloc_text_tag (),
+                               image, &offset, text_base, text_size);
+  rtems_rtl_alloc_module_part (rtems_rtl_alloc_const_tag (),
+                               image, &offset, const_base, const_size);
+  rtems_rtl_alloc_module_part (rtems_rtl_alloc_eh_tag (),
+                               image, &offset, eh_base, eh_size);
+  rtems_rtl_alloc_module_part (rtems_rtl_alloc_data_tag (),
+                               image, &offset, data_base, data_size);
+  rtems_rtl_alloc_module_part (rtems_rtl_alloc_bss_tag (),
+                               image, &offset, bss_base, bss_size);
+
+  return true;
+}
+
+static bool
+rtems_rtl_alloc_module_alloc (void** text_base, size_t text_size,
+                              void** const_base, size_t const_size,
+                              void** eh_base, size_t eh_size,
+                              void** data_base, size_t data_size,
+                              void** bss_base, size_t bss_size,
+                              bool   image,
+                              const rtems_rtl_alloc_placement* placement)
 {
-  *text_base = *const_base = *data_base = *bss_base = NULL;
+  *text_base = *const_base = *eh_base = *data_base = *bss_base = NULL;
+
+  if (image)
+    return rtems_rtl_alloc_module_image_new (text_base, text_size,
+                                             const_base, const_size,
+                                             eh_base, eh_size,
+                                             data_base, data_size,
+                                             bss_base, bss_size,
+                                             placement);
 
   if (text_size)
   {
-    *text_base = rtems_rtl_alloc_new (rtems_rtl_alloc_text_tag (),
-                                      text_size, false);
+    *text_base = rtems_rtl_alloc_module_part_new (placement,
+                                                  RTEMS_RTL_ALLOC_PART_TEXT,
+                                                  rtems_rtl_alloc_text_tag (),
+                                                  text_size);
     if (!*text_base)
     {
       return false;
@@ -287,48 +1356,56 @@ rtems_rtl_alloc_module_new (void** text_base, size_t text_size,
 
   if (const_size)
   {
-    *const_base = rtems_rtl_alloc_new (rtems_rtl_alloc_const_tag (),
-                                       const_size, false);
+    *const_base = rtems_rtl_alloc_module_part_new (placement,
+                                                   RTEMS_RTL_ALLOC_PART_CONST,
+                                                   rtems_rtl_alloc_const_tag (),
+                                                   const_size);
     if (!*const_base)
     {
       rtems_rtl_alloc_module_del (text_base, const_base, eh_base,
-                                  data_base, bss_base);
+                                  data_base, bss_base, false);
       return false;
     }
   }
 
   if (eh_size)
   {
-    *eh_base = rtems_rtl_alloc_new (rtems_rtl_alloc_eh_tag (),
-                                    eh_size, false);
+    *eh_base = rtems_rtl_alloc_module_part_new (placement,
+                                                RTEMS_RTL_ALLOC_PART_EH,
+                                                rtems_rtl_alloc_eh_tag (),
+                                                eh_size);
     if (!*eh_base)
     {
       rtems_rtl_alloc_module_del (text_base, const_base, eh_base,
-                                  data_base, bss_base);
+                                  data_base, bss_base, false);
       return false;
     }
   }
 
   if (data_size)
   {
-    *data_base = rtems_rtl_alloc_new (rtems_rtl_alloc_data_tag (),
-                                      data_size, false);
+    *data_base = rtems_rtl_alloc_module_part_new (placement,
+                                                  RTEMS_RTL_ALLOC_PART_DATA,
+                                                  rtems_rtl_alloc_data_tag (),
+                                                  data_size);
     if (!*data_base)
     {
       rtems_rtl_alloc_module_del (text_base, const_base, eh_base,
-                                  data_base, bss_base);
+                                  data_base, bss_base, false);
       return false;
     }
   }
 
   if (bss_size)
   {
-    *bss_base = rtems_rtl_alloc_new (rtems_rtl_alloc_bss_tag (),
-                                     bss_size, false);
+    *bss_base = rtems_rtl_alloc_module_part_new (placement,
+                                                 RTEMS_RTL_ALLOC_PART_BSS,
+                                                 rtems_rtl_alloc_bss_tag (),
+                                                 bss_size);
     if (!*bss_base)
     {
       rtems_rtl_alloc_module_del (text_base, const_base, eh_base,
-                                  data_base, bss_base);
+                                  data_base, bss_base, false);
       return false;
     }
   }
@@ -336,17 +1413,70 @@ rtems_rtl_alloc_module_new (void** text_base, size_t text_size,
   return true;
 }
 
+bool
+rtems_rtl_alloc_module_new (void** text_base, size_t text_size,
+                            void** const_base, size_t const_size,
+                            void** eh_base, size_t eh_size,
+                            void** data_base, size_t data_size,
+                            void** bss_base, size_t bss_size,
+                            bool   image,
+                            const rtems_rtl_alloc_placement* placement)
+{
+  if (rtems_rtl_alloc_module_alloc (text_base, text_size,
+                                    const_base, const_size,
+                                    eh_base, eh_size,
+                                    data_base, data_size,
+                                    bss_base, bss_size,
+                                    image, placement))
+    return true;
+
+  /*
+   * A module is the largest allocation the loader makes. If it fails the
+   * free memory may be in pieces too small for it so compact the heap and
+   * try again.
+   */
+  if (!rtems_rtl_alloc_compact ())
+    return false;
+
+  return rtems_rtl_alloc_module_alloc (text_base, text_size,
+                                       const_base, const_size,
+                                       eh_base, eh_size,
+                                       data_base, data_size,
+                                       bss_base, bss_size,
+                                       image, placement);
+}
+
 void
 rtems_rtl_alloc_module_del (void** text_base,
                             void** const_base,
                             void** eh_base,
                             void** data_base,
-                            void** bss_base)
+                            void** bss_base,
+                            bool   image)
 {
-  rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_READ_WRITE, *bss_base);
-  rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_READ_WRITE, *data_base);
-  rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_READ, *eh_base);
-  rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_READ, *const_base);
-  rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_READ_EXEC, *text_base);
+  if (image)
+  {
+    /*
+     * The image is at the base of the first part present.
+     */
+    void* base = *text_base;
+    if (base == NULL)
+      base = *const_base;
+    if (base == NULL)
+      base = *eh_base;
+    if (base == NULL)
+      base = *data_base;
+    if (base == NULL)
+      base = *bss_base;
+    rtems_rtl_alloc_del (rtems_rtl_alloc_text_tag (), base);
+  }
+  else
+  {
+    rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_READ_WRITE, *bss_base);
+    rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_READ_WRITE, *data_base);
+    rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_READ, *eh_base);
+    rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_READ, *const_base);
+    rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_READ_EXEC, *text_base);
+  }
   *text_base = *const_base = *eh_base = *data_base = *bss_base = NULL;
 }
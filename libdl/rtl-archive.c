@@ -231,6 +231,82 @@ rtems_rtl_archive_symbol_compare (const void* a, const void* b)
   return strcmp (sa->label, sb->label);
 }
 
+static void
+rtems_rtl_archive_symbols_erase (rtems_rtl_archive_symbols* symbols)
+{
+  rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_SYMBOL, symbols->hash);
+  rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_SYMBOL, symbols->symbols);
+  rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_SYMBOL, symbols->base);
+  memset (symbols, 0, sizeof (*symbols));
+}
+
+/**
+ * Create the symbol hash from the sorted symbol table. The table is sized to
+ * be at most half full so a probe for a symbol not in the archive ends
+ * quickly. If a symbol is in the archive more than once the lowest entry wins,
+ * the same result as a linear search of the ranlib table.
+ */
+static void
+rtems_rtl_archive_hash_create (rtems_rtl_archive_symbols* symbols)
+{
+  size_t hash_size = 2;
+  size_t mask;
+  size_t s;
+
+  if (symbols->symbols == NULL || symbols->entries == 0 ||
+      symbols->entries >= UINT32_MAX)
+    return;
+
+  while (hash_size < (symbols->entries * 2))
+    hash_size <<= 1;
+
+  symbols->hash = rtems_rtl_alloc_new (RTEMS_RTL_ALLOC_SYMBOL,
+                                       hash_size * sizeof (symbols->hash[0]),
+                                       true);
+  if (symbols->hash == NULL)
+  {
+    if (rtems_rtl_trace (RTEMS_RTL_TRACE_ARCHIVES))
+      printf ("rtl: archive: hash: no memory: slots=%zu\n", hash_size);
+    return;
+  }
+
+  symbols->hash_size = hash_size;
+  mask = hash_size - 1;
+
+  for (s = 0; s < symbols->entries; ++s)
+  {
+    const rtems_rtl_archive_symbol* symbol = &symbols->symbols[s];
+    uint32_t                        hash;
+    size_t                          slot;
+
+    hash = rtems_rtl_symbol_hash (symbol->label);
+    slot = hash & mask;
+
+    while (symbols->hash[slot].symbol != 0)
+    {
+      rtems_rtl_archive_hash_slot* hslot = &symbols->hash[slot];
+      if (hslot->hash == hash)
+      {
+        const rtems_rtl_archive_symbol* match;
+        match = &symbols->symbols[hslot->symbol - 1];
+        if (strcmp (match->label, symbol->label) == 0)
+          break;
+      }
+      slot = (slot + 1) & mask;
+    }
+
+    if (symbols->hash[slot].symbol != 0)
+    {
+      rtems_rtl_archive_hash_slot* hslot = &symbols->hash[slot];
+      if (symbols->symbols[hslot->symbol - 1].entry < symbol->entry)
+        continue;
+    }
+
+    symbols->hash[slot].hash = hash;
+    symbols->hash[slot].symbol = s + 1;
+  }
+}
+
 bool
 rtems_rtl_archive_obj_finder (rtems_rtl_archive* archive, void* data)
 {
@@ -245,11 +321,38 @@ rtems_rtl_archive_obj_finder (rtems_rtl_archive* archive, void* data)
    */
   if (symbols->base != NULL)
   {
+    rtems_rtl_archive_obj_data* search = (rtems_rtl_archive_obj_data*) data;
+    /*
+     * Probe the hash if there is one. An empty slot ends the probe and the
+     * symbol is not in this archive.
+     */
+    if (symbols->hash != NULL)
+    {
+      const size_t mask = symbols->hash_size - 1;
+      uint32_t     hash = rtems_rtl_symbol_hash (search->symbol);
+      size_t       slot = hash & mask;
+      while (symbols->hash[slot].symbol != 0)
+      {
+        const rtems_rtl_archive_hash_slot* hslot = &symbols->hash[slot];
+        if (hslot->hash == hash)
+        {
+          const rtems_rtl_archive_symbol* match;
+          match = &symbols->symbols[hslot->symbol - 1];
+          if (strcmp (search->symbol, match->label) == 0)
+          {
+            search->archive = archive;
+            search->offset =
+              rtems_rtl_archive_read_32 (symbols->base + (match->entry * 4));
+            return false;
+          }
+        }
+        slot = (slot + 1) & mask;
+      }
+    }
     /*
      * Perform a linear search if there is no sorted symbol table.
      */
-    rtems_rtl_archive_obj_data* search = (rtems_rtl_archive_obj_data*) data;
-    if (symbols->symbols == NULL)
+    else if (symbols->symbols == NULL)
     {
       const char* symbol = symbols->names;
       size_t      entry;
@@ -293,6 +396,525 @@ rtems_rtl_archive_obj_finder (rtems_rtl_archive* archive, void* data)
   return true;
 }
 
+/**
+ * Add the archive's symbols to the directory's slots. The caller makes sure
+ * there is room.
+ */
+static void
+rtems_rtl_archive_dir_insert (rtems_rtl_archive_dir* dir,
+                              rtems_rtl_archive*     archive)
+{
+  const rtems_rtl_archive_symbols* symbols = &archive->symbols;
+  const size_t                     mask = dir->size - 1;
+  size_t                           s;
+
+  for (s = 0; s < symbols->entries; ++s)
+  {
+    uint32_t hash = rtems_rtl_symbol_hash (symbols->symbols[s].label);
+    size_t   slot = hash & mask;
+    while (dir->slots[slot].symbol != 0)
+      slot = (slot + 1) & mask;
+    dir->slots[slot].archive = archive;
+    dir->slots[slot].hash = hash;
+    dir->slots[slot].symbol = s + 1;
+  }
+
+  dir->used += symbols->entries;
+}
+
+/**
+ * Rebuild the directory from the archives flagged as being in the directory.
+ * Removed slots are dropped. If an archive has no sorted symbol table or
+ * there is no memory the directory is not valid and searches iterate over the
+ * archives.
+ */
+static void
+rtems_rtl_archive_dir_rebuild (rtems_rtl_archives* archives)
+{
+  rtems_rtl_archive_dir* dir = &archives->directory;
+  ListItem_t*            node;
+  size_t                 entries = 0;
+  size_t                 size = 2;
+
+  rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_SYMBOL, dir->slots);
+  dir->slots = NULL;
+  dir->size = 0;
+  dir->used = 0;
+  dir->valid = false;
+
+  node = listGET_HEAD_ENTRY (&archives->archives);
+  while (listGET_END_MARKER (&archives->archives) != node)
+  {
+    rtems_rtl_archive* archive = (rtems_rtl_archive*) node;
+    if ((archive->flags & RTEMS_RTL_ARCHIVE_DIRECTORY) != 0)
+    {
+      if (archive->symbols.symbols == NULL)
+      {
+        if (rtems_rtl_trace (RTEMS_RTL_TRACE_ARCHIVES))
+          printf ("rtl: archive: directory: no sorted symbols: %s\n",
+                  archive->name);
+        return;
+      }
+      entries += archive->symbols.entries;
+    }
+    node = listGET_NEXT (node);
+  }
+
+  if (entries == 0)
+  {
+    dir->valid = true;
+    return;
+  }
+
+  while (size < (entries * 2))
+    size <<= 1;
+
+  dir->slots = rtems_rtl_alloc_new (RTEMS_RTL_ALLOC_SYMBOL,
+                                    size * sizeof (rtems_rtl_archive_dir_slot),
+                                    true);
+  if (dir->slots == NULL)
+  {
+    if (rtems_rtl_trace (RTEMS_RTL_TRACE_ARCHIVES))
+      printf ("rtl: archive: directory: no memory: slots=%zu\n", size);
+    return;
+  }
+
+  dir->size = size;
+
+  node = listGET_HEAD_ENTRY (&archives->archives);
+  while (listGET_END_MARKER (&archives->archives) != node)
+  {
+    rtems_rtl_archive* archive = (rtems_rtl_archive*) node;
+    if ((archive->flags & RTEMS_RTL_ARCHIVE_DIRECTORY) != 0)
+      rtems_rtl_archive_dir_insert (dir, archive);
+    node = listGET_NEXT (node);
+  }
+
+  dir->valid = true;
+
+  if (rtems_rtl_trace (RTEMS_RTL_TRACE_ARCHIVES))
+    printf ("rtl: archive: directory: rebuild: entries=%zu slots=%zu\n",
+            entries, size);
+}
+
+/**
+ * Add a loaded archive's symbols to the directory. The directory is rebuilt
+ * if it is more than half full.
+ */
+static void
+rtems_rtl_archive_dir_add (rtems_rtl_archives* archives,
+                           rtems_rtl_archive*  archive)
+{
+  rtems_rtl_archive_dir* dir = &archives->directory;
+
+  if (archive->symbols.base == NULL)
+    return;
+
+  archive->flags |= RTEMS_RTL_ARCHIVE_DIRECTORY;
+
+  if (!dir->valid ||
+      archive->symbols.symbols == NULL ||
+      ((dir->used + archive->symbols.entries) * 2) > dir->size)
+    rtems_rtl_archive_dir_rebuild (archives);
+  else
+    rtems_rtl_archive_dir_insert (dir, archive);
+}
+
+/**
+ * Remove an archive's symbols from the directory. The slots are marked as
+ * removed so probes for other symbols continue past them.
+ */
+static void
+rtems_rtl_archive_dir_remove (rtems_rtl_archives* archives,
+                              rtems_rtl_archive*  archive)
+{
+  rtems_rtl_archive_dir* dir = &archives->directory;
+  size_t                 slot;
+
+  if ((archive->flags & RTEMS_RTL_ARCHIVE_DIRECTORY) == 0)
+    return;
+
+  archive->flags &= ~RTEMS_RTL_ARCHIVE_DIRECTORY;
+
+  if (!dir->valid)
+  {
+    rtems_rtl_archive_dir_rebuild (archives);
+    return;
+  }
+
+  for (slot = 0; slot < dir->size; ++slot)
+  {
+    if (dir->slots[slot].archive == archive)
+      dir->slots[slot].archive = NULL;
+  }
+}
+
+/**
+ * Find the archive and offset of the object file with the symbol. Every slot
+ * in the probe is checked so the archive first in the search order is found.
+ * An archive can define a symbol more than once and the lowest ranlib entry
+ * is found to match the archive's symbol search.
+ */
+static bool
+rtems_rtl_archive_dir_find (const rtems_rtl_archive_dir* dir,
+                            rtems_rtl_archive_obj_data*  search)
+{
+  const rtems_rtl_archive_symbol* match = NULL;
+  size_t                          mask;
+  uint32_t                        hash;
+  size_t                          slot;
+
+  if (dir->size == 0)
+    return false;
+
+  mask = dir->size - 1;
+  hash = rtems_rtl_symbol_hash (search->symbol);
+  slot = hash & mask;
+
+  while (dir->slots[slot].symbol != 0)
+  {
+    const rtems_rtl_archive_dir_slot* dslot = &dir->slots[slot];
+    if (dslot->archive != NULL && dslot->hash == hash &&
+        (search->archive == NULL ||
+         dslot->archive->order < search->archive->order ||
+         (match != NULL && dslot->archive == search->archive)))
+    {
+      const rtems_rtl_archive_symbol* symbol;
+      symbol = &dslot->archive->symbols.symbols[dslot->symbol - 1];
+      if (strcmp (search->symbol, symbol->label) == 0 &&
+          (match == NULL || dslot->archive != search->archive ||
+           symbol->entry < match->entry))
+      {
+        search->archive = dslot->archive;
+        match = symbol;
+      }
+    }
+    slot = (slot + 1) & mask;
+  }
+
+  if (match == NULL)
+    return false;
+
+  search->offset =
+    rtems_rtl_archive_read_32 (search->archive->symbols.base + (match->entry * 4));
+
+  return true;
+}
+
+static void
+rtems_rtl_archive_members_erase (rtems_rtl_archive_members* members)
+{
+  rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_OBJECT, members->members);
+  rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_OBJECT, members->enames);
+  memset (members, 0, sizeof (*members));
+}
+
+/**
+ * Scan the archive's headers. If the members are not allocated count the
+ * members and the space for the short names and read the extended file names
+ * table else fill in the members.
+ */
+static bool
+rtems_rtl_archive_members_scan (rtems_rtl_archive*         archive,
+                                int                        fd,
+                                rtems_rtl_archive_members* members,
+                                size_t*                    names_size)
+{
+  uint8_t     header[RTEMS_RTL_AR_FHDR_SIZE];
+  UBaseType_t off = RTEMS_RTL_AR_FHDR_BASE;
+  char*       names = NULL;
+  size_t      count = 0;
+
+  if (members->members != NULL)
+    names = (char*) &members->members[members->count];
+  else
+    *names_size = 0;
+
+  while ((off + RTEMS_RTL_AR_FHDR_SIZE) <= archive->size)
+  {
+    const char* name = NULL;
+    size_t      size;
+
+    if (!rtems_rtl_seek_read (fd, off, RTEMS_RTL_AR_FHDR_SIZE, &header[0]))
+    {
+      rtems_rtl_archive_set_error (errno, "seek/read archive file header");
+      return false;
+    }
+
+    if ((header[RTEMS_RTL_AR_MAGIC] != 0x60) ||
+        (header[RTEMS_RTL_AR_MAGIC + 1] != 0x0a))
+    {
+      rtems_rtl_archive_set_error (EINVAL, "invalid archive file header");
+      return false;
+    }
+
+    size = rtems_rtl_scan_decimal (&header[RTEMS_RTL_AR_SIZE],
+                                   RTEMS_RTL_AR_SIZE_SIZE);
+
+    if (header[0] == '/')
+    {
+      if (header[1] == '/')
+      {
+        /*
+         * Extended file names table. Read it once and terminate the names.
+         */
+        if (members->enames == NULL)
+        {
+          size_t e;
+          members->enames = rtems_rtl_alloc_new (RTEMS_RTL_ALLOC_OBJECT,
+                                                 size + 1, false);
+          if (members->enames == NULL)
+          {
+            rtems_rtl_archive_set_error (ENOMEM, "extended file names");
+            return false;
+          }
+          if (!rtems_rtl_seek_read (fd, off + RTEMS_RTL_AR_FHDR_SIZE,
+                                    size, (uint8_t*) members->enames))
+          {
+            rtems_rtl_archive_set_error (errno, "reading extended file names");
+            return false;
+          }
+          members->enames_size = size;
+          members->enames[size] = '\0';
+          for (e = 0; e < size; ++e)
+          {
+            if (members->enames[e] == '\n' ||
+                (members->enames[e] == '/' && members->enames[e + 1] == '\n'))
+              members->enames[e] = '\0';
+          }
+        }
+      }
+      else if (isdigit (header[1]))
+      {
+        UBaseType_t extended_off;
+        extended_off = rtems_rtl_scan_decimal (&header[1],
+                                               RTEMS_RTL_AR_FNAME_SIZE - 1);
+        if (members->enames == NULL || extended_off >= members->enames_size)
+        {
+          rtems_rtl_archive_set_error (EINVAL, "invalid extended file name");
+          return false;
+        }
+        name = &members->enames[extended_off];
+      }
+    }
+    else
+    {
+      size_t len = 0;
+      while (len < RTEMS_RTL_AR_FNAME_SIZE &&
+             !rtems_rtl_rchive_name_end (header[RTEMS_RTL_AR_FNAME + len]))
+        ++len;
+      if (names == NULL)
+      {
+        *names_size += len + 1;
+        name = "";
+      }
+      else
+      {
+        memcpy (names, &header[RTEMS_RTL_AR_FNAME], len);
+        names[len] = '\0';
+        name = names;
+        names += len + 1;
+      }
+    }
+
+    if (name != NULL)
+    {
+      if (members->members != NULL)
+      {
+        members->members[count].offset = off;
+        members->members[count].size = size;
+        members->members[count].name = name;
+      }
+      ++count;
+    }
+
+    off += RTEMS_RTL_AR_FHDR_SIZE + ((size + 1) & ~1);
+  }
+
+  members->count = count;
+
+  return true;
+}
+
+/**
+ * Load the archive's member cache. The headers are scanned twice, once to
+ * size the cache and once to fill it.
+ */
+static bool
+rtems_rtl_archive_members_load (rtems_rtl_archive* archive)
+{
+  rtems_rtl_archive_members* members = &archive->members;
+  uint8_t                    ident[RTEMS_RTL_AR_IDENT_SIZE];
+  size_t                     names_size = 0;
+  int                        fd;
+
+  fd = rtems_rtl_archive_fd (archive);
+  if (fd < 0)
+    return false;
+
+  if (!rtems_rtl_seek_read (fd, 0, RTEMS_RTL_AR_IDENT_SIZE, &ident[0]) ||
+      memcmp (ident, RTEMS_RTL_AR_IDENT, RTEMS_RTL_AR_IDENT_SIZE) != 0)
+  {
+    rtems_rtl_archive_set_error (EINVAL, "invalid archive identifer");
+    return false;
+  }
+
+  if (!rtems_rtl_archive_members_scan (archive, fd, members, &names_size))
+  {
+    rtems_rtl_archive_members_erase (members);
+    return false;
+  }
+
+  if (members->count == 0)
+    return false;
+
+  members->members =
+    rtems_rtl_alloc_new (RTEMS_RTL_ALLOC_OBJECT,
+                         (members->count * sizeof (rtems_rtl_archive_member)) +
+                         names_size,
+                         false);
+  if (members->members == NULL)
+  {
+    rtems_rtl_archive_set_error (ENOMEM, "archive members");
+    rtems_rtl_archive_members_erase (members);
+    return false;
+  }
+
+  if (!rtems_rtl_archive_members_scan (archive, fd, members, &names_size))
+  {
+    rtems_rtl_archive_members_erase (members);
+    return false;
+  }
+
+  if (rtems_rtl_trace (RTEMS_RTL_TRACE_ARCHIVES))
+    printf ("rtl: archive: members: %s: count=%zu names=%zu enames=%zu\n",
+            archive->name, members->count, names_size, members->enames_size);
+
+  return true;
+}
+
+static int
+rtems_rtl_archive_member_compare (const void* a, const void* b)
+{
+  const UBaseType_t*              offset;
+  const rtems_rtl_archive_member* member;
+  offset = (const UBaseType_t*) a;
+  member = (const rtems_rtl_archive_member*) b;
+  if (*offset < member->offset)
+    return -1;
+  if (*offset > member->offset)
+    return 1;
+  return 0;
+}
+
+bool
+rtems_rtl_archive_member_locate (rtems_rtl_archive* archive,
+                                 const char**       name,
+                                 UBaseType_t*       offset,
+                                 size_t*            size)
+{
+  rtems_rtl_archive_members*      members = &archive->members;
+  const rtems_rtl_archive_member* member = NULL;
+
+  if (members->members == NULL)
+  {
+    if (!rtems_rtl_archive_members_load (archive))
+      return false;
+  }
+
+  /*
+   * Use the offset if there is one and the name matches. If the offset is not
+   * valid any more search by name.
+   */
+  if (*offset != 0)
+  {
+    member = bsearch (offset,
+                      members->members,
+                      members->count,
+                      sizeof (rtems_rtl_archive_member),
+                      rtems_rtl_archive_member_compare);
+    if (member != NULL && *name != NULL && strcmp (*name, member->name) != 0)
+      member = NULL;
+  }
+
+  if (member == NULL && *name != NULL)
+  {
+    size_t m;
+    for (m = 0; m < members->count; ++m)
+    {
+      if (strcmp (*name, members->members[m].name) == 0)
+      {
+        member = &members->members[m];
+        break;
+      }
+    }
+  }
+
+  if (member == NULL)
+    return false;
+
+  if (*name == NULL)
+  {
+    *name = rtems_rtl_strdup (member->name);
+    if (*name == NULL)
+      return false;
+  }
+
+  *offset = member->offset + RTEMS_RTL_AR_FHDR_SIZE;
+  *size = member->size;
+
+  if (rtems_rtl_trace (RTEMS_RTL_TRACE_ARCHIVES))
+    printf ("rtl: archive: member: %s:%s @ 0x%08lx size=%zu\n",
+            archive->name, *name, (unsigned long) *offset, *size);
+
+  return true;
+}
+
+int
+rtems_rtl_archive_fd (rtems_rtl_archive* archive)
+{
+  if (archive->fd < 0)
+  {
+    archive->fd = open (archive->name, O_RDONLY);
+    if (archive->fd < 0)
+    {
+      if (rtems_rtl_trace (RTEMS_RTL_TRACE_ARCHIVES))
+        printf ("rtl: archive: open error: %s: %s\n",
+                archive->name, strerror (errno));
+    }
+  }
+  return archive->fd;
+}
+
+static void
+rtems_rtl_archive_close (rtems_rtl_archive* archive)
+{
+  if (archive->fd >= 0)
+  {
+    close (archive->fd);
+    archive->fd = -1;
+    /*
+     * The descriptor can be reused so the caches cannot hold its data.
+     */
+    rtems_rtl_obj_caches_flush ();
+  }
+}
+
+static bool
+rtems_rtl_archive_releaser (rtems_rtl_archive* archive, void* data)
+{
+  rtems_rtl_archive_close (archive);
+  return true;
+}
+
+void
+rtems_rtl_archives_release (rtems_rtl_archives* archives)
+{
+  rtems_rtl_archive_iterate_archives (archives,
+                                      rtems_rtl_archive_releaser,
+                                      NULL);
+}
+
 static rtems_rtl_archive*
 rtems_rtl_archive_new (rtems_rtl_archives* archives,
                        const char*         path,
@@ -324,18 +946,21 @@ rtems_rtl_archive_new (rtems_rtl_archives* archives,
       strcat (aname, "/");
     strcat (aname, name);
     vListInitialiseItem (&archive->node);
+    archive->fd = -1;
     archive->flags |= RTEMS_RTL_ARCHIVE_LOAD;
   }
   return archive;
 }
 
 static void
-rtems_rtl_archive_del (rtems_rtl_archive* archive)
+rtems_rtl_archive_del (rtems_rtl_archives* archives, rtems_rtl_archive* archive)
 {
   if (rtems_rtl_trace (RTEMS_RTL_TRACE_ARCHIVES))
     printf ("rtl: archive: del: %s\n",  archive->name);
-  rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_SYMBOL, archive->symbols.base);
-  rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_SYMBOL, archive->symbols.symbols);
+  rtems_rtl_archive_dir_remove (archives, archive);
+  rtems_rtl_archive_close (archive);
+  rtems_rtl_archive_symbols_erase (&archive->symbols);
+  rtems_rtl_archive_members_erase (&archive->members);
 
   if (listLIST_ITEM_CONTAINER (&archive->node))
      uxListRemove (&archive->node);
@@ -366,12 +991,13 @@ rtems_rtl_archive_get (rtems_rtl_archives* archives,
         find_archive = rtems_rtl_archive_find (archives, archive->name);
         if (find_archive == NULL)
         {
+          archive->order = archives->order++;
           vListInitialiseItem (&archive->node);
           vListInsertEnd (&archives->archives, &archive->node);
         }
         else
         {
-          rtems_rtl_archive_del (archive);
+          rtems_rtl_archive_del (archives, archive);
           archive = find_archive;
         }
         archive->flags &= ~RTEMS_RTL_ARCHIVE_REMOVE;
@@ -417,6 +1043,7 @@ rtems_rtl_archives_load_config (rtems_rtl_archives* archives)
     bool    in_comment;
 
     archives->config_mtime = sb.st_mtime;
+    rtems_rtl_alloc_placement_remove (NULL);
     rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_OBJECT, (void*) archives->config);
     archives->config_length = 0;
     archives->config =
@@ -515,6 +1142,42 @@ rtems_rtl_archives_load_config (rtems_rtl_archives* archives)
       }
     }
 
+    /*
+     * A path can be followed by a placement for the archives it matches,
+     * for example "/lib/libhot.a text=itcm data=dtcm". Add the placement
+     * and remove it from the line.
+     */
+    s = (char*) archives->config;
+    r = 0;
+    while (r < archives->config_length)
+    {
+      if (s[r] == '\0')
+      {
+        ++r;
+      }
+      else
+      {
+        size_t ls = strlen (&s[r]);
+        size_t b = 0;
+        while (b < ls && !isspace (s[r + b]))
+          ++b;
+        if (b < ls)
+        {
+          size_t p = b;
+          s[r + b] = '\0';
+          while (isspace (s[r + p]) || s[r + p] == '\0')
+            ++p;
+          if (!rtems_rtl_alloc_placement_add (&s[r], &s[r + p], true))
+          {
+            if (rtems_rtl_trace (RTEMS_RTL_TRACE_ARCHIVES))
+              printf ("rtl: archive: config: invalid placement: %s\n", &s[r]);
+          }
+          memset (&s[r + b], 0, ls - b);
+        }
+        r += ls;
+      }
+    }
+
     if (rtems_rtl_trace (RTEMS_RTL_TRACE_ARCHIVES))
     {
       int line = 1;
@@ -544,6 +1207,9 @@ rtems_rtl_archives_open (rtems_rtl_archives* archives, const char* config)
     printf ("rtl: archive: open: %s\n", config);
   memset (archives, 0, sizeof (rtems_rtl_archives));
   archives->config_name = rtems_rtl_strdup (config);
+  archives->directory.valid = true;
+  archives->refresh_mode = RTEMS_RTL_ARCHIVE_REFRESH_MODE;
+  archives->batch_load = RTEMS_RTL_ARCHIVE_BATCH_LOAD;
   vListInitialise (&archives->archives);
 }
 
@@ -554,12 +1220,15 @@ rtems_rtl_archives_close (rtems_rtl_archives* archives)
   if (rtems_rtl_trace (RTEMS_RTL_TRACE_ARCHIVES))
     printf ("rtl: archive: close: count=%zu\n",
             listCURRENT_LIST_LENGTH( &archives->archives));
+  rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_SYMBOL, archives->directory.slots);
+  memset (&archives->directory, 0, sizeof (archives->directory));
   node = listGET_HEAD_ENTRY (&archives->archives);
   while (listGET_END_MARKER (&archives->archives) != node)
   {
     rtems_rtl_archive* archive = (rtems_rtl_archive*) node;
     ListItem_t*  next_node = listGET_NEXT (node);
-    rtems_rtl_archive_del (archive);
+    archive->flags &= ~RTEMS_RTL_ARCHIVE_DIRECTORY;
+    rtems_rtl_archive_del (archives, archive);
     node = next_node;
   }
   rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_OBJECT, (void*) archives->config);
@@ -581,16 +1250,25 @@ rtems_rtl_archives_remove (rtems_rtl_archives* archives)
     {
       archive->flags &= ~RTEMS_RTL_ARCHIVE_REMOVE;
       if ((archive->flags & RTEMS_RTL_ARCHIVE_USER_LOAD) == 0)
-        rtems_rtl_archive_del (archive);
+        rtems_rtl_archive_del (archives, archive);
     }
     node = next_node;
   }
 }
 
+/**
+ * Archive loader iterator data.
+ */
+typedef struct rtems_rtl_archive_loader_data
+{
+  rtems_rtl_archives* archives;  /**< The archives being loaded. */
+  int                 loaded;    /**< The number of archives loaded. */
+} rtems_rtl_archive_loader_data;
+
 static bool
 rtems_rtl_archive_loader (rtems_rtl_archive* archive, void* data)
 {
-  int* loaded = (int*) data;
+  rtems_rtl_archive_loader_data* loader = (rtems_rtl_archive_loader_data*) data;
 
   if ((archive->flags & RTEMS_RTL_ARCHIVE_LOAD) != 0)
   {
@@ -602,6 +1280,19 @@ rtems_rtl_archive_loader (rtems_rtl_archive* archive, void* data)
     if (rtems_rtl_trace (RTEMS_RTL_TRACE_ARCHIVES))
       printf ("rtl: archive: loader: %s\n", archive->name);
 
+    /*
+     * The symbol table is about to be replaced so remove any directory
+     * entries that reference it.
+     */
+    rtems_rtl_archive_dir_remove (loader->archives, archive);
+
+    /*
+     * The archive may have changed so close it and forget its members.
+     */
+    rtems_rtl_archive_close (archive);
+    rtems_rtl_archive_members_erase (&archive->members);
+    archive->enames = 0;
+
     fd = open (archive->name, O_RDONLY);
     if (fd < 0)
     {
@@ -637,7 +1328,7 @@ rtems_rtl_archive_loader (rtems_rtl_archive* archive, void* data)
         if (archive->symbols.base == NULL)
         {
           close (fd);
-          memset (&archive->symbols, 0, sizeof (archive->symbols));
+          rtems_rtl_archive_symbols_erase (&archive->symbols);
           rtems_rtl_archive_set_error (ENOMEM, "symbol table memory");
           return true;
         }
@@ -648,9 +1339,8 @@ rtems_rtl_archive_loader (rtems_rtl_archive* archive, void* data)
        */
       if (!rtems_rtl_seek_read (fd, offset, size, archive->symbols.base))
       {
-        rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_SYMBOL, archive->symbols.base);
         close (fd);
-        memset (&archive->symbols, 0, sizeof (archive->symbols));
+        rtems_rtl_archive_symbols_erase (&archive->symbols);
         rtems_rtl_archive_set_error (errno, "reading symbols");
         return true;
       }
@@ -663,9 +1353,8 @@ rtems_rtl_archive_loader (rtems_rtl_archive* archive, void* data)
         rtems_rtl_archive_read_32 (archive->symbols.base);
       if (archive->symbols.entries >= (SIZE_MAX / sizeof (rtems_rtl_archive_symbol)))
       {
-        rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_SYMBOL, archive->symbols.base);
         close (fd);
-        memset (&archive->symbols, 0, sizeof (archive->symbols));
+        rtems_rtl_archive_symbols_erase (&archive->symbols);
         rtems_rtl_archive_set_error (errno, "too many symbols");
         return true;
       }
@@ -675,8 +1364,13 @@ rtems_rtl_archive_loader (rtems_rtl_archive* archive, void* data)
       archive->symbols.names += (archive->symbols.entries + 1) * 4;
 
       /*
-       * Create a sorted symbol table.
+       * Create a sorted symbol table and the hash. Release any tables from a
+       * previous load.
        */
+      rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_SYMBOL, archive->symbols.hash);
+      rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_SYMBOL, archive->symbols.symbols);
+      archive->symbols.hash = NULL;
+      archive->symbols.hash_size = 0;
       size = archive->symbols.entries * sizeof (rtems_rtl_archive_symbol);
       archive->symbols.symbols =
         rtems_rtl_alloc_new (RTEMS_RTL_ALLOC_SYMBOL, size, true);
@@ -694,16 +1388,18 @@ rtems_rtl_archive_loader (rtems_rtl_archive* archive, void* data)
                archive->symbols.entries,
                sizeof (rtems_rtl_archive_symbol),
                rtems_rtl_archive_symbol_compare);
+        rtems_rtl_archive_hash_create (&archive->symbols);
       }
 
       if (rtems_rtl_trace (RTEMS_RTL_TRACE_ARCHIVES))
         printf ("rtl: archive: loader: symbols: " \
-                "base=%p entries=%zu names=%p (0x%08x) symbols=%p\n",
+                "base=%p entries=%zu names=%p (0x%08x) symbols=%p hash=%zu\n",
                 archive->symbols.base,
                 archive->symbols.entries,
                 archive->symbols.names,
                 (unsigned int) (archive->symbols.entries + 1) * 4,
-                archive->symbols.symbols);
+                archive->symbols.symbols,
+                archive->symbols.hash_size);
 
       if (rtems_rtl_trace (RTEMS_RTL_TRACE_ARCHIVE_SYMS) &&
           archive->symbols.entries > 0)
@@ -723,6 +1419,8 @@ rtems_rtl_archive_loader (rtems_rtl_archive* archive, void* data)
 
     archive->flags &= ~RTEMS_RTL_ARCHIVE_LOAD;
 
+    rtems_rtl_archive_dir_add (loader->archives, archive);
+
 #if configMPU_COMPARTMENTALIZATION_MODE == 2
   archive->comp_id  = rtl_cherifreertos_compartment_get_free_compid();
   rtl_cherifreertos_compartment_set_archive(archive);
@@ -765,7 +1463,7 @@ rtems_rtl_archive_loader (rtems_rtl_archive* archive, void* data)
   }
 #endif /* configCHERI_COMPARTMENTALIZATION_MODE */
 
-    ++(*loaded);
+    ++loader->loaded;
   }
 
   return true;
@@ -774,13 +1472,16 @@ rtems_rtl_archive_loader (rtems_rtl_archive* archive, void* data)
 static bool
 rtems_rtl_archives_load (rtems_rtl_archives* archives)
 {
-  int loaded = 0;
+  rtems_rtl_archive_loader_data loader = {
+    .archives = archives,
+    .loaded = 0
+  };
   if (rtems_rtl_trace (RTEMS_RTL_TRACE_ARCHIVES))
     printf ("rtl: archive: archive: load\n");
   rtems_rtl_archive_iterate_archives (archives,
                                       rtems_rtl_archive_loader,
-                                      &loaded);
-  return loaded > 0;
+                                      &loader);
+  return loader.loaded > 0;
 }
 
 bool
@@ -968,13 +1669,72 @@ rtems_rtl_archives_refresh (rtems_rtl_archives* archives)
   return true;
 }
 
+bool
+rtems_rtl_archives_refresh_check (rtems_rtl_archives* archives)
+{
+  const TickType_t now = xTaskGetTickCount ();
+  bool             refresh;
+
+  refresh = !archives->refreshed ||
+    archives->generation != archives->refresh_generation;
+
+  switch (archives->refresh_mode)
+  {
+    case rtems_rtl_archive_refresh_always:
+      refresh = true;
+      break;
+    case rtems_rtl_archive_refresh_interval:
+      if ((now - archives->refresh_tick) >= archives->refresh_interval)
+        refresh = true;
+      break;
+    case rtems_rtl_archive_refresh_explicit:
+    default:
+      break;
+  }
+
+  if (!refresh)
+  {
+    if (rtems_rtl_trace (RTEMS_RTL_TRACE_ARCHIVES))
+      printf ("rtl: archive: refresh: not needed: generation=%" PRIu32 "\n",
+              archives->generation);
+    return true;
+  }
+
+  archives->refreshed = true;
+  archives->refresh_generation = archives->generation;
+  archives->refresh_tick = now;
+
+  return rtems_rtl_archives_refresh (archives);
+}
+
+void
+rtems_rtl_archives_set_refresh (rtems_rtl_archives*       archives,
+                                rtems_rtl_archive_refresh mode,
+                                TickType_t                interval)
+{
+  if (rtems_rtl_trace (RTEMS_RTL_TRACE_ARCHIVES))
+    printf ("rtl: archive: refresh: mode=%d interval=%lu\n",
+            (int) mode, (unsigned long) interval);
+  archives->refresh_mode = mode;
+  archives->refresh_interval = interval;
+}
+
+void
+rtems_rtl_archives_changed (rtems_rtl_archives* archives)
+{
+  ++archives->generation;
+}
+
 bool
 rtems_rtl_archive_load (rtems_rtl_archives* archives, const char* name)
 {
   if (archives != NULL)
   {
-    rtems_rtl_archive* archive;
-    int                loaded = 0;
+    rtems_rtl_archive*            archive;
+    rtems_rtl_archive_loader_data loader = {
+      .archives = archives,
+      .loaded = 0
+    };
 
     archive = rtems_rtl_archive_get (archives, "", name);
     if (archive == NULL)
@@ -985,10 +1745,10 @@ rtems_rtl_archive_load (rtems_rtl_archives* archives, const char* name)
 
     archive->flags |= RTEMS_RTL_ARCHIVE_USER_LOAD;
 
-    rtems_rtl_archive_loader (archive, &loaded);
-    if (loaded == 0)
+    rtems_rtl_archive_loader (archive, &loader);
+    if (loader.loaded == 0)
     {
-      rtems_rtl_archive_del (archive);
+      rtems_rtl_archive_del (archives, archive);
       rtems_rtl_set_error (ENOENT, "archive load falied");
     }
 
@@ -997,11 +1757,17 @@ rtems_rtl_archive_load (rtems_rtl_archives* archives, const char* name)
   return false;
 }
 
-rtems_rtl_archive_search
-rtems_rtl_archive_single_obj_load (rtems_rtl_archive* archive, size_t obj_offset)
+/**
+ * Load the object file at the offset in the archive. The caches hold data
+ * from the archive which is open for the load. Flushing them is optional so
+ * a series of object files can be loaded from an archive with warm caches.
+ */
+static rtems_rtl_archive_search
+rtems_rtl_archive_member_load (rtems_rtl_archive* archive,
+                               size_t             obj_offset,
+                               bool               flush)
 {
   List_t*              pending;
-  int                  fd;
 
   pending = rtems_rtl_pending_unprotected ();
   rtems_rtl_obj* obj = rtems_rtl_obj_alloc ();
@@ -1013,46 +1779,20 @@ rtems_rtl_archive_single_obj_load (rtems_rtl_archive* archive, size_t obj_offset
     return rtems_rtl_archive_search_error;
   }
 
+  /*
+   * The object file is located in the archive when it is loaded. The archive
+   * is held open and its member cache gives the name and size.
+   */
   obj->aname = rtems_rtl_strdup (archive->name);
-
-  fd = open (obj->aname, O_RDONLY);
-  if (fd < 0)
-  {
-    if (rtems_rtl_trace (RTEMS_RTL_TRACE_ARCHIVES))
-      printf ("rtl: archive: load: open error: %s: %s\n",
-              obj->aname, strerror (errno));
-    rtems_rtl_obj_free (obj);
-    return rtems_rtl_archive_search_error;
-  }
-
+  obj->fname = rtems_rtl_strdup (archive->name);
   obj->oname = NULL;
   obj->ooffset = obj_offset;
-
-  if (!rtems_rtl_obj_archive_find_obj (fd,
-                                       archive->size,
-                                       &obj->oname,
-                                       &obj->ooffset,
-                                       &obj->fsize,
-                                       &archive->enames,
-                                       rtems_rtl_archive_set_error))
-  {
-    if (rtems_rtl_trace (RTEMS_RTL_TRACE_ARCHIVES))
-      printf ("rtl: archive: load: load error: %s:%s\n",
-              obj->aname, obj->oname);
-    close (fd);
-    rtems_rtl_obj_free (obj);
-    return rtems_rtl_archive_search_error;
-  }
-
-  obj->fname = rtems_rtl_strdup (obj->aname);
-  obj->ooffset -= RTEMS_RTL_AR_FHDR_SIZE;
   obj->fsize = archive->size;
-
-  close (fd);
+  obj->archive = archive;
 
   if (rtems_rtl_trace (RTEMS_RTL_TRACE_ARCHIVES))
-    printf ("rtl: archive: loading: %s:%s@0x%08lx size:%zu\n",
-            obj->aname, obj->oname, (unsigned long) obj->ooffset, obj->fsize);
+    printf ("rtl: archive: loading: %s@0x%08lx\n",
+            obj->aname, (unsigned long) obj->ooffset);
 
   vListInitialiseItem (&obj->link);
   vListInsertEnd (pending, &obj->link);
@@ -1070,8 +1810,6 @@ rtems_rtl_archive_single_obj_load (rtems_rtl_archive* archive, size_t obj_offset
     return rtems_rtl_archive_search_error;
   }
 
-  obj->archive = archive;
-
   #if configCHERI_COMPARTMENTALIZATION_MODE == 2
       rtems_rtl_obj_sym* sym = rtems_rtl_gsymbol_obj_find (obj, "CheriFreeRTOS_FaultHandler");
 
@@ -1089,7 +1827,8 @@ rtems_rtl_archive_single_obj_load (rtems_rtl_archive* archive, size_t obj_offset
       }
   #endif
 
-  rtems_rtl_obj_caches_flush ();
+  if (flush)
+    rtems_rtl_obj_caches_flush ();
 
   if (rtems_rtl_trace (RTEMS_RTL_TRACE_ARCHIVES))
     printf ("rtl: archive: loading: loaded: %s:%s@0x%08lx\n",
@@ -1099,6 +1838,40 @@ rtems_rtl_archive_single_obj_load (rtems_rtl_archive* archive, size_t obj_offset
 
 }
 
+rtems_rtl_archive_search
+rtems_rtl_archive_single_obj_load (rtems_rtl_archive* archive, size_t obj_offset)
+{
+  return rtems_rtl_archive_member_load (archive, obj_offset, true);
+}
+
+/**
+ * Search the directory if it holds all the archives else search each
+ * archive in turn.
+ */
+static void
+rtems_rtl_archive_symbol_search (rtems_rtl_archives*         archives,
+                                 rtems_rtl_archive_obj_data* search)
+{
+  if (archives->directory.valid)
+  {
+    if (rtems_rtl_trace (RTEMS_RTL_TRACE_ARCHIVES))
+      printf ("rtl: archive: search: directory: %s\n", search->symbol);
+
+    rtems_rtl_archive_dir_find (&archives->directory, search);
+  }
+  else
+  {
+    if (rtems_rtl_trace (RTEMS_RTL_TRACE_ARCHIVES))
+      printf ("rtl: archive: search: %zu archives: %s\n",
+              (size_t) listCURRENT_LIST_LENGTH (&archives->archives),
+              search->symbol);
+
+    rtems_rtl_archive_iterate_archives (archives,
+                                        rtems_rtl_archive_obj_finder,
+                                        search);
+  }
+}
+
 rtems_rtl_archive_search
 rtems_rtl_archive_obj_load (rtems_rtl_archives* archives,
                             const char*         symbol,
@@ -1132,12 +1905,7 @@ rtems_rtl_archive_obj_load (rtems_rtl_archives* archives,
     return rtems_rtl_archive_search_not_found;
   }
 
-  if (rtems_rtl_trace (RTEMS_RTL_TRACE_ARCHIVES))
-    printf ("rtl: archive: load: searching %zu archives\n", archive_count);
-
-  rtems_rtl_archive_iterate_archives (archives,
-                                      rtems_rtl_archive_obj_finder,
-                                      &search);
+  rtems_rtl_archive_symbol_search (archives, &search);
 
   if (search.archive == NULL)
   {
@@ -1156,6 +1924,139 @@ rtems_rtl_archive_obj_load (rtems_rtl_archives* archives,
   return rtems_rtl_archive_single_obj_load(search.archive, search.offset);
 }
 
+void
+rtems_rtl_archive_batch_init (rtems_rtl_archive_batch* batch)
+{
+  memset (batch, 0, sizeof (*batch));
+}
+
+void
+rtems_rtl_archive_batch_free (rtems_rtl_archive_batch* batch)
+{
+  rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_OBJECT, batch->members);
+  rtems_rtl_archive_batch_init (batch);
+}
+
+rtems_rtl_archive_search
+rtems_rtl_archive_batch_add (rtems_rtl_archives*      archives,
+                             rtems_rtl_archive_batch* batch,
+                             const char*              symbol)
+{
+  rtems_rtl_archive_obj_data search = {
+    .symbol  = symbol,
+    .archive = NULL,
+    .offset  = 0
+  };
+
+  if (listCURRENT_LIST_LENGTH (&archives->archives) == 0)
+    return rtems_rtl_archive_search_no_config;
+
+  rtems_rtl_archive_symbol_search (archives, &search);
+
+  if (search.archive == NULL)
+    return rtems_rtl_archive_search_not_found;
+
+  if (batch->count >= batch->size)
+  {
+    rtems_rtl_archive_batch_member* members;
+    size_t                          size = batch->size == 0 ? 16 : batch->size * 2;
+    members = rtems_rtl_alloc_new (RTEMS_RTL_ALLOC_OBJECT,
+                                   size * sizeof (rtems_rtl_archive_batch_member),
+                                   false);
+    if (members == NULL)
+    {
+      rtems_rtl_archive_set_error (ENOMEM, "no memory for batch");
+      return rtems_rtl_archive_search_error;
+    }
+    if (batch->count > 0)
+      memcpy (members, batch->members,
+              batch->count * sizeof (rtems_rtl_archive_batch_member));
+    rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_OBJECT, batch->members);
+    batch->members = members;
+    batch->size = size;
+  }
+
+  if (rtems_rtl_trace (RTEMS_RTL_TRACE_ARCHIVES))
+    printf ("rtl: archive: batch: add: %s: %s@0x%08lx\n",
+            symbol, search.archive->name, (unsigned long) search.offset);
+
+  batch->members[batch->count].archive = search.archive;
+  batch->members[batch->count].offset = search.offset;
+  ++batch->count;
+
+  return rtems_rtl_archive_search_found;
+}
+
+static int
+rtems_rtl_archive_batch_compare (const void* a, const void* b)
+{
+  const rtems_rtl_archive_batch_member* ma;
+  const rtems_rtl_archive_batch_member* mb;
+  ma = (const rtems_rtl_archive_batch_member*) a;
+  mb = (const rtems_rtl_archive_batch_member*) b;
+  if (ma->archive->order != mb->archive->order)
+    return ma->archive->order < mb->archive->order ? -1 : 1;
+  if (ma->offset != mb->offset)
+    return ma->offset < mb->offset ? -1 : 1;
+  return 0;
+}
+
+rtems_rtl_archive_search
+rtems_rtl_archive_batch_load (rtems_rtl_archives*      archives,
+                              rtems_rtl_archive_batch* batch)
+{
+  rtems_rtl_archive_search result = rtems_rtl_archive_search_not_found;
+  size_t                   m;
+
+  if (batch->count == 0)
+    return result;
+
+  /*
+   * Load each archive's object files in file offset order. More than one
+   * symbol can be in an object file so only load it once.
+   */
+  qsort (batch->members,
+         batch->count,
+         sizeof (rtems_rtl_archive_batch_member),
+         rtems_rtl_archive_batch_compare);
+
+  for (m = 0; m < batch->count; ++m)
+  {
+    const rtems_rtl_archive_batch_member* member = &batch->members[m];
+    rtems_rtl_archive_search              load;
+
+    if (m > 0 && rtems_rtl_archive_batch_compare (member, member - 1) == 0)
+      continue;
+
+    load = rtems_rtl_archive_member_load (member->archive,
+                                          member->offset,
+                                          false);
+    if (load == rtems_rtl_archive_search_loaded)
+    {
+      if (result == rtems_rtl_archive_search_not_found)
+        result = load;
+    }
+    else
+    {
+      result = load;
+    }
+  }
+
+  if (rtems_rtl_trace (RTEMS_RTL_TRACE_ARCHIVES))
+    printf ("rtl: archive: batch: loaded: %zu symbols, result=%d\n",
+            batch->count, (int) result);
+
+  rtems_rtl_obj_caches_flush ();
+
+  return result;
+}
+
+void
+rtems_rtl_archives_set_batch (rtems_rtl_archives* archives, bool batch)
+{
+  archives->batch_load = batch;
+}
+
 bool
 rtems_rtl_obj_archive_find_obj (int                     fd,
                                 size_t                  fsize,
@@ -1179,7 +2080,7 @@ rtems_rtl_obj_archive_find_obj (int                     fd,
   if (rtems_rtl_trace (RTEMS_RTL_TRACE_ARCHIVES))
     printf ("rtl: archive: find obj: %s @ 0x%08lx\n", *name, (unsigned long) *ooffset);
 
-  if (read (fd, &header[0], RTEMS_RTL_AR_IDENT_SIZE) !=  RTEMS_RTL_AR_IDENT_SIZE)
+  if (!rtems_rtl_seek_read (fd, 0, RTEMS_RTL_AR_IDENT_SIZE, &header[0]))
   {
     error (errno, "reading archive identifer");
     *ooffset = 0;
@@ -50,66 +50,164 @@ bit_word (size_t bit)
 static size_t
 bit_offset (size_t bit)
 {
-  return bit % (sizeof (uint32_t) * 8);
+  return bit % BITS_PER_WORD;
 }
 
+static size_t
+bit_full_words (size_t words)
+{
+  return (words + BITS_PER_WORD - 1) / BITS_PER_WORD;
+}
+
+/*
+ * The mask of the bits in a word from the offset for the count of bits. The
+ * count must not run past the end of the word.
+ */
 static uint32_t
-bit_mask (size_t bit)
+bit_run_mask (size_t offset, size_t bits)
+{
+  uint32_t mask = bits == BITS_PER_WORD ? 0xffffffff : ((1UL << bits) - 1);
+  return mask << offset;
+}
+
+/*
+ * Update the full bit map for a word of the bit map.
+ */
+static void
+bit_full_update (rtems_rtl_bit_alloc* balloc, size_t word)
 {
-  return 1 << bit_offset (bit);
+  if (balloc->bits[word] == 0xffffffff)
+    balloc->full[bit_word (word)] |= 1UL << bit_offset (word);
+  else
+    balloc->full[bit_word (word)] &= ~(1UL << bit_offset (word));
 }
 
 static void
 bit_set (rtems_rtl_bit_alloc* balloc, size_t start, size_t bits)
 {
-  size_t b;
-  for (b = start; b < (start + bits); ++b)
-    balloc->bits[bit_word (b)] |= bit_mask (b);
+  while (bits > 0)
+  {
+    size_t word = bit_word (start);
+    size_t offset = bit_offset (start);
+    size_t count = BITS_PER_WORD - offset;
+    if (count > bits)
+      count = bits;
+    balloc->bits[word] |= bit_run_mask (offset, count);
+    bit_full_update (balloc, word);
+    start += count;
+    bits -= count;
+  }
 }
 
 static void
 bit_clear (rtems_rtl_bit_alloc* balloc, size_t start, size_t bits)
 {
-  size_t b;
-  for (b = start; b < (start + bits); ++b)
-    balloc->bits[bit_word (b)] &= ~bit_mask (b);
+  while (bits > 0)
+  {
+    size_t word = bit_word (start);
+    size_t offset = bit_offset (start);
+    size_t count = BITS_PER_WORD - offset;
+    if (count > bits)
+      count = bits;
+    balloc->bits[word] &= ~bit_run_mask (offset, count);
+    bit_full_update (balloc, word);
+    start += count;
+    bits -= count;
+  }
 }
 
+/*
+ * Find the first word from the word that has a free block. The full bit map
+ * is searched so full words are skipped 32 at a time.
+ */
+static ssize_t
+bit_find_word (rtems_rtl_bit_alloc* balloc, size_t word)
+{
+  while (word < balloc->blocks)
+  {
+    uint32_t full = balloc->full[bit_word (word)] | (bit_run_mask (0, bit_offset (word)));
+    if (full != 0xffffffff)
+    {
+      word = (bit_word (word) * BITS_PER_WORD) + __builtin_ctz (~full);
+      return word < balloc->blocks ? (ssize_t) word : -1;
+    }
+    word = (bit_word (word) + 1) * BITS_PER_WORD;
+  }
+  return -1;
+}
+
+/*
+ * Find the first run of clear bits of the length in a word. A bit is left
+ * set in the result for each bit that starts a run.
+ */
+static uint32_t
+bit_word_runs (uint32_t word, size_t length)
+{
+  uint32_t runs = ~word;
+  size_t   shift = 1;
+  while ((shift * 2) <= length)
+  {
+    runs &= runs >> shift;
+    shift *= 2;
+  }
+  if (shift < length)
+    runs &= runs >> (length - shift);
+  return runs;
+}
+
+/*
+ * Find the first run of clear bits of the length a word at a time. A run
+ * carried from a word is the clear bits above its highest set bit and any
+ * clear words that follow it.
+ */
 static ssize_t
 bit_find_clear (rtems_rtl_bit_alloc* balloc, size_t blocks)
 {
   size_t base = 0;
   size_t clear = 0;
-  size_t b;
+  size_t b = 0;
 
-  for (b = 0; b < balloc->blocks; ++b)
+  if (blocks == 0)
+    return -1;
+
+  while (b < balloc->blocks)
   {
-    if (balloc->bits[b] != 0xffffffff)
+    uint32_t word = balloc->bits[b];
+
+    if (word == 0)
     {
-      uint32_t word = balloc->bits[b];
-      size_t   o;
-      for (o = 0; o < BITS_PER_WORD; ++o, word >>= 1)
-      {
-        if ((word & 1) == 0)
-        {
-          if (clear == 0)
-            base = (b * BITS_PER_WORD) + o;
-          ++clear;
-          if (clear == blocks)
-            return base;
-        }
-        else
-        {
-          clear = 0;
-          base = 0;
-        }
-      }
+      if (clear == 0)
+        base = b * BITS_PER_WORD;
+      clear += BITS_PER_WORD;
+      if (clear >= blocks)
+        return base;
+      ++b;
+      continue;
     }
-    else
+
+    if (word == 0xffffffff)
     {
+      ssize_t w = bit_find_word (balloc, b + 1);
+      if (w < 0)
+        return -1;
       clear = 0;
-      base = 0;
+      b = w;
+      continue;
     }
+
+    if (clear > 0 && (clear + __builtin_ctz (word)) >= blocks)
+      return base;
+
+    if (blocks < BITS_PER_WORD)
+    {
+      uint32_t runs = bit_word_runs (word, blocks);
+      if (runs != 0)
+        return (b * BITS_PER_WORD) + __builtin_ctz (runs);
+    }
+
+    clear = __builtin_clz (word);
+    base = ((b + 1) * BITS_PER_WORD) - clear;
+    ++b;
   }
 
   return -1;
@@ -122,6 +220,7 @@ rtems_rtl_bit_alloc_open (void* base, size_t size, size_t block_size, size_t use
   const size_t         base_size = base == NULL ? size : 0;;
   const size_t         blocks = (size / block_size) / BITS_PER_WORD;
   const size_t         bit_bytes = blocks * sizeof(uint32_t);
+  const size_t         full_bytes = bit_full_words (blocks) * sizeof(uint32_t);
 
   if (rtems_rtl_trace (RTEMS_RTL_TRACE_BIT_ALLOC))
     printf ("rtl: balloc: open: base=%p size=%zu" \
@@ -141,7 +240,8 @@ rtems_rtl_bit_alloc_open (void* base, size_t size, size_t block_size, size_t use
   }
 
   balloc = rtems_rtl_alloc_new (RTEMS_RTL_ALLOC_OBJECT,
-                                sizeof (rtems_rtl_bit_alloc) + bit_bytes + base_size,
+                                sizeof (rtems_rtl_bit_alloc) + bit_bytes +
+                                full_bytes + base_size,
                                 true);
   if (balloc == NULL)
   {
@@ -150,13 +250,22 @@ rtems_rtl_bit_alloc_open (void* base, size_t size, size_t block_size, size_t use
   }
 
   balloc->base =
-    base == NULL ? ((void*) balloc) + sizeof (rtems_rtl_bit_alloc) + bit_bytes: base;
+    base == NULL ?
+    ((void*) balloc) + sizeof (rtems_rtl_bit_alloc) + bit_bytes + full_bytes : base;
   balloc->size = size;
   balloc->bits = ((void*) balloc) + sizeof (rtems_rtl_bit_alloc);
+  balloc->full = ((void*) balloc->bits) + bit_bytes;
   balloc->block_size = block_size;
   balloc->blocks = blocks;
 
-  bit_set (balloc, 0, bit_blocks (balloc, used));
+  /*
+   * The bit map only covers whole words of blocks so do not mark more
+   * blocks used than there are.
+   */
+  used = bit_blocks (balloc, used);
+  if (used > (blocks * BITS_PER_WORD))
+    used = blocks * BITS_PER_WORD;
+  bit_set (balloc, 0, used);
 
   return balloc;
 }
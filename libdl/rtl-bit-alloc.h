@@ -31,6 +31,8 @@ typedef struct rtems_rtl_bit_alloc
   uint8_t*  base;       /**< The memory being allocated. */
   size_t    size;       /**< The number of bytes of memory being managed. */
   uint32_t* bits;       /**< The bit map indicating which blocks are allocated. */
+  uint32_t* full;       /**< The bit map indicating which words of the bit map
+                         *   have no free blocks. */
   size_t    block_size; /**< The size of a block, the minimum allocation unit. */
   size_t    blocks;     /**< The number of blocks in the memory. */
 } rtems_rtl_bit_alloc;
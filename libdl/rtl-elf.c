@@ -31,6 +31,7 @@
 #include "rtl-elf.h"
 #include "rtl-error.h"
 #include <rtl/rtl-trace.h>
+#include "rtl-lazy.h"
 #include "rtl-trampoline.h"
 #include "rtl-unwind.h"
 #include <rtl/rtl-unresolved.h>
@@ -294,7 +295,7 @@ rtems_rtl_elf_reloc_parser (rtems_rtl_obj*      obj,
      * Find the symbol's object file. It cannot be NULL so ignore that result
      * if returned, it means something is corrupted. We are in an iterator.
      */
-    rtems_rtl_obj*  sobj = rtems_rtl_find_obj_with_symbol (symname);
+    rtems_rtl_obj*  sobj = rtems_rtl_find_obj_with_symbol_for (symname, obj);
     if (sobj != NULL)
     {
       /*
@@ -329,6 +330,20 @@ rtems_rtl_elf_reloc_relocator (rtems_rtl_obj*      obj,
   const Elf_Rela* rela = (const Elf_Rela*) relbuf;
   const Elf_Rel*  rel = (const Elf_Rel*) relbuf;
 
+  /*
+   * A call to a function that cannot be resolved in a lazy load is relocated
+   * to a lazy binding stub. The function is bound on the first call.
+   */
+  if (!resolved && is_rela &&
+      rtems_rtl_lazy_reloc (obj, ELF_R_TYPE (rela->r_info)))
+  {
+    void* stub = rtems_rtl_lazy_stub (obj, symname);
+    if (stub == NULL)
+      return false;
+    symvalue = (Elf_Word) (uintptr_t) stub;
+    resolved = true;
+  }
+
   if (!resolved)
   {
     uint16_t       flags = 0;
@@ -388,7 +403,7 @@ rtems_rtl_elf_reloc_relocator (rtems_rtl_obj*      obj,
         return false;
     }
 
-    sobj = rtems_rtl_find_obj_with_symbol (symname);
+    sobj = rtems_rtl_find_obj_with_symbol_for (symname, obj);
 
     if (rtems_rtl_trace (RTEMS_RTL_TRACE_DEPENDENCY))
       printf ("rtl: depend: %s -> %s:%s\n",
@@ -482,6 +497,8 @@ rtems_rtl_elf_relocate_worker (rtems_rtl_obj*              obj,
     Elf_Word           symvalue = 0;
     bool               resolved;
 
+    rtems_rtl_load_work (1);
+
     off = obj->ooffset + sect->offset + (reloc * reloc_size);
 
     if (!rtems_rtl_obj_cache_read_byval (relocs, fd, off,
@@ -661,7 +678,7 @@ rtems_rtl_obj_relocate_unresolved (rtems_rtl_unresolv_reloc* reloc,
       reloc->obj->flags &= ~RTEMS_RTL_OBJ_UNRESOLVED;
   }
 
-  sobj = rtems_rtl_find_obj_with_symbol (sym->name);
+  sobj = rtems_rtl_find_obj_with_symbol_for (sym->name, reloc->obj);
 
   if (rtems_rtl_trace (RTEMS_RTL_TRACE_DEPENDENCY))
     printf ("rtl: depend: %s -> %s:%s\n",
@@ -711,6 +728,8 @@ rtems_rtl_elf_common (rtems_rtl_obj*      obj,
     Elf_Sym symbol;
     UBaseType_t off;
 
+    rtems_rtl_load_work (1);
+
     off = obj->ooffset + sect->offset + (sym * sizeof (symbol));
 
     if (!rtems_rtl_obj_cache_read_byval (symbols, fd, off,
@@ -759,7 +778,7 @@ rtems_rtl_elf_tramp_resolve_reloc (rtems_rtl_unresolv_rec* rec,
   rtems_rtl_tramp_data* td = (rtems_rtl_tramp_data*) data;
   if (rec->type == rtems_rtl_trampoline_reloc)
   {
-    const rtems_rtl_tramp_reloc* tramp = &rec->rec.tramp;
+    const rtems_rtl_tramp_reloc* tramp = rec->rec.tramp;
 
     ++td->total;
 
@@ -922,6 +941,8 @@ rtems_rtl_elf_symbols_load (rtems_rtl_obj*      obj,
     const char* name = NULL;
     size_t      len;
 
+    rtems_rtl_load_work (1);
+
     off = obj->ooffset + sect->offset + (sym * sizeof (symbol));
 
     if (!rtems_rtl_obj_cache_read_byval (symbols, fd, off,
@@ -1074,6 +1095,8 @@ rtems_rtl_elf_symbols_load (rtems_rtl_obj*      obj,
     UBaseType_t off;
     size_t  len;
 
+    rtems_rtl_load_work (1);
+
     off = obj->ooffset + sect->offset + (sym * sizeof (symbol));
 
     if (!rtems_rtl_obj_cache_read_byval (symbols, fd, off,
@@ -1241,6 +1264,7 @@ rtems_rtl_elf_symbols_locate (rtems_rtl_obj*      obj,
   {
       rtems_rtl_obj_sym*  osym = &obj->local_table[sym];
       rtems_rtl_obj_sect* symsect;
+      rtems_rtl_load_work (1);
       symsect = rtems_rtl_obj_find_section_by_index (obj, osym->data & 0xffffu);
       if (symsect)
       {
@@ -1300,6 +1324,7 @@ rtems_rtl_elf_symbols_locate (rtems_rtl_obj*      obj,
   {
       rtems_rtl_obj_sym*  osym = &obj->global_table[sym];
       rtems_rtl_obj_sect* symsect;
+      rtems_rtl_load_work (1);
       symsect = rtems_rtl_obj_find_section_by_index (obj, osym->data & 0xffffu);
       if (symsect)
       {
@@ -1422,6 +1447,8 @@ rtems_rtl_elf_loader (rtems_rtl_obj*      obj,
     len -= r;
   }
 
+  rtems_rtl_load_work (sect->size / RTEMS_RTL_LOAD_WORK_BYTES);
+
   return true;
 }
 
@@ -1720,9 +1747,9 @@ rtems_rtl_elf_load_linkmap (rtems_rtl_obj* obj)
   }
 
   obj->obj_num = 1;
-  obj->linkmap = rtems_rtl_alloc_new (RTEMS_RTL_ALLOC_OBJECT,
-                                      sizeof(struct link_map) +
-                                      sec_num * sizeof (section_detail), true);
+  obj->linkmap = rtems_rtl_arena_alloc (&obj->arena,
+                                        sizeof(struct link_map) +
+                                        sec_num * sizeof (section_detail), true);
   if (!obj->linkmap)
   {
     rtems_rtl_set_error (ENOMEM, "no memory for obj linkmap");
@@ -1969,6 +1996,8 @@ rtems_rtl_elf_file_load (rtems_rtl_obj* obj, int fd)
     return false;
   }
 
+  rtems_rtl_symbol_obj_movable (obj);
+
   return true;
 }
 
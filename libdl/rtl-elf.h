@@ -148,6 +148,50 @@ bool rtems_rtl_elf_rel_resolve_sym (Elf_Word type);
  */
 size_t rtems_rtl_elf_relocate_tramp_max_size (void);
 
+/**
+ * Architecture specific lazy binding stub size. A stub of this size is
+ * allocated for each function an object file calls through a lazy binding
+ * slot.
+ *
+ * @return size_t The size of a stub. 0 if lazy binding is not supported.
+ */
+size_t rtems_rtl_elf_lazy_stub_size (void);
+
+/**
+ * Architecture specific handler to check if a relocation record's type is a
+ * call that can be bound lazily.
+ *
+ * @param type The type field in the relocation record.
+ * @retval true The relocation record is a call that can be bound lazily.
+ * @retval false The relocation record has to be resolved.
+ */
+bool rtems_rtl_elf_rel_lazy (Elf_Word type);
+
+/**
+ * Architecture specific lazy binding stub initialisation. The stub calls the
+ * lazy binder until its target is set.
+ *
+ * @param stub The stub's memory.
+ */
+void rtems_rtl_elf_lazy_stub_init (void* stub);
+
+/**
+ * Architecture specific lazy binding stub target. The stub jumps to the
+ * target once it is set.
+ *
+ * @param stub The stub.
+ * @param target The function the stub jumps to.
+ */
+void rtems_rtl_elf_lazy_stub_set (void* stub, void* target);
+
+/**
+ * Architecture specific lazy binding stub synchronisation. The stub's code and
+ * target have been written and are made visible to instruction fetches.
+ *
+ * @param stub The stub.
+ */
+void rtems_rtl_elf_lazy_stub_sync (void* stub);
+
 bool
 rtems_rtl_elf_relocs_lo12_locator (rtems_rtl_obj*     obj,
                                    int                 fd,
@@ -1007,7 +1007,9 @@ rtl_cherifreertos_compartment_add_resource(size_t compid,
 {
   FreeRTOSCompartmentResources_t* pCompResTable = NULL;
 
-  FreeRTOSResource_t* newRes = pvPortMalloc (sizeof (FreeRTOSResource_t));
+  FreeRTOSResource_t* newRes = rtems_rtl_alloc_slab_new (RTEMS_RTL_ALLOC_OBJECT,
+                                                         sizeof (FreeRTOSResource_t),
+                                                         false);
 
   if (newRes == NULL) {
     printf("Failed to add %d resource to compartment %zu\n", (int) xResource.type, compid);
@@ -1029,6 +1031,7 @@ rtl_cherifreertos_compartment_add_resource(size_t compid,
 
   if (pCompResTable == NULL) {
     printf("No resources table found for compartment %zu\n", compid);
+    rtems_rtl_alloc_slab_del (RTEMS_RTL_ALLOC_OBJECT, sizeof (FreeRTOSResource_t), newRes);
     return;
   }
 
@@ -1067,6 +1070,7 @@ rtl_cherifreertos_compartment_remove_resource(size_t compid,
 
     if (res->handle == xResource.handle) {
       uxListRemove(node);
+      rtems_rtl_alloc_slab_del (RTEMS_RTL_ALLOC_OBJECT, sizeof (FreeRTOSResource_t), res);
       return;
     }
 
@@ -1087,11 +1091,13 @@ rtl_cherifreertos_compartment_revoke_tasks(FreeRTOSCompartmentResources_t* pComp
   while (listGET_END_MARKER (resouceList) != node)
   {
     FreeRTOSResource_t* res = (FreeRTOSResource_t *) node;
+    ListItem_t* next = listGET_NEXT (node);
 
     uxListRemove(node);
     vTaskDelete(res->handle);
+    rtems_rtl_alloc_slab_del (RTEMS_RTL_ALLOC_OBJECT, sizeof (FreeRTOSResource_t), res);
 
-    node = listGET_NEXT (node);
+    node = next;
   }
 }
 
@@ -0,0 +1,752 @@
+/*
+ *  The license and distribution terms for this file may be
+ *  found in the file LICENSE in this distribution or at
+ *  http://www.rtems.org/license/LICENSE.
+ */
+/**
+ * @file
+ *
+ * @ingroup rtems_rtl
+ *
+ * @brief RTEMS Run-Time Linker Two-Level Segregated Fit heap.
+ */
+
+/*
+ * A Two-Level Segregated Fit (TLSF) implementation of the RTL heap. It
+ * provides the same interface as rtl-heap_4.c and is selected at build time
+ * by setting configRTL_HEAP_TLSF to 1. The default allocator hook then uses
+ * it for all tags.
+ *
+ * Free blocks are held in lists segregated by size. The first level splits
+ * the sizes into powers of 2 and the second level splits each power of 2
+ * into linear ranges. A bitmap for each level finds a non-empty list with a
+ * find first set so an allocation and a free do not depend on the number of
+ * free blocks. The scheduler is suspended for a bounded time.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __CHERI_PURE_CAPABILITY__
+#include <cheriintrin.h>
+#endif
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+ * all the API functions to use the MPU wrappers.  That should only be done when
+ * task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "rtl-alloc-heap.h"
+
+#if configRTL_HEAP_TLSF
+
+#if ( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
+    #error This file must not be used if configSUPPORT_DYNAMIC_ALLOCATION is 0
+#endif
+
+/* The log2 of the number of second level lists for each first level. */
+#define tlsfSL_INDEX_COUNT_LOG2    ( 4 )
+#define tlsfSL_INDEX_COUNT         ( 1 << tlsfSL_INDEX_COUNT_LOG2 )
+
+/* The largest block is less than 2 to the power of this value. */
+#define tlsfFL_INDEX_MAX           ( 30 )
+
+/* Blocks smaller than this size are held in the first first level list
+ * which is split linearly. */
+#define tlsfSMALL_BLOCK_SIZE       ( ( size_t ) ( tlsfSL_INDEX_COUNT * portBYTE_ALIGNMENT ) )
+
+/* The number of first level lists. The first level list for small blocks
+ * and one for each power of 2 up to the largest block. */
+#define tlsfFL_INDEX_COUNT         ( tlsfFL_INDEX_MAX - ( tlsfSL_INDEX_COUNT_LOG2 + 2 ) + 2 )
+
+/* The bit in the block size set if the block is free. The size is always a
+ * multiple of the byte alignment so the bit is not part of the size. */
+#define tlsfBLOCK_FREE             ( ( size_t ) 1 )
+
+/* Allocate the memory for the heap. */
+#if ( configAPPLICATION_ALLOCATED_HEAP == 1 )
+
+/* The application writer has already defined the array used for the RTOS
+* heap - probably so it can be placed in a special segment or address. */
+    extern uint8_t ucRTLHeap[ configTOTAL_RTL_HEAP_SIZE ];
+#else
+    PRIVILEGED_HEAP static uint8_t ucRTLHeap[ configTOTAL_RTL_HEAP_SIZE ];
+#endif /* configAPPLICATION_ALLOCATED_HEAP */
+
+/* A block in the heap. The block's memory follows the pxPrevPhysBlock and
+ * xBlockSize members. The free list links are only valid when the block is
+ * free and are in the memory given to the application when it is not. */
+typedef struct A_TLSF_BLOCK
+{
+    struct A_TLSF_BLOCK * pxPrevPhysBlock; /*<< The block before this one in memory. */
+    size_t xBlockSize;                     /*<< The size of the block including its header. */
+    struct A_TLSF_BLOCK * pxNextFreeBlock; /*<< The next free block in the list. */
+    struct A_TLSF_BLOCK * pxPrevFreeBlock; /*<< The previous free block in the list. */
+} TlsfBlock_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Called automatically to setup the required heap structures the first time
+ * pvRTLMalloc() is called.
+ */
+static void prvHeapInit( void ) PRIVILEGED_FUNCTION;
+
+/*
+ * Insert a free block into the list for its size.
+ */
+static void prvInsertFreeBlock( TlsfBlock_t * pxBlock ) PRIVILEGED_FUNCTION;
+
+/*
+ * Remove a free block from the list for its size.
+ */
+static void prvRemoveFreeBlock( TlsfBlock_t * pxBlock ) PRIVILEGED_FUNCTION;
+
+/*
+ * Find a free block of at least the size and remove it from its list.
+ */
+static TlsfBlock_t * prvTakeFreeBlock( size_t xSize ) PRIVILEGED_FUNCTION;
+
+/*
+ * Split a block if what is left after the size is large enough to be a
+ * block. The block left is freed.
+ */
+static void prvSplitBlock( TlsfBlock_t * pxBlock, size_t xSize ) PRIVILEGED_FUNCTION;
+
+/*-----------------------------------------------------------*/
+
+/* The size of the part of a block's header that is present when the block is
+ * allocated. The application's memory follows it. */
+static const size_t xHeapStructSize = ( offsetof( TlsfBlock_t, pxNextFreeBlock ) + ( ( size_t ) ( portBYTE_ALIGNMENT - 1 ) ) ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+
+/* The smallest block has room for the free list links. */
+static const size_t xMinimumBlockSize = ( sizeof( TlsfBlock_t ) + ( ( size_t ) ( portBYTE_ALIGNMENT - 1 ) ) ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+
+/* The first level bitmap has a bit set for each first level with a free
+ * block and the second level bitmaps a bit for each list with a free block. */
+PRIVILEGED_DATA static uint32_t ulFirstLevelMap = 0;
+PRIVILEGED_DATA static uint32_t ulSecondLevelMap[ tlsfFL_INDEX_COUNT ];
+PRIVILEGED_DATA static TlsfBlock_t * pxFreeLists[ tlsfFL_INDEX_COUNT ][ tlsfSL_INDEX_COUNT ];
+
+/* The block at the end of the heap. It is never free so no block is merged
+ * past the end of the heap. */
+PRIVILEGED_DATA static TlsfBlock_t * pxEnd = NULL;
+
+/* Keeps track of the number of calls to allocate and free memory as well as the
+ * number of free bytes remaining, but says nothing about fragmentation. */
+PRIVILEGED_DATA static size_t xFreeBytesRemaining = 0U;
+PRIVILEGED_DATA static size_t xMinimumEverFreeBytesRemaining = 0U;
+PRIVILEGED_DATA static size_t xNumberOfSuccessfulAllocations = 0;
+PRIVILEGED_DATA static size_t xNumberOfSuccessfulFrees = 0;
+
+/*-----------------------------------------------------------*/
+
+static int prvFindLastSet( size_t xValue )
+{
+    return ( int ) ( ( sizeof( unsigned long ) * 8 ) - 1 ) - __builtin_clzl( ( unsigned long ) xValue );
+}
+
+static int prvFindFirstSet( uint32_t ulValue )
+{
+    return __builtin_ctz( ulValue );
+}
+
+static size_t prvBlockSize( const TlsfBlock_t * pxBlock )
+{
+    return pxBlock->xBlockSize & ~tlsfBLOCK_FREE;
+}
+
+static TlsfBlock_t * prvNextPhysBlock( TlsfBlock_t * pxBlock )
+{
+    return ( TlsfBlock_t * ) ( ( ( uint8_t * ) pxBlock ) + prvBlockSize( pxBlock ) );
+}
+
+static void prvMappingInsert( size_t xSize,
+                              int * pxFirstLevel,
+                              int * pxSecondLevel )
+{
+    if( xSize < tlsfSMALL_BLOCK_SIZE )
+    {
+        *pxFirstLevel = 0;
+        *pxSecondLevel = ( int ) ( xSize / ( tlsfSMALL_BLOCK_SIZE / tlsfSL_INDEX_COUNT ) );
+    }
+    else
+    {
+        int iLast = prvFindLastSet( xSize );
+        *pxSecondLevel = ( int ) ( ( xSize >> ( iLast - tlsfSL_INDEX_COUNT_LOG2 ) ) ^ tlsfSL_INDEX_COUNT );
+        *pxFirstLevel = iLast - prvFindLastSet( tlsfSMALL_BLOCK_SIZE ) + 1;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static size_t prvWantedSize( size_t xWantedSize )
+{
+    /* The wanted size must be increased so it can contain the block header
+     * in addition to the requested amount of bytes. Return 0 if the size
+     * cannot be allocated. */
+    if( ( xWantedSize == 0 ) ||
+        ( xWantedSize >= ( ( ( size_t ) 1 ) << tlsfFL_INDEX_MAX ) ) )
+    {
+        return 0;
+    }
+
+    xWantedSize += xHeapStructSize;
+    xWantedSize = ( xWantedSize + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+
+    if( xWantedSize < xMinimumBlockSize )
+    {
+        xWantedSize = xMinimumBlockSize;
+    }
+
+    return xWantedSize;
+}
+/*-----------------------------------------------------------*/
+
+static void prvUpdateAllocated( TlsfBlock_t * pxBlock )
+{
+    xFreeBytesRemaining -= prvBlockSize( pxBlock );
+
+    if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+    {
+        xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+    }
+
+    xNumberOfSuccessfulAllocations++;
+}
+/*-----------------------------------------------------------*/
+
+void * pvRTLMalloc( size_t xWantedSize )
+{
+    return pvRTLMallocAligned( xWantedSize, 0 );
+}
+/*-----------------------------------------------------------*/
+
+void * pvRTLMallocAligned( size_t xWantedSize, size_t xAlignment )
+{
+    TlsfBlock_t * pxBlock;
+    void * pvReturn = NULL;
+    size_t xBlockSize;
+
+#ifdef __CHERI_PURE_CAPABILITY__
+    size_t xCallerWantedSize;
+#endif
+
+    /* The alignment must be a power of 2 and is at least the alignment of
+     * every block. */
+    if( ( xAlignment & ( xAlignment - 1 ) ) != 0 )
+    {
+        return NULL;
+    }
+
+    if( xAlignment < portBYTE_ALIGNMENT )
+    {
+        xAlignment = portBYTE_ALIGNMENT;
+    }
+
+#ifdef __CHERI_PURE_CAPABILITY__
+    /* The bounds of the returned capability can only be exact if the length
+     * is representable and the base is aligned to the length's representable
+     * alignment. Pad the size and raise the alignment to suit. */
+    xWantedSize = cheri_representable_length( xWantedSize );
+
+    if( ( ~cheri_representable_alignment_mask( xWantedSize ) + 1 ) > xAlignment )
+    {
+        xAlignment = ~cheri_representable_alignment_mask( xWantedSize ) + 1;
+    }
+
+    xCallerWantedSize = xWantedSize;
+#endif
+
+    xBlockSize = prvWantedSize( xWantedSize );
+
+    vTaskSuspendAll();
+    {
+        /* If this is the first call to malloc then the heap will require
+         * initialisation to setup the list of free blocks. */
+        if( pxEnd == NULL )
+        {
+            prvHeapInit();
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        if( ( xBlockSize > 0 ) && ( xBlockSize <= xFreeBytesRemaining ) )
+        {
+            if( xAlignment == portBYTE_ALIGNMENT )
+            {
+                pxBlock = prvTakeFreeBlock( xBlockSize );
+            }
+            else
+            {
+                /* Find a block with room to move the memory to the alignment
+                 * and to leave a free block in front of it. */
+                pxBlock = NULL;
+
+                if( ( xBlockSize + xAlignment + xMinimumBlockSize ) > xBlockSize )
+                {
+                    pxBlock = prvTakeFreeBlock( xBlockSize + xAlignment + xMinimumBlockSize );
+                }
+
+                if( pxBlock != NULL )
+                {
+                    size_t uxAddress = ( ( size_t ) pxBlock ) + xHeapStructSize;
+                    size_t xLeadSize = ( ( uxAddress + ( xAlignment - 1 ) ) & ~( xAlignment - 1 ) ) - uxAddress;
+
+                    if( ( xLeadSize != 0 ) && ( xLeadSize < xMinimumBlockSize ) )
+                    {
+                        uxAddress += xMinimumBlockSize;
+                        xLeadSize = xMinimumBlockSize +
+                                    ( ( ( uxAddress + ( xAlignment - 1 ) ) & ~( xAlignment - 1 ) ) - uxAddress );
+                    }
+
+                    if( xLeadSize != 0 )
+                    {
+                        /* Free the lead as a block of its own. */
+                        TlsfBlock_t * pxLead = pxBlock;
+                        TlsfBlock_t * pxNext = prvNextPhysBlock( pxBlock );
+
+                        pxBlock = ( TlsfBlock_t * ) ( ( ( uint8_t * ) pxLead ) + xLeadSize );
+                        pxBlock->xBlockSize = prvBlockSize( pxLead ) - xLeadSize;
+                        pxBlock->pxPrevPhysBlock = pxLead;
+                        pxNext->pxPrevPhysBlock = pxBlock;
+                        pxLead->xBlockSize = xLeadSize | tlsfBLOCK_FREE;
+                        prvInsertFreeBlock( pxLead );
+                    }
+                    else
+                    {
+                        mtCOVERAGE_TEST_MARKER();
+                    }
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+
+            if( pxBlock != NULL )
+            {
+                prvSplitBlock( pxBlock, xBlockSize );
+                pxBlock->xBlockSize &= ~tlsfBLOCK_FREE;
+                prvUpdateAllocated( pxBlock );
+                pvReturn = ( void * ) ( ( ( uint8_t * ) pxBlock ) + xHeapStructSize );
+                configASSERT( ( ( ( size_t ) pvReturn ) & ( xAlignment - 1 ) ) == 0 );
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        traceMALLOC( pvReturn, xBlockSize );
+    }
+    ( void ) xTaskResumeAll();
+
+    #if ( configUSE_MALLOC_FAILED_HOOK == 1 )
+        {
+            if( pvReturn == NULL )
+            {
+                extern void vApplicationMallocFailedHook( void );
+                vApplicationMallocFailedHook();
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+    #endif /* if ( configUSE_MALLOC_FAILED_HOOK == 1 ) */
+
+#ifdef __CHERI_PURE_CAPABILITY__
+    if( pvReturn != NULL )
+    {
+        pvReturn = cheri_bounds_set_exact( pvReturn, xCallerWantedSize );
+    }
+#endif
+    return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vRTLFree( void * pv )
+{
+    uint8_t * puc = ( uint8_t * ) pv;
+    TlsfBlock_t * pxBlock;
+    TlsfBlock_t * pxNext;
+
+    if( pv != NULL )
+    {
+        /* The memory being freed will have the block header immediately
+         * before it. */
+#ifdef __CHERI_PURE_CAPABILITY__
+        /* For purecap, the bounds are set in malloc, so we cannot just take the
+        capability and subtract base. We have to rederive. */
+        puc = ucRTLHeap;
+        size_t pvAddr = cheri_address_get(pv);
+        size_t pucBase = cheri_base_get(puc);
+        puc = cheri_offset_set(puc, pvAddr - pucBase);
+#endif
+        puc -= xHeapStructSize;
+
+        /* This casting is to keep the compiler from issuing warnings. */
+        pxBlock = ( void * ) puc;
+
+        /* Check the block is actually allocated. */
+        configASSERT( ( pxBlock->xBlockSize & tlsfBLOCK_FREE ) == 0 );
+
+        if( ( pxBlock->xBlockSize & tlsfBLOCK_FREE ) == 0 )
+        {
+            vTaskSuspendAll();
+            {
+                xFreeBytesRemaining += prvBlockSize( pxBlock );
+                traceFREE( pv, prvBlockSize( pxBlock ) );
+
+                /* Merge with the free blocks either side. */
+                pxNext = prvNextPhysBlock( pxBlock );
+
+                if( ( pxNext->xBlockSize & tlsfBLOCK_FREE ) != 0 )
+                {
+                    prvRemoveFreeBlock( pxNext );
+                    pxBlock->xBlockSize += prvBlockSize( pxNext );
+                    pxNext = prvNextPhysBlock( pxBlock );
+                    pxNext->pxPrevPhysBlock = pxBlock;
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+
+                if( ( pxBlock->pxPrevPhysBlock != NULL ) &&
+                    ( ( pxBlock->pxPrevPhysBlock->xBlockSize & tlsfBLOCK_FREE ) != 0 ) )
+                {
+                    TlsfBlock_t * pxPrev = pxBlock->pxPrevPhysBlock;
+                    prvRemoveFreeBlock( pxPrev );
+                    pxPrev->xBlockSize += prvBlockSize( pxBlock );
+                    pxNext->pxPrevPhysBlock = pxPrev;
+                    pxBlock = pxPrev;
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+
+                pxBlock->xBlockSize |= tlsfBLOCK_FREE;
+                prvInsertFreeBlock( pxBlock );
+                xNumberOfSuccessfulFrees++;
+            }
+            ( void ) xTaskResumeAll();
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+size_t xRTLtGetFreeHeapSize( void )
+{
+    return xFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+static size_t xRTLtGetMinimumEverFreeHeapSize( void )
+{
+    return xMinimumEverFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+void vRTLInitialiseBlocks( void )
+{
+    /* The heap is otherwise initialised by the first allocation. */
+    vTaskSuspendAll();
+    {
+        if( pxEnd == NULL )
+        {
+            prvHeapInit();
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    ( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+void vRTLGetHeapStats( HeapStats_t * pxHeapStats )
+{
+    TlsfBlock_t * pxBlock;
+    size_t xBlocks = 0, xMaxSize = 0, xMinSize = portMAX_DELAY; /* portMAX_DELAY used as a portable way of getting the maximum value. */
+    int iFirstLevel, iSecondLevel;
+
+    vTaskSuspendAll();
+    {
+        /* Only the lists with a bit set in the bitmaps hold free blocks. The
+         * bitmaps are clear if the heap has not been initialised. */
+        for( iFirstLevel = 0; iFirstLevel < tlsfFL_INDEX_COUNT; iFirstLevel++ )
+        {
+            if( ( ulFirstLevelMap & ( 1UL << iFirstLevel ) ) != 0 )
+            {
+                for( iSecondLevel = 0; iSecondLevel < tlsfSL_INDEX_COUNT; iSecondLevel++ )
+                {
+                    pxBlock = pxFreeLists[ iFirstLevel ][ iSecondLevel ];
+
+                    while( pxBlock != NULL )
+                    {
+                        xBlocks++;
+
+                        if( prvBlockSize( pxBlock ) > xMaxSize )
+                        {
+                            xMaxSize = prvBlockSize( pxBlock );
+                        }
+
+                        if( prvBlockSize( pxBlock ) < xMinSize )
+                        {
+                            xMinSize = prvBlockSize( pxBlock );
+                        }
+
+                        pxBlock = pxBlock->pxNextFreeBlock;
+                    }
+                }
+            }
+        }
+    }
+    ( void ) xTaskResumeAll();
+
+    pxHeapStats->xSizeOfLargestFreeBlockInBytes = xMaxSize;
+    pxHeapStats->xSizeOfSmallestFreeBlockInBytes = xMinSize;
+    pxHeapStats->xNumberOfFreeBlocks = xBlocks;
+
+    taskENTER_CRITICAL();
+    {
+        pxHeapStats->xAvailableHeapSpaceInBytes = xFreeBytesRemaining;
+        pxHeapStats->xNumberOfSuccessfulAllocations = xNumberOfSuccessfulAllocations;
+        pxHeapStats->xNumberOfSuccessfulFrees = xNumberOfSuccessfulFrees;
+        pxHeapStats->xMinimumEverFreeBytesRemaining = xRTLtGetMinimumEverFreeHeapSize();
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+static void prvHeapInit( void ) /* PRIVILEGED_FUNCTION */
+{
+    TlsfBlock_t * pxFirstFreeBlock;
+    uint8_t * pucAlignedHeap;
+    size_t uxAddress;
+    size_t xTotalHeapSize = configTOTAL_RTL_HEAP_SIZE;
+
+    /* Ensure the heap starts on a correctly aligned boundary. */
+    uxAddress = ( size_t ) ucRTLHeap;
+
+    if( ( uxAddress & portBYTE_ALIGNMENT_MASK ) != 0 )
+    {
+        uxAddress += ( portBYTE_ALIGNMENT - 1 );
+        uxAddress &= ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+        xTotalHeapSize -= uxAddress - ( size_t ) ucRTLHeap;
+    }
+
+    pucAlignedHeap = ( uint8_t * ) ucRTLHeap + ( uxAddress - ( size_t ) ucRTLHeap );
+
+    /* pxEnd is an allocated block with no size at the end of the heap
+     * space. */
+    uxAddress = ( ( size_t ) pucAlignedHeap ) + xTotalHeapSize;
+    uxAddress -= xHeapStructSize;
+    uxAddress &= ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+    pxEnd = ( void * ) ( ( uint8_t * ) ucRTLHeap + ( uxAddress - ( size_t ) ucRTLHeap ) );
+
+    /* To start with there is a single free block that is sized to take up the
+     * entire heap space, minus the space taken by pxEnd. */
+    pxFirstFreeBlock = ( void * ) pucAlignedHeap;
+    pxFirstFreeBlock->pxPrevPhysBlock = NULL;
+    pxFirstFreeBlock->xBlockSize = ( uxAddress - ( size_t ) pxFirstFreeBlock ) | tlsfBLOCK_FREE;
+
+    pxEnd->pxPrevPhysBlock = pxFirstFreeBlock;
+    pxEnd->xBlockSize = 0;
+
+    configASSERT( prvBlockSize( pxFirstFreeBlock ) < ( ( ( size_t ) 1 ) << tlsfFL_INDEX_MAX ) );
+
+    memset( ulSecondLevelMap, 0, sizeof( ulSecondLevelMap ) );
+    memset( pxFreeLists, 0, sizeof( pxFreeLists ) );
+    ulFirstLevelMap = 0;
+
+    prvInsertFreeBlock( pxFirstFreeBlock );
+
+    /* Only one block exists - and it covers the entire usable heap space. */
+    xMinimumEverFreeBytesRemaining = prvBlockSize( pxFirstFreeBlock );
+    xFreeBytesRemaining = prvBlockSize( pxFirstFreeBlock );
+}
+/*-----------------------------------------------------------*/
+
+static void prvInsertFreeBlock( TlsfBlock_t * pxBlock ) /* PRIVILEGED_FUNCTION */
+{
+    int iFirstLevel, iSecondLevel;
+
+    prvMappingInsert( prvBlockSize( pxBlock ), &iFirstLevel, &iSecondLevel );
+
+    pxBlock->pxPrevFreeBlock = NULL;
+    pxBlock->pxNextFreeBlock = pxFreeLists[ iFirstLevel ][ iSecondLevel ];
+
+    if( pxBlock->pxNextFreeBlock != NULL )
+    {
+        pxBlock->pxNextFreeBlock->pxPrevFreeBlock = pxBlock;
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    pxFreeLists[ iFirstLevel ][ iSecondLevel ] = pxBlock;
+    ulFirstLevelMap |= ( 1UL << iFirstLevel );
+    ulSecondLevelMap[ iFirstLevel ] |= ( 1UL << iSecondLevel );
+}
+/*-----------------------------------------------------------*/
+
+static void prvRemoveFreeBlock( TlsfBlock_t * pxBlock ) /* PRIVILEGED_FUNCTION */
+{
+    int iFirstLevel, iSecondLevel;
+
+    prvMappingInsert( prvBlockSize( pxBlock ), &iFirstLevel, &iSecondLevel );
+
+    if( pxBlock->pxNextFreeBlock != NULL )
+    {
+        pxBlock->pxNextFreeBlock->pxPrevFreeBlock = pxBlock->pxPrevFreeBlock;
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    if( pxBlock->pxPrevFreeBlock != NULL )
+    {
+        pxBlock->pxPrevFreeBlock->pxNextFreeBlock = pxBlock->pxNextFreeBlock;
+    }
+    else
+    {
+        /* The block is the head of its list. Clear the bitmaps if the list
+         * is now empty. */
+        pxFreeLists[ iFirstLevel ][ iSecondLevel ] = pxBlock->pxNextFreeBlock;
+
+        if( pxBlock->pxNextFreeBlock == NULL )
+        {
+            ulSecondLevelMap[ iFirstLevel ] &= ~( 1UL << iSecondLevel );
+
+            if( ulSecondLevelMap[ iFirstLevel ] == 0 )
+            {
+                ulFirstLevelMap &= ~( 1UL << iFirstLevel );
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+
+    pxBlock->pxNextFreeBlock = NULL;
+    pxBlock->pxPrevFreeBlock = NULL;
+}
+/*-----------------------------------------------------------*/
+
+static TlsfBlock_t * prvTakeFreeBlock( size_t xSize ) /* PRIVILEGED_FUNCTION */
+{
+    TlsfBlock_t * pxBlock;
+    uint32_t ulMap;
+    int iFirstLevel, iSecondLevel;
+
+    /* Round the size up to the start of the next list so any block in the
+     * list found is large enough. */
+    if( xSize >= tlsfSMALL_BLOCK_SIZE )
+    {
+        size_t xRound = ( ( ( size_t ) 1 ) << ( prvFindLastSet( xSize ) - tlsfSL_INDEX_COUNT_LOG2 ) ) - 1;
+
+        if( ( xSize + xRound ) < xSize )
+        {
+            return NULL;
+        }
+
+        xSize += xRound;
+    }
+    else
+    {
+        xSize = ( xSize + ( ( tlsfSMALL_BLOCK_SIZE / tlsfSL_INDEX_COUNT ) - 1 ) ) &
+                ~( ( tlsfSMALL_BLOCK_SIZE / tlsfSL_INDEX_COUNT ) - 1 );
+    }
+
+    if( xSize >= ( ( ( size_t ) 1 ) << tlsfFL_INDEX_MAX ) )
+    {
+        return NULL;
+    }
+
+    prvMappingInsert( xSize, &iFirstLevel, &iSecondLevel );
+
+    /* Search the lists of the first level with blocks at least the size
+     * then the first level lists of larger blocks. */
+    ulMap = ulSecondLevelMap[ iFirstLevel ] & ( ~0UL << iSecondLevel );
+
+    if( ulMap == 0 )
+    {
+        ulMap = ulFirstLevelMap & ( ~0UL << ( iFirstLevel + 1 ) );
+
+        if( ulMap == 0 )
+        {
+            return NULL;
+        }
+
+        iFirstLevel = prvFindFirstSet( ulMap );
+        ulMap = ulSecondLevelMap[ iFirstLevel ];
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    iSecondLevel = prvFindFirstSet( ulMap );
+    pxBlock = pxFreeLists[ iFirstLevel ][ iSecondLevel ];
+    configASSERT( pxBlock != NULL );
+
+    prvRemoveFreeBlock( pxBlock );
+
+    return pxBlock;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSplitBlock( TlsfBlock_t * pxBlock, size_t xSize ) /* PRIVILEGED_FUNCTION */
+{
+    size_t xBlockSize = prvBlockSize( pxBlock );
+
+    if( ( xBlockSize - xSize ) >= xMinimumBlockSize )
+    {
+        TlsfBlock_t * pxNewBlock = ( void * ) ( ( ( uint8_t * ) pxBlock ) + xSize );
+        TlsfBlock_t * pxNext = prvNextPhysBlock( pxBlock );
+
+        configASSERT( ( ( ( size_t ) pxNewBlock ) & portBYTE_ALIGNMENT_MASK ) == 0 );
+
+        pxNewBlock->pxPrevPhysBlock = pxBlock;
+        pxNewBlock->xBlockSize = ( xBlockSize - xSize ) | tlsfBLOCK_FREE;
+        pxNext->pxPrevPhysBlock = pxNewBlock;
+        pxBlock->xBlockSize = xSize | ( pxBlock->xBlockSize & tlsfBLOCK_FREE );
+
+        /* The block following the new block is allocated or the new block
+         * would have been merged when it was freed. */
+        prvInsertFreeBlock( pxNewBlock );
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configRTL_HEAP_TLSF */
@@ -48,6 +48,8 @@
 
 #undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
 
+#include "rtl-alloc-heap.h"
+
 #if ( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
     #error This file must not be used if configSUPPORT_DYNAMIC_ALLOCATION is 0
 #endif
@@ -58,6 +60,8 @@
 /* Assumes 8bit bytes! */
 #define heapBITS_PER_BYTE         ( ( size_t ) 8 )
 
+#if !configRTL_HEAP_TLSF
+
 /* Allocate the memory for the heap. */
 #if ( configAPPLICATION_ALLOCATED_HEAP == 1 )
 
@@ -68,6 +72,8 @@
     PRIVILEGED_HEAP static uint8_t ucRTLHeap[ configTOTAL_RTL_HEAP_SIZE ];
 #endif /* configAPPLICATION_ALLOCATED_HEAP */
 
+#endif /* !configRTL_HEAP_TLSF */
+
 /* Define the linked list structure.  This is used to link free blocks in order
  * of their memory address. */
 typedef struct A_BLOCK_LINK
@@ -76,6 +82,24 @@ typedef struct A_BLOCK_LINK
     size_t xBlockSize;                     /*<< The size of the free block. */
 } BlockLink_t;
 
+/* A heap.  The RTL heap is the heap in ucRTLHeap and a region heap is held at
+ * the start of the region's memory. */
+typedef struct RTL_HEAP
+{
+    BlockLink_t xStart;                    /*<< The start of the list of free blocks. */
+    BlockLink_t * pxEnd;                   /*<< The end of the list, NULL until initialised. */
+    uint8_t * pucHeap;                     /*<< The heap's memory. */
+    size_t xHeapSize;                      /*<< The size of the heap's memory. */
+
+    /* Keeps track of the number of calls to allocate and free memory as well
+     * as the number of free bytes remaining, but says nothing about
+     * fragmentation. */
+    size_t xFreeBytesRemaining;
+    size_t xMinimumEverFreeBytesRemaining;
+    size_t xNumberOfSuccessfulAllocations;
+    size_t xNumberOfSuccessfulFrees;
+} RTLHeap_t;
+
 /*-----------------------------------------------------------*/
 
 /*
@@ -84,13 +108,19 @@ typedef struct A_BLOCK_LINK
  * the block in front it and/or the block behind it if the memory blocks are
  * adjacent to each other.
  */
-static void prvInsertBlockIntoFreeList( BlockLink_t * pxBlockToInsert ) PRIVILEGED_FUNCTION;
+static void prvInsertBlockIntoFreeList( RTLHeap_t * pxHeap, BlockLink_t * pxBlockToInsert ) PRIVILEGED_FUNCTION;
 
 /*
  * Called automatically to setup the required heap structures the first time
- * pvPortMalloc() is called.
+ * pvRTLMalloc() is called, or when a region heap is created.
  */
-static void prvHeapInit( void ) PRIVILEGED_FUNCTION;
+static void prvHeapInit( RTLHeap_t * pxHeap ) PRIVILEGED_FUNCTION;
+
+/*
+ * Returns the number of bytes at the start of a free block that must be left
+ * free so the memory following the block's BlockLink_t structure is aligned.
+ */
+static size_t prvAlignedLeadSize( BlockLink_t * pxBlock, size_t xAlignment ) PRIVILEGED_FUNCTION;
 
 /*-----------------------------------------------------------*/
 
@@ -98,15 +128,14 @@ static void prvHeapInit( void ) PRIVILEGED_FUNCTION;
  * block must by correctly byte aligned. */
 static const size_t xHeapStructSize = ( sizeof( BlockLink_t ) + ( ( size_t ) ( portBYTE_ALIGNMENT - 1 ) ) ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
 
-/* Create a couple of list links to mark the start and end of the list. */
-PRIVILEGED_DATA static BlockLink_t xStart, * pxEnd = NULL;
+/* The size of a region heap's control structure held at the start of the
+ * region. */
+static const size_t xHeapControlSize = ( sizeof( RTLHeap_t ) + ( ( size_t ) ( portBYTE_ALIGNMENT - 1 ) ) ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
 
-/* Keeps track of the number of calls to allocate and free memory as well as the
- * number of free bytes remaining, but says nothing about fragmentation. */
-PRIVILEGED_DATA static size_t xFreeBytesRemaining = 0U;
-PRIVILEGED_DATA static size_t xMinimumEverFreeBytesRemaining = 0U;
-PRIVILEGED_DATA static size_t xNumberOfSuccessfulAllocations = 0;
-PRIVILEGED_DATA static size_t xNumberOfSuccessfulFrees = 0;
+#if !configRTL_HEAP_TLSF
+/* The RTL heap. */
+PRIVILEGED_DATA static RTLHeap_t xRTLHeap = { { NULL, 0 }, NULL, ucRTLHeap, configTOTAL_RTL_HEAP_SIZE, 0U, 0U, 0, 0 };
+#endif /* !configRTL_HEAP_TLSF */
 
 /* Gets set to the top bit of an size_t type.  When this bit in the xBlockSize
  * member of an BlockLink_t structure is set then the block belongs to the
@@ -116,7 +145,10 @@ PRIVILEGED_DATA static size_t xBlockAllocatedBit = 0;
 
 /*-----------------------------------------------------------*/
 
-void * pvRTLMalloc( size_t xWantedSize )
+#if !configRTL_HEAP_TLSF
+
+/* Only the RTL heap allocates without an alignment. */
+static void * prvHeapMalloc( RTLHeap_t * pxHeap, size_t xWantedSize )
 {
     BlockLink_t * pxBlock, * pxPreviousBlock, * pxNewBlockLink;
     void * pvReturn = NULL;
@@ -129,9 +161,9 @@ void * pvRTLMalloc( size_t xWantedSize )
     {
         /* If this is the first call to malloc then the heap will require
          * initialisation to setup the list of free blocks. */
-        if( pxEnd == NULL )
+        if( pxHeap->pxEnd == NULL )
         {
-            prvHeapInit();
+            prvHeapInit( pxHeap );
         }
         else
         {
@@ -176,12 +208,12 @@ void * pvRTLMalloc( size_t xWantedSize )
                 xWantedSize = 0;
             }
 
-            if( ( xWantedSize > 0 ) && ( xWantedSize <= xFreeBytesRemaining ) )
+            if( ( xWantedSize > 0 ) && ( xWantedSize <= pxHeap->xFreeBytesRemaining ) )
             {
                 /* Traverse the list from the start	(lowest address) block until
                  * one of adequate size is found. */
-                pxPreviousBlock = &xStart;
-                pxBlock = xStart.pxNextFreeBlock;
+                pxPreviousBlock = &pxHeap->xStart;
+                pxBlock = pxHeap->xStart.pxNextFreeBlock;
 
                 while( ( pxBlock->xBlockSize < xWantedSize ) && ( pxBlock->pxNextFreeBlock != NULL ) )
                 {
@@ -191,7 +223,7 @@ void * pvRTLMalloc( size_t xWantedSize )
 
                 /* If the end marker was reached then a block of adequate size
                  * was not found. */
-                if( pxBlock != pxEnd )
+                if( pxBlock != pxHeap->pxEnd )
                 {
                     /* Return the memory space pointed to - jumping over the
                      * BlockLink_t structure at its start. */
@@ -218,18 +250,18 @@ void * pvRTLMalloc( size_t xWantedSize )
                         pxBlock->xBlockSize = xWantedSize;
 
                         /* Insert the new block into the list of free blocks. */
-                        prvInsertBlockIntoFreeList( pxNewBlockLink );
+                        prvInsertBlockIntoFreeList( pxHeap, pxNewBlockLink );
                     }
                     else
                     {
                         mtCOVERAGE_TEST_MARKER();
                     }
 
-                    xFreeBytesRemaining -= pxBlock->xBlockSize;
+                    pxHeap->xFreeBytesRemaining -= pxBlock->xBlockSize;
 
-                    if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+                    if( pxHeap->xFreeBytesRemaining < pxHeap->xMinimumEverFreeBytesRemaining )
                     {
-                        xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+                        pxHeap->xMinimumEverFreeBytesRemaining = pxHeap->xFreeBytesRemaining;
                     }
                     else
                     {
@@ -240,7 +272,7 @@ void * pvRTLMalloc( size_t xWantedSize )
                      * by the application and has no "next" block. */
                     pxBlock->xBlockSize |= xBlockAllocatedBit;
                     pxBlock->pxNextFreeBlock = NULL;
-                    xNumberOfSuccessfulAllocations++;
+                    pxHeap->xNumberOfSuccessfulAllocations++;
                 }
                 else
                 {
@@ -261,29 +293,213 @@ void * pvRTLMalloc( size_t xWantedSize )
     }
     ( void ) xTaskResumeAll();
 
-    #if ( configUSE_MALLOC_FAILED_HOOK == 1 )
+    configASSERT( ( ( ( size_t ) pvReturn ) & ( size_t ) portBYTE_ALIGNMENT_MASK ) == 0 );
+#ifdef __CHERI_PURE_CAPABILITY__
+    pvReturn = cheri_bounds_set(pvReturn, xCallerWantedSize);
+#endif
+    return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+#endif /* !configRTL_HEAP_TLSF */
+
+static void * prvHeapMallocAligned( RTLHeap_t * pxHeap, size_t xWantedSize, size_t xAlignment )
+{
+    BlockLink_t * pxBlock, * pxPreviousBlock, * pxNewBlockLink;
+    void * pvReturn = NULL;
+    size_t xLeadSize = 0;
+
+#ifdef __CHERI_PURE_CAPABILITY__
+    size_t xCallerWantedSize;
+#endif
+
+    /* The alignment must be a power of 2 and is at least the alignment of
+     * every block. */
+    if( ( xAlignment & ( xAlignment - 1 ) ) != 0 )
+    {
+        return NULL;
+    }
+
+    if( xAlignment < portBYTE_ALIGNMENT )
+    {
+        xAlignment = portBYTE_ALIGNMENT;
+    }
+
+#ifdef __CHERI_PURE_CAPABILITY__
+    /* The bounds of the returned capability can only be exact if the length
+     * is representable and the base is aligned to the length's representable
+     * alignment. Pad the size and raise the alignment to suit. */
+    xWantedSize = cheri_representable_length( xWantedSize );
+
+    if( ( ~cheri_representable_alignment_mask( xWantedSize ) + 1 ) > xAlignment )
+    {
+        xAlignment = ~cheri_representable_alignment_mask( xWantedSize ) + 1;
+    }
+
+    xCallerWantedSize = xWantedSize;
+#endif
+
+    vTaskSuspendAll();
+    {
+        /* If this is the first call to malloc then the heap will require
+         * initialisation to setup the list of free blocks. */
+        if( pxHeap->pxEnd == NULL )
         {
-            if( pvReturn == NULL )
+            prvHeapInit( pxHeap );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        /* Check the requested block size is not so large that the top bit is
+         * set. */
+        if( ( xWantedSize & xBlockAllocatedBit ) == 0 )
+        {
+            /* The wanted size must be increased so it can contain a BlockLink_t
+             * structure in addition to the requested amount of bytes. */
+            if( ( xWantedSize > 0 ) &&
+                ( ( xWantedSize + xHeapStructSize ) >  xWantedSize ) ) /* Overflow check */
             {
-                extern void vApplicationMallocFailedHook( void );
-                vApplicationMallocFailedHook();
+                xWantedSize += xHeapStructSize;
+
+                /* Ensure that blocks are always aligned. */
+                if( ( xWantedSize & portBYTE_ALIGNMENT_MASK ) != 0x00 )
+                {
+                    /* Byte alignment required. Check for overflow. */
+                    if( ( xWantedSize + ( portBYTE_ALIGNMENT - ( xWantedSize & portBYTE_ALIGNMENT_MASK ) ) )
+                            > xWantedSize )
+                    {
+                        xWantedSize += ( portBYTE_ALIGNMENT - ( xWantedSize & portBYTE_ALIGNMENT_MASK ) );
+                        configASSERT( ( xWantedSize & portBYTE_ALIGNMENT_MASK ) == 0 );
+                    }
+                    else
+                    {
+                        xWantedSize = 0;
+                    }
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+            else
+            {
+                xWantedSize = 0;
+            }
+
+            if( ( xWantedSize > 0 ) && ( xWantedSize <= pxHeap->xFreeBytesRemaining ) )
+            {
+                /* Traverse the list from the start (lowest address) block until
+                 * one is found that is large enough once the memory before the
+                 * aligned address is left free. */
+                pxPreviousBlock = &pxHeap->xStart;
+                pxBlock = pxHeap->xStart.pxNextFreeBlock;
+
+                while( pxBlock != pxHeap->pxEnd )
+                {
+                    xLeadSize = prvAlignedLeadSize( pxBlock, xAlignment );
+
+                    if( pxBlock->xBlockSize >= ( xLeadSize + xWantedSize ) )
+                    {
+                        break;
+                    }
+
+                    pxPreviousBlock = pxBlock;
+                    pxBlock = pxBlock->pxNextFreeBlock;
+                }
+
+                /* If the end marker was reached then a block of adequate size
+                 * was not found. */
+                if( pxBlock != pxHeap->pxEnd )
+                {
+                    if( xLeadSize > 0 )
+                    {
+                        /* Split the lead off. It stays in the list of free
+                         * blocks in the same position so the list does not
+                         * change. */
+                        pxNewBlockLink = ( void * ) ( ( ( uint8_t * ) pxBlock ) + xLeadSize );
+                        pxNewBlockLink->xBlockSize = pxBlock->xBlockSize - xLeadSize;
+                        pxBlock->xBlockSize = xLeadSize;
+                        pxBlock = pxNewBlockLink;
+                    }
+                    else
+                    {
+                        /* This block is being returned for use so must be
+                         * taken out of the list of free blocks. */
+                        pxPreviousBlock->pxNextFreeBlock = pxBlock->pxNextFreeBlock;
+                    }
+
+                    pvReturn = ( void * ) ( ( ( uint8_t * ) pxBlock ) + xHeapStructSize );
+                    configASSERT( ( ( ( size_t ) pvReturn ) & ( xAlignment - 1 ) ) == 0 );
+
+                    /* If the block is larger than required it can be split into
+                     * two. */
+                    if( ( pxBlock->xBlockSize - xWantedSize ) > heapMINIMUM_BLOCK_SIZE )
+                    {
+                        pxNewBlockLink = ( void * ) ( ( ( uint8_t * ) pxBlock ) + xWantedSize );
+                        configASSERT( ( ( ( size_t ) pxNewBlockLink ) & portBYTE_ALIGNMENT_MASK ) == 0 );
+
+                        /* Calculate the sizes of two blocks split from the
+                         * single block. */
+                        pxNewBlockLink->xBlockSize = pxBlock->xBlockSize - xWantedSize;
+                        pxBlock->xBlockSize = xWantedSize;
+
+                        /* Insert the new block into the list of free blocks. */
+                        prvInsertBlockIntoFreeList( pxHeap, pxNewBlockLink );
+                    }
+                    else
+                    {
+                        mtCOVERAGE_TEST_MARKER();
+                    }
+
+                    pxHeap->xFreeBytesRemaining -= pxBlock->xBlockSize;
+
+                    if( pxHeap->xFreeBytesRemaining < pxHeap->xMinimumEverFreeBytesRemaining )
+                    {
+                        pxHeap->xMinimumEverFreeBytesRemaining = pxHeap->xFreeBytesRemaining;
+                    }
+                    else
+                    {
+                        mtCOVERAGE_TEST_MARKER();
+                    }
+
+                    /* The block is being returned - it is allocated and owned
+                     * by the application and has no "next" block. */
+                    pxBlock->xBlockSize |= xBlockAllocatedBit;
+                    pxBlock->pxNextFreeBlock = NULL;
+                    pxHeap->xNumberOfSuccessfulAllocations++;
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
             }
             else
             {
                 mtCOVERAGE_TEST_MARKER();
             }
         }
-    #endif /* if ( configUSE_MALLOC_FAILED_HOOK == 1 ) */
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        traceMALLOC( pvReturn, xWantedSize );
+    }
+    ( void ) xTaskResumeAll();
 
-    configASSERT( ( ( ( size_t ) pvReturn ) & ( size_t ) portBYTE_ALIGNMENT_MASK ) == 0 );
 #ifdef __CHERI_PURE_CAPABILITY__
-    pvReturn = cheri_bounds_set(pvReturn, xCallerWantedSize);
+    if( pvReturn != NULL )
+    {
+        pvReturn = cheri_bounds_set_exact( pvReturn, xCallerWantedSize );
+    }
 #endif
     return pvReturn;
 }
 /*-----------------------------------------------------------*/
 
-void vRTLFree( void * pv )
+static void prvHeapFree( RTLHeap_t * pxHeap, void * pv )
 {
     uint8_t * puc = ( uint8_t * ) pv;
     BlockLink_t * pxLink;
@@ -295,7 +511,7 @@ void vRTLFree( void * pv )
 #ifdef __CHERI_PURE_CAPABILITY__
         /* For purecap, the bounds are set in malloc, so we cannot just take the
         capability and subtract base. We have to rederive. */
-        puc = ucRTLHeap;
+        puc = pxHeap->pucHeap;
         size_t pvAddr = cheri_address_get(pv);
         size_t pucBase = cheri_base_get(puc);
         puc = cheri_offset_set(puc, pvAddr - pucBase);
@@ -320,10 +536,10 @@ void vRTLFree( void * pv )
                 vTaskSuspendAll();
                 {
                     /* Add this block to the list of free blocks. */
-                    xFreeBytesRemaining += pxLink->xBlockSize;
+                    pxHeap->xFreeBytesRemaining += pxLink->xBlockSize;
                     traceFREE( pv, pxLink->xBlockSize );
-                    prvInsertBlockIntoFreeList( ( ( BlockLink_t * ) pxLink ) );
-                    xNumberOfSuccessfulFrees++;
+                    prvInsertBlockIntoFreeList( pxHeap, ( ( BlockLink_t * ) pxLink ) );
+                    pxHeap->xNumberOfSuccessfulFrees++;
                 }
                 ( void ) xTaskResumeAll();
             }
@@ -340,80 +556,132 @@ void vRTLFree( void * pv )
 }
 /*-----------------------------------------------------------*/
 
-size_t xRTLtGetFreeHeapSize( void )
+static void prvHeapGetStats( RTLHeap_t * pxHeap, HeapStats_t * pxHeapStats )
 {
-    return xFreeBytesRemaining;
-}
-/*-----------------------------------------------------------*/
+    BlockLink_t * pxBlock;
+    size_t xBlocks = 0, xMaxSize = 0, xMinSize = portMAX_DELAY; /* portMAX_DELAY used as a portable way of getting the maximum value. */
 
-static size_t xRTLtGetMinimumEverFreeHeapSize( void )
-{
-    return xMinimumEverFreeBytesRemaining;
-}
-/*-----------------------------------------------------------*/
+    vTaskSuspendAll();
+    {
+        pxBlock = pxHeap->xStart.pxNextFreeBlock;
 
-void vRTLInitialiseBlocks( void )
-{
-    /* This just exists to keep the linker quiet. */
+        /* pxBlock will be NULL if the heap has not been initialised.  The heap
+         * is initialised automatically when the first allocation is made. */
+        if( pxBlock != NULL )
+        {
+            do
+            {
+                /* Increment the number of blocks and record the largest block seen
+                 * so far. */
+                xBlocks++;
+
+                if( pxBlock->xBlockSize > xMaxSize )
+                {
+                    xMaxSize = pxBlock->xBlockSize;
+                }
+
+                if( pxBlock->xBlockSize < xMinSize )
+                {
+                    xMinSize = pxBlock->xBlockSize;
+                }
+
+                /* Move to the next block in the chain until the last block is
+                 * reached. */
+                pxBlock = pxBlock->pxNextFreeBlock;
+            } while( pxBlock != pxHeap->pxEnd );
+        }
+    }
+    ( void ) xTaskResumeAll();
+
+    pxHeapStats->xSizeOfLargestFreeBlockInBytes = xMaxSize;
+    pxHeapStats->xSizeOfSmallestFreeBlockInBytes = xMinSize;
+    pxHeapStats->xNumberOfFreeBlocks = xBlocks;
+
+    taskENTER_CRITICAL();
+    {
+        pxHeapStats->xAvailableHeapSpaceInBytes = pxHeap->xFreeBytesRemaining;
+        pxHeapStats->xNumberOfSuccessfulAllocations = pxHeap->xNumberOfSuccessfulAllocations;
+        pxHeapStats->xNumberOfSuccessfulFrees = pxHeap->xNumberOfSuccessfulFrees;
+        pxHeapStats->xMinimumEverFreeBytesRemaining = pxHeap->xMinimumEverFreeBytesRemaining;
+    }
+    taskEXIT_CRITICAL();
 }
 /*-----------------------------------------------------------*/
 
-static void prvHeapInit( void ) /* PRIVILEGED_FUNCTION */
+static void prvHeapInit( RTLHeap_t * pxHeap ) /* PRIVILEGED_FUNCTION */
 {
     BlockLink_t * pxFirstFreeBlock;
     uint8_t * pucAlignedHeap;
     size_t uxAddress;
-    size_t xTotalHeapSize = configTOTAL_RTL_HEAP_SIZE;
+    size_t xTotalHeapSize = pxHeap->xHeapSize;
 
     /* Ensure the heap starts on a correctly aligned boundary. */
-    uxAddress = ( size_t ) ucRTLHeap;
+    uxAddress = ( size_t ) pxHeap->pucHeap;
 
     if( ( uxAddress & portBYTE_ALIGNMENT_MASK ) != 0 )
     {
         uxAddress += ( portBYTE_ALIGNMENT - 1 );
         uxAddress &= ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
-        xTotalHeapSize -= uxAddress - ( size_t ) ucRTLHeap;
+        xTotalHeapSize -= uxAddress - ( size_t ) pxHeap->pucHeap;
     }
 
-    pucAlignedHeap = ( uint8_t * ) ucRTLHeap + ( uxAddress - ( size_t ) ucRTLHeap );
+    pucAlignedHeap = ( uint8_t * ) pxHeap->pucHeap + ( uxAddress - ( size_t ) pxHeap->pucHeap );
 
-    /* xStart is used to hold a pointer to the first item in the list of free
+    /* pxHeap->xStart is used to hold a pointer to the first item in the list of free
      * blocks.  The void cast is used to prevent compiler warnings. */
-    xStart.pxNextFreeBlock = ( void * ) pucAlignedHeap;
-    xStart.xBlockSize = ( size_t ) 0;
+    pxHeap->xStart.pxNextFreeBlock = ( void * ) pucAlignedHeap;
+    pxHeap->xStart.xBlockSize = ( size_t ) 0;
 
-    /* pxEnd is used to mark the end of the list of free blocks and is inserted
+    /* pxHeap->pxEnd is used to mark the end of the list of free blocks and is inserted
      * at the end of the heap space. */
     uxAddress = ( ( size_t ) pucAlignedHeap ) + xTotalHeapSize;
     uxAddress -= xHeapStructSize;
     uxAddress &= ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
-    pxEnd = ( void * )( ( uint8_t * ) ucRTLHeap + ( uxAddress - ( size_t ) ucRTLHeap ) );
-    pxEnd->xBlockSize = 0;
-    pxEnd->pxNextFreeBlock = NULL;
+    pxHeap->pxEnd = ( void * )( ( uint8_t * ) pxHeap->pucHeap + ( uxAddress - ( size_t ) pxHeap->pucHeap ) );
+    pxHeap->pxEnd->xBlockSize = 0;
+    pxHeap->pxEnd->pxNextFreeBlock = NULL;
 
     /* To start with there is a single free block that is sized to take up the
-     * entire heap space, minus the space taken by pxEnd. */
+     * entire heap space, minus the space taken by pxHeap->pxEnd. */
     pxFirstFreeBlock = ( void * ) pucAlignedHeap;
     pxFirstFreeBlock->xBlockSize = uxAddress - ( size_t ) pxFirstFreeBlock;
-    pxFirstFreeBlock->pxNextFreeBlock = pxEnd;
+    pxFirstFreeBlock->pxNextFreeBlock = pxHeap->pxEnd;
 
     /* Only one block exists - and it covers the entire usable heap space. */
-    xMinimumEverFreeBytesRemaining = pxFirstFreeBlock->xBlockSize;
-    xFreeBytesRemaining = pxFirstFreeBlock->xBlockSize;
+    pxHeap->xMinimumEverFreeBytesRemaining = pxFirstFreeBlock->xBlockSize;
+    pxHeap->xFreeBytesRemaining = pxFirstFreeBlock->xBlockSize;
 
     /* Work out the position of the top bit in a size_t variable. */
     xBlockAllocatedBit = ( ( size_t ) 1 ) << ( ( sizeof( size_t ) * heapBITS_PER_BYTE ) - 1 );
 }
 /*-----------------------------------------------------------*/
 
-static void prvInsertBlockIntoFreeList( BlockLink_t * pxBlockToInsert ) /* PRIVILEGED_FUNCTION */
+static size_t prvAlignedLeadSize( BlockLink_t * pxBlock, size_t xAlignment ) /* PRIVILEGED_FUNCTION */
+{
+    size_t uxAddress = ( ( size_t ) pxBlock ) + xHeapStructSize;
+    size_t xLeadSize = ( ( uxAddress + ( xAlignment - 1 ) ) & ~( xAlignment - 1 ) ) - uxAddress;
+
+    /* A lead that is not large enough to be a free block of its own is moved
+     * to the next aligned address after the smallest block. */
+    if( ( xLeadSize != 0 ) && ( xLeadSize < heapMINIMUM_BLOCK_SIZE ) )
+    {
+        uxAddress += heapMINIMUM_BLOCK_SIZE;
+        xLeadSize = heapMINIMUM_BLOCK_SIZE +
+                    ( ( ( uxAddress + ( xAlignment - 1 ) ) & ~( xAlignment - 1 ) ) - uxAddress );
+    }
+
+    return xLeadSize;
+}
+/*-----------------------------------------------------------*/
+
+static void prvInsertBlockIntoFreeList( RTLHeap_t * pxHeap, BlockLink_t * pxBlockToInsert ) /* PRIVILEGED_FUNCTION */
 {
     BlockLink_t * pxIterator;
     uint8_t * puc;
 
     /* Iterate through the list until a block is found that has a higher address
      * than the block being inserted. */
-    for( pxIterator = &xStart; pxIterator->pxNextFreeBlock < pxBlockToInsert; pxIterator = pxIterator->pxNextFreeBlock )
+    for( pxIterator = &pxHeap->xStart; pxIterator->pxNextFreeBlock < pxBlockToInsert; pxIterator = pxIterator->pxNextFreeBlock )
     {
         /* Nothing to do here, just iterate to the right position. */
     }
@@ -438,7 +706,7 @@ static void prvInsertBlockIntoFreeList( BlockLink_t * pxBlockToInsert ) /* PRIVI
 
     if( ( puc + pxBlockToInsert->xBlockSize ) == ( uint8_t * ) pxIterator->pxNextFreeBlock )
     {
-        if( pxIterator->pxNextFreeBlock != pxEnd )
+        if( pxIterator->pxNextFreeBlock != pxHeap->pxEnd )
         {
             /* Form one big block from the two blocks. */
             pxBlockToInsert->xBlockSize += pxIterator->pxNextFreeBlock->xBlockSize;
@@ -446,7 +714,7 @@ static void prvInsertBlockIntoFreeList( BlockLink_t * pxBlockToInsert ) /* PRIVI
         }
         else
         {
-            pxBlockToInsert->pxNextFreeBlock = pxEnd;
+            pxBlockToInsert->pxNextFreeBlock = pxHeap->pxEnd;
         }
     }
     else
@@ -468,3 +736,153 @@ static void prvInsertBlockIntoFreeList( BlockLink_t * pxBlockToInsert ) /* PRIVI
     }
 }
 /*-----------------------------------------------------------*/
+
+
+#if !configRTL_HEAP_TLSF
+
+void * pvRTLMalloc( size_t xWantedSize )
+{
+    void * pvReturn = prvHeapMalloc( &xRTLHeap, xWantedSize );
+
+    #if ( configUSE_MALLOC_FAILED_HOOK == 1 )
+        {
+            if( pvReturn == NULL )
+            {
+                extern void vApplicationMallocFailedHook( void );
+                vApplicationMallocFailedHook();
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+    #endif /* if ( configUSE_MALLOC_FAILED_HOOK == 1 ) */
+
+    return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void * pvRTLMallocAligned( size_t xWantedSize, size_t xAlignment )
+{
+    void * pvReturn = prvHeapMallocAligned( &xRTLHeap, xWantedSize, xAlignment );
+
+    #if ( configUSE_MALLOC_FAILED_HOOK == 1 )
+        {
+            if( pvReturn == NULL )
+            {
+                extern void vApplicationMallocFailedHook( void );
+                vApplicationMallocFailedHook();
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+    #endif /* if ( configUSE_MALLOC_FAILED_HOOK == 1 ) */
+
+    return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vRTLFree( void * pv )
+{
+    prvHeapFree( &xRTLHeap, pv );
+}
+/*-----------------------------------------------------------*/
+
+size_t xRTLtGetFreeHeapSize( void )
+{
+    return xRTLHeap.xFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+void vRTLInitialiseBlocks( void )
+{
+    /* The heap is otherwise initialised by the first allocation. */
+    vTaskSuspendAll();
+    {
+        if( xRTLHeap.pxEnd == NULL )
+        {
+            prvHeapInit( &xRTLHeap );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    ( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+void vRTLGetHeapStats( HeapStats_t * pxHeapStats )
+{
+    prvHeapGetStats( &xRTLHeap, pxHeapStats );
+}
+/*-----------------------------------------------------------*/
+
+#endif /* !configRTL_HEAP_TLSF */
+
+RTLHeapHandle_t xRTLHeapCreate( void * pvMemory, size_t xSize )
+{
+    RTLHeap_t * pxHeap;
+    uint8_t * puc = ( uint8_t * ) pvMemory;
+    size_t uxAddress = ( size_t ) pvMemory;
+
+    /* The control structure is placed at the first aligned address. */
+    if( ( uxAddress & portBYTE_ALIGNMENT_MASK ) != 0 )
+    {
+        uxAddress += ( portBYTE_ALIGNMENT - 1 );
+        uxAddress &= ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    /* There must be room for the control structure, the end marker and a
+     * block once the memory is aligned. */
+    if( ( pvMemory == NULL ) ||
+        ( xSize < ( ( uxAddress - ( size_t ) pvMemory ) + xHeapControlSize + ( 2 * heapMINIMUM_BLOCK_SIZE ) ) ) )
+    {
+        return NULL;
+    }
+
+    pxHeap = ( void * ) ( puc + ( uxAddress - ( size_t ) pvMemory ) );
+    pxHeap->pucHeap = ( ( uint8_t * ) pxHeap ) + xHeapControlSize;
+    pxHeap->xHeapSize = xSize - ( uxAddress - ( size_t ) pvMemory ) - xHeapControlSize;
+    pxHeap->xNumberOfSuccessfulAllocations = 0;
+    pxHeap->xNumberOfSuccessfulFrees = 0;
+
+    vTaskSuspendAll();
+    {
+        prvHeapInit( pxHeap );
+    }
+    ( void ) xTaskResumeAll();
+
+    return pxHeap;
+}
+/*-----------------------------------------------------------*/
+
+void * pvRTLHeapMallocAligned( RTLHeapHandle_t xHeap, size_t xWantedSize, size_t xAlignment )
+{
+    return prvHeapMallocAligned( xHeap, xWantedSize, xAlignment );
+}
+/*-----------------------------------------------------------*/
+
+void vRTLHeapFree( RTLHeapHandle_t xHeap, void * pv )
+{
+    prvHeapFree( xHeap, pv );
+}
+/*-----------------------------------------------------------*/
+
+size_t xRTLHeapGetFreeSize( RTLHeapHandle_t xHeap )
+{
+    return xHeap->xFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+void vRTLHeapGetStats( RTLHeapHandle_t xHeap, HeapStats_t * pxHeapStats )
+{
+    prvHeapGetStats( xHeap, pxHeapStats );
+}
+/*-----------------------------------------------------------*/
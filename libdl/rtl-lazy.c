@@ -0,0 +1,252 @@
+/*
+ *  The license and distribution terms for this file may be
+ *  found in the file LICENSE in this distribution or at
+ *  http://www.rtems.org/license/LICENSE.
+ */
+/**
+ * @file
+ *
+ * @ingroup rtems_rtl
+ *
+ * @brief RTEMS Run-Time Linker Lazy Binding
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rtl/rtl.h>
+#include <rtl/rtl-obj.h>
+#include <rtl/rtl-sym.h>
+#include <rtl/rtl-trace.h>
+#include "rtl-elf.h"
+#include "rtl-error.h"
+#include "rtl-lazy.h"
+
+#include <FreeRTOS.h>
+#include "list.h"
+#include "task.h"
+
+/**
+ * A lazy binding slot. The stub is allocated as executable memory and holds
+ * the stub's code and target. The slot is the object file's metadata and is
+ * allocated from the object file's arena. The stub is all the binder is given
+ * so the slot is found from the stub.
+ */
+typedef struct rtems_rtl_lazy_slot
+{
+  ListItem_t     node;   /**< The slot's node in the object file's list. */
+  rtems_rtl_obj* obj;    /**< The object file calling the function. */
+  void*          stub;   /**< The stub the calls are relocated to. */
+  void*          target; /**< The bound function. NULL until bound. */
+  const char*    name;   /**< The function's name. */
+} rtems_rtl_lazy_slot;
+
+static rtems_rtl_lazy_slot*
+rtems_rtl_lazy_slot_in (List_t* objects, void* stub)
+{
+  ListItem_t* onode = listGET_HEAD_ENTRY (objects);
+  while (listGET_END_MARKER (objects) != onode)
+  {
+    rtems_rtl_obj* obj = (rtems_rtl_obj*) onode;
+    ListItem_t*    node = listGET_HEAD_ENTRY (&obj->lazy_list);
+    while (listGET_END_MARKER (&obj->lazy_list) != node)
+    {
+      rtems_rtl_lazy_slot* slot = (rtems_rtl_lazy_slot*) node;
+      if (slot->stub == stub)
+        return slot;
+      node = listGET_NEXT (node);
+    }
+    onode = listGET_NEXT (onode);
+  }
+  return NULL;
+}
+
+/**
+ * Find the slot of a stub. A stub is bound once so the search is only made
+ * the first time a function is called.
+ */
+static rtems_rtl_lazy_slot*
+rtems_rtl_lazy_slot_get (void* stub)
+{
+  rtems_rtl_lazy_slot* slot;
+  slot = rtems_rtl_lazy_slot_in (rtems_rtl_objects_unprotected (), stub);
+  if (slot == NULL)
+    slot = rtems_rtl_lazy_slot_in (rtems_rtl_pending_unprotected (), stub);
+  return slot;
+}
+
+/**
+ * A call to a function that could not be found lands here. There is nothing
+ * to return to so the calling task stops. The binder has printed the
+ * function and object file and set the error. The stub is not bound so a
+ * later call binds it if the function has been loaded.
+ */
+static void
+rtems_rtl_lazy_unresolved (void)
+{
+  configASSERT (0);
+  vTaskSuspend (NULL);
+}
+
+bool
+rtems_rtl_lazy_reloc (rtems_rtl_obj* obj, uint32_t type)
+{
+  return (obj->flags & RTEMS_RTL_OBJ_LAZY) != 0 &&
+    rtems_rtl_elf_lazy_stub_size () != 0 &&
+    rtems_rtl_elf_rel_lazy (type);
+}
+
+void*
+rtems_rtl_lazy_stub (rtems_rtl_obj* obj, const char* name)
+{
+  rtems_rtl_lazy_slot* slot;
+  ListItem_t*          node;
+  void*                stub;
+
+  node = listGET_HEAD_ENTRY (&obj->lazy_list);
+  while (listGET_END_MARKER (&obj->lazy_list) != node)
+  {
+    slot = (rtems_rtl_lazy_slot*) node;
+    if (strcmp (slot->name, name) == 0)
+      return slot->stub;
+    node = listGET_NEXT (node);
+  }
+
+  slot = rtems_rtl_arena_alloc (&obj->arena, sizeof (rtems_rtl_lazy_slot), true);
+  if (slot != NULL)
+    slot->name = rtems_rtl_arena_strdup (&obj->arena, name);
+  if (slot == NULL || slot->name == NULL)
+  {
+    rtems_rtl_set_error (ENOMEM, "no memory for lazy binding slot");
+    return NULL;
+  }
+
+  stub = rtems_rtl_alloc_new (RTEMS_RTL_ALLOC_READ_EXEC,
+                              rtems_rtl_elf_lazy_stub_size (),
+                              true);
+  if (stub == NULL)
+  {
+    rtems_rtl_set_error (ENOMEM, "no memory for lazy binding stub");
+    return NULL;
+  }
+
+  rtems_rtl_alloc_wr_enable (RTEMS_RTL_ALLOC_READ_EXEC, stub);
+  rtems_rtl_elf_lazy_stub_init (stub);
+  rtems_rtl_alloc_wr_disable (RTEMS_RTL_ALLOC_READ_EXEC, stub);
+  rtems_rtl_elf_lazy_stub_sync (stub);
+
+  slot->obj = obj;
+  slot->stub = stub;
+  slot->target = NULL;
+
+  vListInitialiseItem (&slot->node);
+  vListInsertEnd (&obj->lazy_list, &slot->node);
+
+  if (rtems_rtl_trace (RTEMS_RTL_TRACE_RELOC))
+    printf ("rtl: lazy: stub: %s: %s=%p\n",
+            rtems_rtl_obj_oname (obj), name, (void*) stub);
+
+  return stub;
+}
+
+void*
+rtems_rtl_lazy_bind (void* stub)
+{
+  rtems_rtl_lazy_slot* slot;
+  const char*          name = NULL;
+  void*                target = NULL;
+
+  rtems_rtl_lock ();
+
+  slot = rtems_rtl_lazy_slot_get (stub);
+
+  /*
+   * Another task may have bound the slot while this task waited for the
+   * lock.
+   */
+  if (slot != NULL && slot->target == NULL)
+  {
+    rtems_rtl_obj*     sobj = NULL;
+    rtems_rtl_obj_sym* sym;
+
+    /*
+     * The object file and the base image are searched first. A function in
+     * another object file is found in that object file's globals and the
+     * object file is loaded from the archives if it is not loaded.
+     */
+    sym = rtems_rtl_symbol_obj_find (slot->obj, slot->name);
+    if (sym == NULL)
+    {
+      sobj = rtems_rtl_find_obj_with_symbol_for (slot->name, slot->obj);
+      if (sobj == NULL)
+        sobj = rtems_rtl_load_symbol (slot->name, slot->obj);
+      if (sobj != NULL)
+        sym = rtems_rtl_gsymbol_obj_find (sobj, slot->name);
+    }
+
+    if (sym != NULL)
+    {
+      if (rtems_rtl_trace (RTEMS_RTL_TRACE_DEPENDENCY))
+        printf ("rtl: depend: %s -> %s:%s\n",
+                slot->obj->oname,
+                sobj == NULL ? "not-found" : sobj->oname,
+                slot->name);
+
+      if (sobj != NULL)
+      {
+        if (rtems_rtl_obj_add_dependent (slot->obj, sobj))
+          rtems_rtl_obj_inc_reference (sobj);
+      }
+
+      slot->target = (void*) sym->value;
+
+      rtems_rtl_alloc_wr_enable (RTEMS_RTL_ALLOC_READ_EXEC, stub);
+      rtems_rtl_elf_lazy_stub_set (stub, slot->target);
+      rtems_rtl_alloc_wr_disable (RTEMS_RTL_ALLOC_READ_EXEC, stub);
+      rtems_rtl_elf_lazy_stub_sync (stub);
+    }
+  }
+
+  if (slot != NULL)
+  {
+    name = slot->name;
+    target = slot->target;
+  }
+
+  if (target == NULL)
+  {
+    /*
+     * The calling task is suspended so always report the call. The assert
+     * is not built in a release build.
+     */
+    rtems_rtl_set_error (ENOENT, "lazy bind: unresolved: %s",
+                         name == NULL ? "no slot" : name);
+    printf ("rtl: lazy: unresolved: %s: %s\n",
+            slot == NULL ? "not-found" : rtems_rtl_obj_oname (slot->obj),
+            name == NULL ? "no slot" : name);
+    rtems_rtl_unlock ();
+    return (void*) rtems_rtl_lazy_unresolved;
+  }
+
+  if (rtems_rtl_trace (RTEMS_RTL_TRACE_UNRESOLVED))
+    printf ("rtl: lazy: bind: %s: %s=%p\n",
+            rtems_rtl_obj_oname (slot->obj), name, target);
+
+  rtems_rtl_unlock ();
+
+  return target;
+}
+
+void
+rtems_rtl_lazy_erase (rtems_rtl_obj* obj)
+{
+  ListItem_t* node = listGET_HEAD_ENTRY (&obj->lazy_list);
+  while (listGET_END_MARKER (&obj->lazy_list) != node)
+  {
+    rtems_rtl_lazy_slot* slot = (rtems_rtl_lazy_slot*) node;
+    node = listGET_NEXT (node);
+    uxListRemove (&slot->node);
+    rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_READ_EXEC, slot->stub);
+  }
+}
@@ -0,0 +1,80 @@
+/*
+ *  The license and distribution terms for this file may be
+ *  found in the file LICENSE in this distribution or at
+ *  http://www.rtems.org/license/LICENSE.
+ */
+/**
+ * @file
+ *
+ * @ingroup rtems_rtl
+ *
+ * @brief RTEMS Run-Time Linker Lazy Binding.
+ *
+ * An object file loaded with RTLD_LAZY does not resolve a call to a function
+ * that cannot be found when it is relocated. The call is relocated to a stub
+ * in a lazy binding slot. The slot's stub calls the binder the first time it
+ * is called. The binder finds the function, loading it from the archives if
+ * needed, and sets the stub's target so later calls jump straight to the
+ * function. There is a slot for each function an object file calls lazily.
+ *
+ * The stub is executable memory holding the stub's code and the target it
+ * loads. The code is written when the slot is created and is not changed.
+ * Binding only writes the target. The slot's details are in the object
+ * file's arena.
+ */
+
+#if !defined (_RTEMS_RTL_LAZY_H_)
+#define _RTEMS_RTL_LAZY_H_
+
+#include <stdbool.h>
+
+#include <rtl/rtl-obj.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Check if a relocation record of an object file can be bound lazily.
+ *
+ * @param obj The object file being relocated.
+ * @param type The type field in the relocation record.
+ * @retval true The relocation record can reference a lazy binding stub.
+ * @retval false The relocation record has to be resolved.
+ */
+bool rtems_rtl_lazy_reloc (rtems_rtl_obj* obj, uint32_t type);
+
+/**
+ * Get the lazy binding stub for a function an object file calls. A slot is
+ * created the first time the function is referenced.
+ *
+ * @param obj The object file calling the function.
+ * @param name The function's name.
+ * @return void* The stub. NULL is returned if there is no memory and the
+ *               error is set.
+ */
+void* rtems_rtl_lazy_stub (rtems_rtl_obj* obj, const char* name);
+
+/**
+ * Bind a lazy binding stub. This is called by the architecture's lazy
+ * binding entry the first time a stub is called. The RTL is locked and
+ * object files can be loaded from the archives so the call has to be made
+ * from a task.
+ *
+ * @param stub The stub being called.
+ * @return void* The function to call.
+ */
+void* rtems_rtl_lazy_bind (void* stub);
+
+/**
+ * Erase the lazy binding slots of an object file.
+ *
+ * @param obj The object file.
+ */
+void rtems_rtl_lazy_erase (rtems_rtl_obj* obj);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif
@@ -69,15 +69,12 @@ typedef struct rela_hi20 {
 } hi20_reloc_t;
 
 static List_t hi20_relocs;
-static int hi20_init = 0;
 
 typedef struct rela_hi20_table {
   List_t      *buckets;
   size_t      nbuckets;
 } hi20_relocs_t;
 
-static hi20_relocs_t hi20_relocs_table;
-
 static uint_fast32_t
 rtems_hi20_hash (const intptr_t hi20_pc)
 {
@@ -94,14 +91,16 @@ rtems_rtl_hi20_insert (hi20_relocs_t*     relocs,
 }
 
 static hi20_reloc_t*
-rtems_rtl_hi20_find (intptr_t hi20_pc)
+rtems_rtl_hi20_find (rtems_rtl_obj* obj, intptr_t hi20_pc)
 {
   hi20_relocs_t*       relocs;
   uint_fast32_t        hash;
   List_t*              bucket;
   ListItem_t*          node;
 
-  relocs = &hi20_relocs_table;
+  relocs = obj->reloc_state;
+  if (relocs == NULL)
+    return NULL;
 
   hash = rtems_hi20_hash (hi20_pc);
   bucket = &relocs->buckets[hash % relocs->nbuckets];
@@ -122,14 +121,17 @@ rtems_rtl_hi20_find (intptr_t hi20_pc)
 }
 
 static hi20_reloc_t*
-rtems_rtl_hi20_find_symvalue (Elf_Word symvalue)
+rtems_rtl_hi20_find_symvalue (rtems_rtl_obj* obj, Elf_Word symvalue)
 {
   hi20_relocs_t*       relocs;
   List_t*              bucket;
   ListItem_t*          node;
 
-  relocs = &hi20_relocs_table;
-  size_t nbuckets = hi20_relocs_table.nbuckets;
+  relocs = obj->reloc_state;
+  if (relocs == NULL)
+    return NULL;
+
+  size_t nbuckets = relocs->nbuckets;
 
 
   for (int i = 0; i < nbuckets; i ++) {
@@ -152,17 +154,14 @@ rtems_rtl_hi20_find_symvalue (Elf_Word symvalue)
 }
 
 static bool
-rtems_rtl_hi20_table_open (hi20_relocs_t      *relocs,
+rtems_rtl_hi20_table_open (rtems_rtl_obj*     obj,
+                           hi20_relocs_t      *relocs,
                            size_t             buckets)
 {
-  relocs->buckets = rtems_rtl_alloc_new (RTEMS_RTL_ALLOC_SYMBOL,
-                                          buckets * sizeof (List_t),
-                                          true);
+  relocs->buckets = rtems_rtl_arena_alloc (&obj->reloc_arena,
+                                           buckets * sizeof (List_t), true);
   if (!relocs->buckets)
-  {
-    rtems_rtl_set_error (ENOMEM, "no memory for hi20 relocs table");
     return false;
-  }
   relocs->nbuckets = buckets;
 
   for (buckets = 0; buckets < relocs->nbuckets; ++buckets)
@@ -171,6 +170,40 @@ rtems_rtl_hi20_table_open (hi20_relocs_t      *relocs,
   return true;
 }
 
+/*
+ * Allocate a hi20 reloc and add it to the object file's hi20 table. The table
+ * is the object file's relocation state. It is opened with the first hi20
+ * reloc and held until all the object file's relocations are resolved
+ * because an unresolved hi20 reloc can be resolved by a later load.
+ */
+static hi20_reloc_t*
+rtems_rtl_hi20_new (rtems_rtl_obj* obj)
+{
+  hi20_relocs_t* relocs = obj->reloc_state;
+  hi20_reloc_t*  reloc;
+
+  if (relocs == NULL) {
+    relocs = rtems_rtl_arena_alloc (&obj->reloc_arena, sizeof (hi20_relocs_t), true);
+    if (relocs == NULL ||
+        !rtems_rtl_hi20_table_open (obj, relocs, RTL_RISCV_HI20_HASHTABLE_BUCKETS)) {
+      rtems_rtl_set_error (ENOMEM, "no memory for hi20 relocs table");
+      return NULL;
+    }
+    obj->reloc_state = relocs;
+  }
+
+  reloc = rtems_rtl_arena_alloc (&obj->reloc_arena, sizeof(hi20_reloc_t), true);
+  if (reloc == NULL) {
+    rtems_rtl_set_error (ENOMEM, "no memory for hi20 reloc");
+    return NULL;
+  }
+
+  vListInitialiseItem(&reloc->node);
+  rtems_rtl_hi20_insert(relocs, reloc);
+
+  return reloc;
+}
+
 #if 0
 static void
 rtems_rtl_elf_relocate_riscv_hi20_add (Elf_Word symvalue, Elf_Word *pc, bool is_cap, Elf_Word cap_addr, bool is_func) {
@@ -245,11 +278,7 @@ rtems_rtl_elf_arch_parse_section (const rtems_rtl_obj* obj,
   (void) shdr;
 
   if ((flags & RTEMS_RTL_OBJ_SECT_RELA) == RTEMS_RTL_OBJ_SECT_RELA) {
-    if (!hi20_init) {
-      rtems_rtl_hi20_table_open(&hi20_relocs_table, RTL_RISCV_HI20_HASHTABLE_BUCKETS);
-      //vListInitialise (&hi20_relocs);
-      hi20_init = 1;
-    }
+    //vListInitialise (&hi20_relocs);
   }
 
   return flags;
@@ -284,6 +313,176 @@ rtems_rtl_elf_relocate_tramp_max_size (void) {
   return 0;
 }
 
+/*
+ * Lazy binding is not supported with compartments. A call between
+ * compartments is relocated to a compartment switch trampoline.
+ */
+#if !defined (__CHERI_PURE_CAPABILITY__) && \
+    !configCHERI_COMPARTMENTALIZATION && !configMPU_COMPARTMENTALIZATION
+#define RTEMS_RTL_RISCV_LAZY 1
+#else
+#define RTEMS_RTL_RISCV_LAZY 0
+#endif
+
+#if RTEMS_RTL_RISCV_LAZY
+/*
+ * The lazy binding stub loads its target and jumps to it. The jump's link
+ * register is t1 so the lazy entry can find the stub. The target is the lazy
+ * entry until the stub is bound:
+ *
+ *   auipc  t3, 0
+ *   l[w|d] t3, 16(t3)
+ *   jalr   t1, t3
+ *   nop
+ *   .[d]word target
+ *
+ * The same registers are used by the PLT of the RISC-V psABI. They are
+ * temporaries that are not preserved across a call.
+ */
+#define RTEMS_RTL_RISCV_LAZY_STUB_SIZE (24)
+#define RTEMS_RTL_RISCV_LAZY_TARGET    (16)
+
+#if __riscv_xlen == 64
+#define RTEMS_RTL_RISCV_LAZY_LOAD      (0x010e3e03) /* ld t3, 16(t3) */
+#define RTEMS_RTL_RISCV_SREG           "sd"
+#define RTEMS_RTL_RISCV_LREG           "ld"
+#else
+#define RTEMS_RTL_RISCV_LAZY_LOAD      (0x010e2e03) /* lw t3, 16(t3) */
+#define RTEMS_RTL_RISCV_SREG           "sw"
+#define RTEMS_RTL_RISCV_LREG           "lw"
+#endif
+
+#if defined (__riscv_flen) && __riscv_flen == 64
+#define RTEMS_RTL_RISCV_FSAVE(_r, _o)  "  fsd " _r ", " _o "(sp)\n"
+#define RTEMS_RTL_RISCV_FLOAD(_r, _o)  "  fld " _r ", " _o "(sp)\n"
+#elif defined (__riscv_flen) && __riscv_flen == 32
+#define RTEMS_RTL_RISCV_FSAVE(_r, _o)  "  fsw " _r ", " _o "(sp)\n"
+#define RTEMS_RTL_RISCV_FLOAD(_r, _o)  "  flw " _r ", " _o "(sp)\n"
+#else
+#define RTEMS_RTL_RISCV_FSAVE(_r, _o)  ""
+#define RTEMS_RTL_RISCV_FLOAD(_r, _o)  ""
+#endif
+
+#define RTEMS_RTL_RISCV_SAVE(_r, _o)   "  " RTEMS_RTL_RISCV_SREG " " _r ", " _o "(sp)\n"
+#define RTEMS_RTL_RISCV_LOAD(_r, _o)   "  " RTEMS_RTL_RISCV_LREG " " _r ", " _o "(sp)\n"
+
+/*
+ * The lazy entry saves the argument registers, binds the stub and jumps to
+ * the bound function with the caller's arguments and return address. The
+ * stub is 12 bytes before the link in t1. Each register has an 8 byte slot
+ * in the frame.
+ */
+void rtems_rtl_riscv_lazy_entry (void);
+
+__asm__ (
+  "  .text\n"
+  "  .align 2\n"
+  "  .globl rtems_rtl_riscv_lazy_entry\n"
+  "  .type  rtems_rtl_riscv_lazy_entry, @function\n"
+  "rtems_rtl_riscv_lazy_entry:\n"
+  "  addi sp, sp, -144\n"
+  RTEMS_RTL_RISCV_SAVE ("ra", "0")
+  RTEMS_RTL_RISCV_SAVE ("a0", "8")
+  RTEMS_RTL_RISCV_SAVE ("a1", "16")
+  RTEMS_RTL_RISCV_SAVE ("a2", "24")
+  RTEMS_RTL_RISCV_SAVE ("a3", "32")
+  RTEMS_RTL_RISCV_SAVE ("a4", "40")
+  RTEMS_RTL_RISCV_SAVE ("a5", "48")
+  RTEMS_RTL_RISCV_SAVE ("a6", "56")
+  RTEMS_RTL_RISCV_SAVE ("a7", "64")
+  RTEMS_RTL_RISCV_FSAVE ("fa0", "72")
+  RTEMS_RTL_RISCV_FSAVE ("fa1", "80")
+  RTEMS_RTL_RISCV_FSAVE ("fa2", "88")
+  RTEMS_RTL_RISCV_FSAVE ("fa3", "96")
+  RTEMS_RTL_RISCV_FSAVE ("fa4", "104")
+  RTEMS_RTL_RISCV_FSAVE ("fa5", "112")
+  RTEMS_RTL_RISCV_FSAVE ("fa6", "120")
+  RTEMS_RTL_RISCV_FSAVE ("fa7", "128")
+  "  addi a0, t1, -12\n"
+  "  call rtems_rtl_lazy_bind\n"
+  "  mv   t3, a0\n"
+  RTEMS_RTL_RISCV_LOAD ("ra", "0")
+  RTEMS_RTL_RISCV_LOAD ("a0", "8")
+  RTEMS_RTL_RISCV_LOAD ("a1", "16")
+  RTEMS_RTL_RISCV_LOAD ("a2", "24")
+  RTEMS_RTL_RISCV_LOAD ("a3", "32")
+  RTEMS_RTL_RISCV_LOAD ("a4", "40")
+  RTEMS_RTL_RISCV_LOAD ("a5", "48")
+  RTEMS_RTL_RISCV_LOAD ("a6", "56")
+  RTEMS_RTL_RISCV_LOAD ("a7", "64")
+  RTEMS_RTL_RISCV_FLOAD ("fa0", "72")
+  RTEMS_RTL_RISCV_FLOAD ("fa1", "80")
+  RTEMS_RTL_RISCV_FLOAD ("fa2", "88")
+  RTEMS_RTL_RISCV_FLOAD ("fa3", "96")
+  RTEMS_RTL_RISCV_FLOAD ("fa4", "104")
+  RTEMS_RTL_RISCV_FLOAD ("fa5", "112")
+  RTEMS_RTL_RISCV_FLOAD ("fa6", "120")
+  RTEMS_RTL_RISCV_FLOAD ("fa7", "128")
+  "  addi sp, sp, 144\n"
+  "  jr   t3\n"
+  "  .size  rtems_rtl_riscv_lazy_entry, . - rtems_rtl_riscv_lazy_entry\n");
+#endif
+
+size_t
+rtems_rtl_elf_lazy_stub_size (void) {
+#if RTEMS_RTL_RISCV_LAZY
+  return RTEMS_RTL_RISCV_LAZY_STUB_SIZE;
+#else
+  /*
+   * Disable by returning 0.
+   */
+  return 0;
+#endif
+}
+
+bool
+rtems_rtl_elf_rel_lazy (Elf_Word type) {
+  return type == R_TYPE(CALL) || type == R_TYPE(CALL_PLT);
+}
+
+void
+rtems_rtl_elf_lazy_stub_init (void* stub) {
+#if RTEMS_RTL_RISCV_LAZY
+  uint32_t* code = (uint32_t*) stub;
+  code[0] = 0x00000e17; /* auipc t3, 0 */
+  code[1] = RTEMS_RTL_RISCV_LAZY_LOAD;
+  code[2] = 0x000e0367; /* jalr t1, t3 */
+  code[3] = 0x00000013; /* nop */
+  rtems_rtl_elf_lazy_stub_set (stub, (void*) rtems_rtl_riscv_lazy_entry);
+#else
+  (void) stub;
+#endif
+}
+
+void
+rtems_rtl_elf_lazy_stub_set (void* stub, void* target) {
+#if RTEMS_RTL_RISCV_LAZY
+  /*
+   * The stub loads the target with a single load so a call in another task
+   * sees the lazy entry or the function.
+   */
+  volatile uintptr_t* slot;
+  slot = (volatile uintptr_t*) (((uint8_t*) stub) + RTEMS_RTL_RISCV_LAZY_TARGET);
+  *slot = (uintptr_t) target;
+#else
+  (void) stub;
+  (void) target;
+#endif
+}
+
+void
+rtems_rtl_elf_lazy_stub_sync (void* stub) {
+#if RTEMS_RTL_RISCV_LAZY
+  /*
+   * The fence.i is encoded so the assembler does not need Zifencei.
+   */
+  (void) stub;
+  __asm__ volatile (".word 0x0000100f" : : : "memory"); /* fence.i */
+#else
+  (void) stub;
+#endif
+}
+
 rtems_rtl_elf_rel_status
 rtems_rtl_elf_relocate_rel_tramp (rtems_rtl_obj*            obj,
                                   const Elf_Rel*            rel,
@@ -374,13 +573,18 @@ rtems_rtl_elf_reloc_rela (rtems_rtl_obj*            obj,
       Elf_Word return_sym;
       intptr_t hi20_rela_pc =  ((intptr_t) where) + pcrel_val;
 
-      ret_reloc = rtems_rtl_hi20_find(hi20_rela_pc);
+      ret_reloc = rtems_rtl_hi20_find(obj, hi20_rela_pc);
       if (!ret_reloc) {
+        /*
+         * The HI20 relocation is not resolved yet. The LO12 relocations are
+         * applied again when the object file's externals are resolved.
+         */
+        if (obj->unresolved != 0)
+          return rtems_rtl_elf_rel_no_error;
         rtems_rtl_set_error (EINVAL,
                            "%s: Failed to find HI20 relocation for type %d",
                            sect->name, (uint32_t) ELF_R_TYPE(rela->r_info));
         return rtems_rtl_elf_rel_failure;
-          return rtems_rtl_elf_rel_no_error;
       } else {
         return_sym = ret_reloc->symvalue;
         pcrel_val = return_sym - ((Elf_Word) hi20_rela_pc);
@@ -398,8 +602,14 @@ rtems_rtl_elf_reloc_rela (rtems_rtl_obj*            obj,
       Elf_Word return_sym;
       intptr_t hi20_rela_pc =  ((intptr_t) where) + pcrel_val;
 
-      ret_reloc = rtems_rtl_hi20_find(hi20_rela_pc);
+      ret_reloc = rtems_rtl_hi20_find(obj, hi20_rela_pc);
       if (!ret_reloc) {
+        /*
+         * The HI20 relocation is not resolved yet. The LO12 relocations are
+         * applied again when the object file's externals are resolved.
+         */
+        if (obj->unresolved != 0)
+          return rtems_rtl_elf_rel_no_error;
         rtems_rtl_set_error (EINVAL,
                            "%s: Failed to find HI20 relocation for type %d",
                            sect->name, (uint32_t) ELF_R_TYPE(rela->r_info));
@@ -636,14 +846,13 @@ rtems_rtl_elf_reloc_rela (rtems_rtl_obj*            obj,
     int64_t hi = SignExtend64(pcrel_val + 0x800, bits); //pcrel_val + 0x800;
     write32le(where, (read32le(where) & 0xFFF) | (hi & 0xFFFFF000));
 
-    hi20_reloc_t *hi20_reloc =  rtems_rtl_alloc_new (RTEMS_RTL_ALLOC_OBJECT, sizeof(hi20_reloc_t), true);
-    vListInitialiseItem(&hi20_reloc->node);
+    hi20_reloc_t *hi20_reloc = rtems_rtl_hi20_new (obj);
+    if (hi20_reloc == NULL)
+      return rtems_rtl_elf_rel_failure;
 
     hi20_reloc->symvalue = symvalue;
     hi20_reloc->hi20_pc = (intptr_t) where;
 
-    rtems_rtl_hi20_insert(&hi20_relocs_table, hi20_reloc);
-
   }
   break;
 
@@ -673,15 +882,14 @@ rtems_rtl_elf_reloc_rela (rtems_rtl_obj*            obj,
           return rtems_rtl_elf_rel_failure;
         } else {
           // printf("Detected a function pointer %s\n", symname);
-          hi20_reloc_t *hi20_reloc =  rtems_rtl_alloc_new (RTEMS_RTL_ALLOC_OBJECT, sizeof(hi20_reloc_t), true);
-          vListInitialiseItem(&hi20_reloc->node);
+          hi20_reloc_t *hi20_reloc = rtems_rtl_hi20_new (obj);
+          if (hi20_reloc == NULL)
+            return rtems_rtl_elf_rel_failure;
 
           hi20_reloc->symvalue = symvalue;
           hi20_reloc->hi20_tramp = tramp_cap;
           hi20_reloc->hi20_pc = (intptr_t) where;
 
-          rtems_rtl_hi20_insert(&hi20_relocs_table, hi20_reloc);
-
           symvalue = (size_t) tramp_cap;
         }
     }
@@ -700,7 +908,7 @@ rtems_rtl_elf_reloc_rela (rtems_rtl_obj*            obj,
     if (rtl_sym) {
 
       if (ELF_ST_TYPE(rtl_sym->data >> 16) == STT_FUNC) {
-        hi20_reloc_t *ret_reloc = rtems_rtl_hi20_find_symvalue(symvalue);
+        hi20_reloc_t *ret_reloc = rtems_rtl_hi20_find_symvalue(obj, symvalue);
         if (ret_reloc) {
           //printf("LO12_I function pointer detected %s \n", symname);
           symvalue = ret_reloc->hi20_tramp;
@@ -724,7 +932,7 @@ rtems_rtl_elf_reloc_rela (rtems_rtl_obj*            obj,
     rtems_rtl_obj_sym* rtl_sym = rtems_rtl_symbol_obj_find(obj, symname);
     if (rtl_sym) {
       if (ELF_ST_TYPE(rtl_sym->data >> 16) == STT_FUNC) {
-        hi20_reloc_t *ret_reloc = rtems_rtl_hi20_find_symvalue(symvalue);
+        hi20_reloc_t *ret_reloc = rtems_rtl_hi20_find_symvalue(obj, symvalue);
         if (ret_reloc) {
           //printf("LO12_S function pointer detected %s\n", symname);
           symvalue = ret_reloc->hi20_tramp;
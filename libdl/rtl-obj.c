@@ -29,6 +29,7 @@
 #include <rtl/rtl-obj.h>
 #include "rtl-error.h"
 #include "rtl-find-file.h"
+#include "rtl-lazy.h"
 #include "rtl-string.h"
 #include <rtl/rtl-trace.h>
 #include <rtl/rtl-freertos-compartments.h>
@@ -80,12 +81,35 @@ rtems_rtl_obj_alloc (void)
     vListInitialise (&obj->locals_list);
     vListInitialise (&obj->interface_list);
     vListInitialise (&obj->externals_list);
+    vListInitialise (&obj->lazy_list);
+
+    /*
+     * The object file is in the load group of the load it is loaded in.
+     */
+    if (rtems_rtl_data_unprotected () != NULL)
+      obj->load_group = rtems_rtl_data_unprotected ()->load_group;
 
     /*
      * Initialise the obj link.
      */
     vListInitialiseItem (&obj->link);
 
+    /*
+     * The symbol tables are not movable until they are loaded.
+     */
+    rtems_rtl_alloc_movable_init (&obj->local_movable);
+    rtems_rtl_alloc_movable_init (&obj->global_movable);
+
+    /*
+     * The metadata arena. Nothing is allocated until it is used.
+     */
+    rtems_rtl_arena_init (&obj->arena, RTEMS_RTL_ALLOC_OBJECT, 0);
+
+    /*
+     * The relocation state arena. Released when the relocations are resolved.
+     */
+    rtems_rtl_arena_init (&obj->reloc_arena, RTEMS_RTL_ALLOC_OBJECT, 0);
+
 #if __CHERI_PURE_CAPABILITY__
 #if configCHERI_COMPARTMENTALIZATION_MODE == 1
     obj->captable_free_slot = 1;
@@ -119,18 +143,24 @@ rtems_rtl_obj_free (rtems_rtl_obj* obj)
     return false;
   }
   if (listLIST_ITEM_CONTAINER (&obj->link))
+  {
+    rtems_rtl_write_lock ();
     uxListRemove (&obj->link);
+    rtems_rtl_write_unlock ();
+  }
   rtems_rtl_alloc_module_del (&obj->text_base, &obj->const_base, &obj->eh_base,
-                              &obj->data_base, &obj->bss_base);
+                              &obj->data_base, &obj->bss_base,
+                              (obj->flags & RTEMS_RTL_OBJ_IMAGE) != 0);
   rtems_rtl_obj_erase_sections (obj);
   rtems_rtl_obj_erase_dependents (obj);
   rtems_rtl_symbol_obj_erase (obj);
   rtems_rtl_obj_erase_trampoline (obj);
+  rtems_rtl_lazy_erase (obj);
   rtems_rtl_obj_free_names (obj);
   if (obj->sec_num != NULL)
     vPortFree (obj->sec_num);
-  if (obj->linkmap != NULL)
-    rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_OBJECT, (void*) obj->linkmap);
+  rtems_rtl_arena_release (&obj->reloc_arena);
+  rtems_rtl_arena_release (&obj->arena);
   rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_OBJECT, obj);
   return true;
 }
@@ -383,6 +413,7 @@ rtems_rtl_obj_section_handler (uint32_t                   mask,
     {
       if (!handler (obj, fd, sect, data))
         return false;
+      rtems_rtl_load_work (1);
     }
     node = listGET_NEXT (node);
   }
@@ -442,16 +473,21 @@ rtems_rtl_obj_add_section (rtems_rtl_obj* obj,
 {
   if (size > 0)
   {
-    rtems_rtl_obj_sect* sect = rtems_rtl_alloc_new (RTEMS_RTL_ALLOC_OBJECT,
-                                                    sizeof (rtems_rtl_obj_sect),
-                                                    true);
+    rtems_rtl_obj_sect* sect = rtems_rtl_arena_alloc (&obj->arena,
+                                                      sizeof (rtems_rtl_obj_sect),
+                                                      true);
     if (!sect)
     {
       rtems_rtl_set_error (ENOMEM, "adding allocated section");
       return false;
     }
     sect->section = section;
-    sect->name = rtems_rtl_strdup (name);
+    sect->name = rtems_rtl_arena_strdup (&obj->arena, name);
+    if (!sect->name)
+    {
+      rtems_rtl_set_error (ENOMEM, "adding allocated section name");
+      return false;
+    }
     sect->size = size;
     sect->offset = offset;
     sect->alignment = alignment;
@@ -475,11 +511,11 @@ rtems_rtl_obj_erase_sections (rtems_rtl_obj* obj)
   ListItem_t* node = listGET_HEAD_ENTRY (&obj->sections);
   while (listGET_END_MARKER (&obj->sections) != node)
   {
-    rtems_rtl_obj_sect* sect = (rtems_rtl_obj_sect*) node;
     ListItem_t*   next_node = listGET_NEXT (node);
+    /*
+     * The section and its name are in the object file's arena.
+     */
     uxListRemove (node);
-    rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_OBJECT, (void*) sect->name);
-    rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_OBJECT, sect);
     node = next_node;
   }
 }
@@ -641,11 +677,7 @@ rtems_rtl_obj_alloc_dependents (rtems_rtl_obj* obj, size_t dependents)
 
   size = sizeof (rtems_rtl_obj_depends) + sizeof (rtems_rtl_obj*) * dependents;
 
-  depends = rtems_rtl_alloc_new (RTEMS_RTL_ALLOC_OBJECT,
-                                 size,
-                                 true);
-
-  vListInitialiseItem(&depends->node);
+  depends = rtems_rtl_arena_alloc (&obj->arena, size, true);
 
   if (depends == NULL)
   {
@@ -653,6 +685,7 @@ rtems_rtl_obj_alloc_dependents (rtems_rtl_obj* obj, size_t dependents)
   }
   else
   {
+    vListInitialiseItem(&depends->node);
     depends->dependents = dependents;
     vListInsertEnd (&obj->dependents, &depends->node);
   }
@@ -666,10 +699,11 @@ rtems_rtl_obj_erase_dependents (rtems_rtl_obj* obj)
   ListItem_t* node = listGET_HEAD_ENTRY (&obj->dependents);
   while (listGET_END_MARKER (&obj->dependents) != node)
   {
-    rtems_rtl_obj_depends* depends = (rtems_rtl_obj_depends*) node;
     ListItem_t*      next_node = listGET_NEXT (node);
+    /*
+     * The dependents blocks are in the object file's arena.
+     */
     uxListRemove (node);
-    rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_OBJECT, depends);
     node = next_node;
   }
 }
@@ -913,13 +947,62 @@ bool
 rtems_rtl_obj_post_resolve_reloc (rtems_rtl_obj* obj)
 {
   const char* name = rtems_rtl_obj_aname_valid(obj)? obj->aname : obj->oname;
+  int         fd;
+  bool        ok;
 
-  if (!rtems_rtl_obj_relocate (obj,
-                                open(name, O_RDONLY),
-                                rtems_rtl_elf_relocs_lo12_locator, NULL))
-       return false;
+  /*
+   * The relocations have been applied with all the externals resolved.
+   */
+  if ((obj->flags & RTEMS_RTL_OBJ_RELOC_DONE) != 0)
+    return true;
 
-  return true;
+  /*
+   * Use the archive's file descriptor if the object file is from an
+   * archive. It is open for the load.
+   */
+  if (obj->archive != NULL && rtems_rtl_obj_aname_valid (obj))
+  {
+    fd = rtems_rtl_archive_fd (obj->archive);
+    if (fd < 0)
+    {
+      rtems_rtl_set_error (errno, "opening archive for relocation");
+      return false;
+    }
+
+    ok = rtems_rtl_obj_relocate (obj, fd, rtems_rtl_elf_relocs_lo12_locator, NULL);
+  }
+  else
+  {
+    fd = open (name, O_RDONLY);
+    if (fd < 0)
+    {
+      rtems_rtl_set_error (errno, "opening for object file");
+      return false;
+    }
+
+    ok = rtems_rtl_obj_relocate (obj, fd, rtems_rtl_elf_relocs_lo12_locator, NULL);
+
+    close (fd);
+
+    /*
+     * The file descriptor can be reused so flush the caches.
+     */
+    rtems_rtl_obj_caches_flush ();
+  }
+
+  /*
+   * The relocation state is held until there are no unresolved relocations.
+   * An unresolved relocation can be resolved by a later load and the LO12
+   * relocations are applied again then.
+   */
+  if (ok && obj->unresolved == 0)
+  {
+    rtems_rtl_arena_release (&obj->reloc_arena);
+    obj->reloc_state = NULL;
+    obj->flags |= RTEMS_RTL_OBJ_RELOC_DONE;
+  }
+
+  return ok;
 }
 
 void
@@ -1106,11 +1189,12 @@ rtems_rtl_obj_alloc_sections (rtems_rtl_obj*             obj,
                               rtems_rtl_obj_sect_handler handler,
                               void*                      data)
 {
-  size_t text_size;
-  size_t const_size;
-  size_t eh_size;
-  size_t data_size;
-  size_t bss_size;
+  const rtems_rtl_alloc_placement* placement;
+  size_t                           text_size;
+  size_t                           const_size;
+  size_t                           eh_size;
+  size_t                           data_size;
+  size_t                           bss_size;
 
   text_size  = rtems_rtl_obj_text_size (obj) + rtems_rtl_obj_const_alignment (obj);
   const_size = rtems_rtl_obj_const_size (obj) + rtems_rtl_obj_eh_alignment (obj);
@@ -1146,12 +1230,28 @@ rtems_rtl_obj_alloc_sections (rtems_rtl_obj*             obj,
   /*
    * Let the allocator manage the actual allocation. The user can use the
    * standard heap or provide a specific allocator with memory protection.
+   * The object file remembers if it is a single image so it is freed the
+   * same way.
    */
+  if (rtems_rtl_alloc_module_image ())
+    obj->flags |= RTEMS_RTL_OBJ_IMAGE;
+  else
+    obj->flags &= ~RTEMS_RTL_OBJ_IMAGE;
+
+  /*
+   * A placement for the archive takes precedence over one for the object.
+   */
+  placement = rtems_rtl_alloc_placement_find (obj->aname);
+  if (placement == NULL)
+    placement = rtems_rtl_alloc_placement_find (obj->oname);
+
   if (!rtems_rtl_alloc_module_new (&obj->text_base, text_size,
                                    &obj->const_base, const_size,
                                    &obj->eh_base, eh_size,
                                    &obj->data_base, data_size,
-                                   &obj->bss_base, bss_size))
+                                   &obj->bss_base, bss_size,
+                                   (obj->flags & RTEMS_RTL_OBJ_IMAGE) != 0,
+                                   placement))
   {
     obj->exec_size = 0;
     rtems_rtl_set_error (ENOMEM, "no memory to load obj");
@@ -1302,7 +1402,8 @@ rtems_rtl_obj_load_sections (rtems_rtl_obj*             obj,
                                       obj, fd, obj->bss_base, handler, data))
   {
     rtems_rtl_alloc_module_del (&obj->text_base, &obj->const_base, &obj->eh_base,
-                                &obj->data_base, &obj->bss_base);
+                                &obj->data_base, &obj->bss_base,
+                                (obj->flags & RTEMS_RTL_OBJ_IMAGE) != 0);
     obj->exec_size = 0;
     return false;
   }
@@ -1422,7 +1523,8 @@ rtems_rtl_obj_orphaned (rtems_rtl_obj* obj)
 bool
 rtems_rtl_obj_load (rtems_rtl_obj* obj)
 {
-  int fd;
+  int  fd;
+  bool archive_fd = false;
 
   if (!rtems_rtl_obj_fname_valid (obj))
   {
@@ -1430,35 +1532,71 @@ rtems_rtl_obj_load (rtems_rtl_obj* obj)
     return false;
   }
 
-  fd = open (rtems_rtl_obj_fname (obj), O_RDONLY);
-  if (fd < 0)
+  /*
+   * If the object file is in a known archive use the archive's file
+   * descriptor. It is held open for the load and closed when the load ends.
+   */
+  if (rtems_rtl_obj_aname_valid (obj))
   {
-    rtems_rtl_set_error (errno, "opening for object file");
-    return false;
+    if (obj->archive == NULL)
+      obj->archive = rtems_rtl_archive_find (&rtems_rtl_data_unprotected()->archives,
+                                             obj->aname);
+    if (obj->archive != NULL)
+    {
+      fd = rtems_rtl_archive_fd (obj->archive);
+      if (fd < 0)
+      {
+        rtems_rtl_set_error (errno, "opening for object file");
+        return false;
+      }
+      archive_fd = true;
+    }
+  }
+
+  if (!archive_fd)
+  {
+    fd = open (rtems_rtl_obj_fname (obj), O_RDONLY);
+    if (fd < 0)
+    {
+      rtems_rtl_set_error (errno, "opening for object file");
+      return false;
+    }
   }
 
   /*
    * Find the object file in the archive if it is an archive that
-   * has been opened.
+   * has been opened. The archive's member cache avoids scanning the
+   * archive's headers.
    */
   if (rtems_rtl_obj_aname_valid (obj))
   {
-    UBaseType_t enames = 0;
-    if (!rtems_rtl_obj_archive_find_obj (fd,
-                                         obj->fsize,
-                                         &obj->oname,
-                                         &obj->ooffset,
-                                         &obj->fsize,
-                                         &enames,
-                                         rtems_rtl_obj_set_error))
+    if (!archive_fd ||
+        !rtems_rtl_archive_member_locate (obj->archive,
+                                          &obj->oname,
+                                          &obj->ooffset,
+                                          &obj->fsize))
     {
-      close (fd);
-      return false;
+      UBaseType_t  enames = 0;
+      UBaseType_t* extended_names = &enames;
+      if (archive_fd)
+        extended_names = &obj->archive->enames;
+      if (!rtems_rtl_obj_archive_find_obj (fd,
+                                           obj->fsize,
+                                           &obj->oname,
+                                           &obj->ooffset,
+                                           &obj->fsize,
+                                           extended_names,
+                                           rtems_rtl_obj_set_error))
+      {
+        if (!archive_fd)
+          close (fd);
+        return false;
+      }
     }
 
-    obj->archive = rtems_rtl_archive_find(&rtems_rtl_data_unprotected()->archives, obj->aname);
     if (obj->archive == NULL) {
       printf("Failed to find an archive for that object\n");
+      close (fd);
       return false;
     }
   }
@@ -1469,11 +1607,18 @@ rtems_rtl_obj_load (rtems_rtl_obj* obj)
   if (!rtems_rtl_obj_file_load (obj, fd))
   {
     rtems_rtl_set_error (errno, "couldn't find object compartment");
-    close (fd);
+    if (!archive_fd)
+      close (fd);
     return false;
   }
 
-  close (fd);
+  if (!archive_fd)
+    close (fd);
+
+  /*
+   * The global symbols can resolve unresolved externals.
+   */
+  obj->flags |= RTEMS_RTL_OBJ_RESOLVE_NEW;
 
 #ifdef __CHERI_PURE_CAPABILITY__
 #if configCHERI_COMPARTMENTALIZATION_MODE == 1
@@ -1507,10 +1652,7 @@ rtems_rtl_obj_load (rtems_rtl_obj* obj)
     * For GDB
     */
   if (!_rtld_linkmap_add (obj))
-  {
-    close (fd);
     return false;
-  }
 
   return true;
 }
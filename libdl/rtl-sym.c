@@ -51,7 +51,7 @@ static rtems_rtl_obj_sym global_sym_add =
   .value = (uintptr_t) rtems_rtl_base_sym_global_add
 };
 
-static uint_fast32_t
+uint_fast32_t
 rtems_rtl_symbol_hash (const char *s)
 {
   uint_fast32_t h = 5381;
@@ -178,6 +178,8 @@ rtems_rtl_symbol_global_add (rtems_rtl_obj*       obj,
   s = 0;
   sym = obj->global_table;
 
+  rtems_rtl_write_lock ();
+
   while ((s < size) && (esyms[s] != 0))
   {
     /*
@@ -232,6 +234,7 @@ rtems_rtl_symbol_global_add (rtems_rtl_obj*       obj,
       if (!sym->capability) {
         if (rtems_rtl_trace (RTEMS_RTL_TRACE_CHERI))
           printf("rtl:cheri: Failed to install a new cap in %s captable\n", obj->oname);
+        rtems_rtl_write_unlock ();
         return 0;
       }
 #endif
@@ -245,6 +248,8 @@ rtems_rtl_symbol_global_add (rtems_rtl_obj*       obj,
 
   obj->global_syms = count;
 
+  rtems_rtl_write_unlock ();
+
   return true;
 }
 
@@ -352,7 +357,7 @@ rtems_rtl_gsymbol_obj_find (rtems_rtl_obj* obj, const char* name)
   return rtems_rtl_symbol_list_find(&obj->globals_list, name);
 #else
 
-  if (obj == rtems_rtl_baseimage())
+  if ((obj->flags & RTEMS_RTL_OBJ_BASE) != 0)
     return NULL;
 
   rtems_rtl_obj_sym* match = NULL;
@@ -537,8 +542,8 @@ rtems_rtl_isymbol_create (rtems_rtl_obj* obj, isymbol_table_mode_t mode)
     if (obj->global_size == 0)
       return true;
 
-    obj->interface_table = rtems_rtl_alloc_new (RTEMS_RTL_ALLOC_SYMBOL,
-                                            obj->global_size, true);
+    obj->interface_table = rtems_rtl_arena_alloc (&obj->arena,
+                                                  obj->global_size, true);
     if (!obj->interface_table) {
       obj->interface_syms = 0;
       rtems_rtl_set_error (ENOMEM, "no memory for obj interface syms");
@@ -610,7 +615,7 @@ rtems_rtl_isymbol_obj_mint (rtems_rtl_obj* src_obj, rtems_rtl_obj* dest_obj, con
   slen = strlen(name) + 1;
 
   // Allocate a new buffer for the symbol and its name
-  esym = rtems_rtl_alloc_new (RTEMS_RTL_ALLOC_SYMBOL, sizeof(rtems_rtl_obj_sym) + slen, true);
+  esym = rtems_rtl_arena_alloc (&dest_obj->arena, sizeof(rtems_rtl_obj_sym) + slen, true);
   if (!esym) {
     rtems_rtl_set_error (ENOMEM, "no memory for an external symbol");
     return NULL;
@@ -641,8 +646,10 @@ rtems_rtl_isymbol_obj_mint (rtems_rtl_obj* src_obj, rtems_rtl_obj* dest_obj, con
 
   // Add the symbol to the dest_obj extenals list
   vListInitialiseItem(&esym->node);
+  rtems_rtl_write_lock ();
   vListInsertEnd(&dest_obj->externals_list, &esym->node);
   dest_obj->externals_syms++;
+  rtems_rtl_write_unlock ();
 
   return esym;
 }
@@ -822,11 +829,72 @@ rtems_rtl_symbol_obj_add (rtems_rtl_obj* obj)
     rtems_rtl_symbol_global_insert (symbols, sym);
 }
 
+/*
+ * The names of a table's symbols are held in the table's memory after the
+ * symbols. Rebase the names in the table's memory on the new address and
+ * relink the symbols that are on the object's list.
+ */
+static void
+rtems_rtl_symbol_obj_moved (rtems_rtl_alloc_movable* movable, void* old)
+{
+  rtems_rtl_obj*     obj = (rtems_rtl_obj*) movable->arg;
+  char*              base = rtems_rtl_sptr_get (&movable->handle);
+  size_t             size = rtems_rtl_sptr_get_size (&movable->handle);
+  rtems_rtl_obj_sym* table = (rtems_rtl_obj_sym*) base;
+  List_t*            list;
+  size_t             syms;
+  size_t             s;
+
+  if (movable == &obj->local_movable)
+  {
+    obj->local_table = table;
+    syms = obj->local_syms;
+    list = &obj->locals_list;
+  }
+  else
+  {
+    obj->global_table = table;
+    syms = obj->global_syms;
+    list = &obj->globals_list;
+  }
+
+  vListInitialise (list);
+
+  for (s = 0; s < syms; ++s)
+  {
+    rtems_rtl_obj_sym* sym = &table[s];
+    if ((uintptr_t) sym->name >= (uintptr_t) old &&
+        (uintptr_t) sym->name < ((uintptr_t) old + size))
+      sym->name = base + ((uintptr_t) sym->name - (uintptr_t) old);
+    if (listLIST_ITEM_CONTAINER (&sym->node) != NULL)
+    {
+      vListInitialiseItem (&sym->node);
+      vListInsertEnd (list, &sym->node);
+    }
+  }
+}
+
+void
+rtems_rtl_symbol_obj_movable (rtems_rtl_obj* obj)
+{
+  if (obj->local_table != NULL)
+    rtems_rtl_alloc_movable_add (&obj->local_movable,
+                                 RTEMS_RTL_ALLOC_SYMBOL,
+                                 obj->local_table, obj->local_size,
+                                 rtems_rtl_symbol_obj_moved, obj);
+  if (obj->global_table != NULL)
+    rtems_rtl_alloc_movable_add (&obj->global_movable,
+                                 RTEMS_RTL_ALLOC_SYMBOL,
+                                 obj->global_table, obj->global_size,
+                                 rtems_rtl_symbol_obj_moved, obj);
+}
+
 void
 rtems_rtl_symbol_obj_erase_local (rtems_rtl_obj* obj)
 {
   if (obj->local_table)
   {
+    rtems_rtl_alloc_movable_remove (&obj->local_movable);
     rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_SYMBOL, obj->local_table);
     obj->local_table = NULL;
     obj->local_size = 0;
@@ -845,6 +913,7 @@ rtems_rtl_symbol_obj_erase (rtems_rtl_obj* obj)
     for (s = 0, sym = obj->global_table; s < obj->global_syms; ++s, ++sym)
         if (listLIST_ITEM_CONTAINER (&sym->node))
           uxListRemove (&sym->node);
+    rtems_rtl_alloc_movable_remove (&obj->global_movable);
     rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_SYMBOL, obj->global_table);
     obj->global_table = NULL;
     obj->global_size = 0;
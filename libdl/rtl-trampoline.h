@@ -76,7 +76,7 @@ extern "C" {
  */
 bool rtems_rtl_trampoline_add (rtems_rtl_obj*        obj,
                                const uint16_t        flags,
-                               const uint16_t        sect,
+                               const uint32_t        sect,
                                const rtems_rtl_word  symvalue,
                                const rtems_rtl_word* rel);
 
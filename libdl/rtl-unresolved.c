@@ -30,209 +30,327 @@
 #include <rtl/rtl-sym.h>
 #include "rtl-trampoline.h"
 
+/**
+ * The initial number of name hash buckets. The table grows as names are
+ * added.
+ */
+#define RTEMS_RTL_UNRESOLVED_NAME_BUCKETS (32)
+
+/**
+ * The link at the start of each record in a pool.
+ */
+typedef struct rtems_rtl_unresolv_link
+{
+  rtems_rtl_obj*                  obj;  /**< The record's object file. NULL
+                                         *   if free. */
+  struct rtems_rtl_unresolv_link* next; /**< The record's link. */
+} rtems_rtl_unresolv_link;
+
+static void
+rtems_rtl_unresolved_pool_open (rtems_rtl_unresolv_pool* pool,
+                                size_t                   rec_size,
+                                size_t                   block_recs)
+{
+  vListInitialise (&pool->blocks);
+  pool->rec_size = rec_size;
+  pool->block_recs = block_recs;
+  pool->free = NULL;
+  pool->released = 0;
+}
+
+static void
+rtems_rtl_unresolved_pool_close (rtems_rtl_unresolv_pool* pool)
+{
+  ListItem_t* node = listGET_HEAD_ENTRY (&pool->blocks);
+  while (listGET_END_MARKER (&pool->blocks) != node)
+  {
+    ListItem_t* next = listGET_NEXT (node);
+    rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_EXTERNAL, node);
+    node = next;
+  }
+  vListInitialise (&pool->blocks);
+  pool->free = NULL;
+  pool->released = 0;
+}
+
+static rtems_rtl_unresolv_link*
+rtems_rtl_unresolved_pool_rec (rtems_rtl_unresolv_pool*  pool,
+                               rtems_rtl_unresolv_block* block,
+                               size_t                    index)
+{
+  return (rtems_rtl_unresolv_link*) (((char*) &block->rec[0]) +
+                                     (index * pool->rec_size));
+}
+
 static rtems_rtl_unresolv_block*
-rtems_rtl_unresolved_block_alloc (rtems_rtl_unresolved* unresolved)
+rtems_rtl_unresolved_block_alloc (rtems_rtl_unresolv_pool* pool)
 {
-  /*
-   * The block header contains a record.
-   */
   size_t size =
-    (sizeof(rtems_rtl_unresolv_block) +
-     (sizeof(rtems_rtl_unresolv_rec) * unresolved->block_recs));
+    sizeof(rtems_rtl_unresolv_block) + (pool->rec_size * pool->block_recs);
   rtems_rtl_unresolv_block* block =
     rtems_rtl_alloc_new (RTEMS_RTL_ALLOC_EXTERNAL, size, true);
 
-  vListInitialiseItem(&block->link);
-
   if (block)
   {
     if (rtems_rtl_trace (RTEMS_RTL_TRACE_UNRESOLVED))
-      printf ("rtl: unresolv: block-alloc %p (%p)\n", block, block + size);
-    vListInsertEnd (&unresolved->blocks, &block->link);
+      printf ("rtl: unresolv: block-alloc %p (%zu)\n", block, size);
+    vListInitialiseItem (&block->link);
+    vListInsertEnd (&pool->blocks, &block->link);
   }
   else
     rtems_rtl_set_error (ENOMEM, "no memory for unresolved block");
   return block;
 }
 
-static size_t
-rtems_rtl_unresolved_symbol_rec_count (size_t length)
+/**
+ * Allocate a record from the free list or the first block with a record
+ * that has not been allocated.
+ */
+static void*
+rtems_rtl_unresolved_rec_alloc (rtems_rtl_unresolv_pool* pool)
 {
-  const size_t rec_size = sizeof(rtems_rtl_unresolv_rec);
-  const size_t rec_name_header = offsetof(rtems_rtl_unresolv_rec, rec.name.name);
-  /*
-   * Add on the nul and rmeove 1 to be inside a record.
-   */
-  return ((length + rec_name_header - 1) / rec_size) + 1;
-}
+  rtems_rtl_unresolv_block* block;
+  rtems_rtl_unresolv_link*  rec;
+  ListItem_t*               node;
 
-static size_t
-rtems_rtl_unresolved_symbol_recs (const char* name)
-{
-  return rtems_rtl_unresolved_symbol_rec_count (strlen (name) + 1);
-}
+  if (pool->free != NULL)
+  {
+    rec = pool->free;
+    pool->free = rec->next;
+    return rec;
+  }
 
-static int
-rtems_rtl_unresolved_rec_index (rtems_rtl_unresolv_block* block,
-                                rtems_rtl_unresolv_rec*   rec)
-{
-  return rec - &block->rec[0];
+  block = NULL;
+  node = listGET_HEAD_ENTRY (&pool->blocks);
+  while (listGET_END_MARKER (&pool->blocks) != node)
+  {
+    rtems_rtl_unresolv_block* b = (rtems_rtl_unresolv_block*) node;
+    if (b->recs < pool->block_recs)
+    {
+      block = b;
+      break;
+    }
+    node = listGET_NEXT (node);
+  }
+
+  if (block == NULL)
+  {
+    block = rtems_rtl_unresolved_block_alloc (pool);
+    if (block == NULL)
+      return NULL;
+  }
+
+  rec = rtems_rtl_unresolved_pool_rec (pool, block, block->recs);
+  ++block->recs;
+
+  return rec;
 }
 
-static rtems_rtl_unresolv_rec*
-rtems_rtl_unresolved_rec_first (rtems_rtl_unresolv_block* block)
+/**
+ * Release a record to the free list. The record does not move so the
+ * caller can continue to walk a chain it was in.
+ */
+static void
+rtems_rtl_unresolved_rec_release (rtems_rtl_unresolv_pool* pool,
+                                  void*                    record)
 {
-  return &block->rec[0];
+  rtems_rtl_unresolv_link* rec = (rtems_rtl_unresolv_link*) record;
+  memset (rec, 0, pool->rec_size);
+  rec->next = pool->free;
+  pool->free = rec;
+  ++pool->released;
 }
 
-static rtems_rtl_unresolv_rec*
-rtems_rtl_unresolved_rec_next (rtems_rtl_unresolv_rec* rec)
+/**
+ * Release the blocks with no records in use and rebuild the free list from
+ * the blocks remaining. Free records at the end of a block are returned to
+ * the block.
+ */
+static void
+rtems_rtl_unresolved_pool_compact (rtems_rtl_unresolv_pool* pool)
 {
-  switch (rec->type)
+  ListItem_t* node = listGET_HEAD_ENTRY (&pool->blocks);
+
+  pool->free = NULL;
+
+  while (listGET_END_MARKER (&pool->blocks) != node)
   {
-    case rtems_rtl_unresolved_empty:
-    default:
-      /*
-       * Empty returns NULL. The end of the records in the block.
-       */
-      rec = NULL;
-      break;
+    rtems_rtl_unresolv_block* block = (rtems_rtl_unresolv_block*) node;
+    ListItem_t*               next_node = listGET_NEXT (node);
+    uint32_t                  r;
 
-    case rtems_rtl_unresolved_symbol:
-      /*
-       * Determine how many records the name occupies. Round up.
-       */
-      rec += rtems_rtl_unresolved_symbol_rec_count (rec->rec.name.length);
-      break;
+    while (block->recs > 0 &&
+           rtems_rtl_unresolved_pool_rec (pool, block, block->recs - 1)->obj == NULL)
+      --block->recs;
 
-    case rtems_rtl_unresolved_reloc:
-    case rtems_rtl_trampoline_reloc:
-      ++rec;
-      break;
+    /*
+     * Always leave a single block allocated. Eases possible heap
+     * fragmentation.
+     */
+    if (block->recs == 0 && listCURRENT_LIST_LENGTH (&pool->blocks) > 1)
+    {
+      if (rtems_rtl_trace (RTEMS_RTL_TRACE_UNRESOLVED))
+        printf ("rtl: unresolv: block-del %p\n", block);
+      uxListRemove (node);
+      rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_EXTERNAL, block);
+    }
+    else
+    {
+      for (r = 0; r < block->recs; ++r)
+      {
+        rtems_rtl_unresolv_link* rec;
+        rec = rtems_rtl_unresolved_pool_rec (pool, block, r);
+        if (rec->obj == NULL)
+        {
+          rec->next = pool->free;
+          pool->free = rec;
+        }
+      }
+    }
+
+    node = next_node;
   }
 
-  return rec;
+  pool->released = 0;
 }
 
 static bool
-rtems_rtl_unresolved_rec_is_last (rtems_rtl_unresolv_block* block,
-                                  rtems_rtl_unresolv_rec*   rec)
+rtems_rtl_unresolved_pool_iterate (rtems_rtl_unresolv_pool*      pool,
+                                   rtems_rtl_unresolved_rtype    type,
+                                   rtems_rtl_unresolved_iterator iterator,
+                                   void*                         data)
 {
-  int index = rtems_rtl_unresolved_rec_index (block, rec);
-  return (rec == NULL ||
-          (index < 0) ||
-          (index >= block->recs) ||
-          (rec->type == rtems_rtl_unresolved_empty));
+  ListItem_t* node = listGET_HEAD_ENTRY (&pool->blocks);
+  while (listGET_END_MARKER (&pool->blocks) != node)
+  {
+    rtems_rtl_unresolv_block* block = (rtems_rtl_unresolv_block*) node;
+    uint32_t                  r;
+
+    for (r = 0; r < block->recs; ++r)
+    {
+      rtems_rtl_unresolv_link* link;
+      link = rtems_rtl_unresolved_pool_rec (pool, block, r);
+      if (link->obj != NULL)
+      {
+        rtems_rtl_unresolv_rec rec = {
+          .type = type,
+          .rec.reloc = (rtems_rtl_unresolv_reloc*) link
+        };
+        if (iterator (&rec, data))
+          return true;
+      }
+    }
+
+    node = listGET_NEXT (node);
+  }
+  return false;
 }
 
-static rtems_rtl_unresolv_rec*
-rtems_rtl_unresolved_rec_first_free (rtems_rtl_unresolv_block* block)
+static rtems_rtl_unresolv_symbol**
+rtems_rtl_unresolved_name_bucket (rtems_rtl_unresolved* unresolved,
+                                  uint32_t              hash)
 {
-  return &block->rec[0] + block->recs;
+  return &unresolved->names[hash & (unresolved->nbuckets - 1)];
 }
 
 /**
- * Name management iterator data.
+ * Double the number of name hash buckets and rehash the names. A failure
+ * to allocate leaves the table as is, it is only slower.
  */
-typedef struct
+static void
+rtems_rtl_unresolved_name_grow (rtems_rtl_unresolved* unresolved)
 {
-  const char*             name;   /**< The name being searched for. */
-  size_t                  length; /**< The length of the name. */
-  rtems_rtl_unresolv_rec* rec;    /**< The record being searched for. */
-  int                     index;  /**< The name's index. */
-  int                     offset; /**< The offset to move the index. */
-} rtl_unresolved_name_data;
+  rtems_rtl_unresolv_symbol** names;
+  rtems_rtl_unresolv_symbol** old_names = unresolved->names;
+  size_t                      old_nbuckets = unresolved->nbuckets;
+  size_t                      b;
 
-static bool
-rtems_rtl_unresolved_find_name_iterator (rtems_rtl_unresolv_rec* rec,
-                                         void*                   data)
-{
-  rtl_unresolved_name_data* nd = (rtl_unresolved_name_data*) data;
-  if (rec->type == rtems_rtl_unresolved_symbol)
+  names = rtems_rtl_alloc_new (RTEMS_RTL_ALLOC_EXTERNAL,
+                               old_nbuckets * 2 * sizeof (rtems_rtl_unresolv_symbol*),
+                               true);
+  if (names == NULL)
+    return;
+
+  unresolved->names = names;
+  unresolved->nbuckets = old_nbuckets * 2;
+
+  for (b = 0; b < old_nbuckets; ++b)
   {
-    if ((rec->rec.name.length == nd->length)
-        && (strcmp (rec->rec.name.name, nd->name) == 0))
+    rtems_rtl_unresolv_symbol* name = old_names[b];
+    while (name != NULL)
     {
-      ++rec->rec.name.refs;
-      return true;
+      rtems_rtl_unresolv_symbol*  next = name->next;
+      rtems_rtl_unresolv_symbol** bucket;
+      bucket = rtems_rtl_unresolved_name_bucket (unresolved, name->hash);
+      name->next = *bucket;
+      *bucket = name;
+      name = next;
     }
-    ++nd->index;
   }
-  return false;
-}
 
-static int
-rtems_rtl_unresolved_find_name (const char* name)
-{
-  rtl_unresolved_name_data nd = {
-    .name = name,
-    .length = strlen (name) + 1,
-    .rec = NULL,
-    .index = 1,
-    .offset = 0
-  };
-  if (rtems_rtl_unresolved_iterate (rtems_rtl_unresolved_find_name_iterator,
-                                    &nd))
-    return nd.index;
-  return -1;
+  rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_EXTERNAL, old_names);
 }
 
-static bool
-rtems_rtl_unresolved_find_index_iterator (rtems_rtl_unresolv_rec* rec,
-                                          void*                   data)
+static rtems_rtl_unresolv_symbol*
+rtems_rtl_unresolved_find_name (rtems_rtl_unresolved* unresolved,
+                                const char*           name,
+                                uint32_t              hash)
 {
-  rtl_unresolved_name_data* nd = (rtl_unresolved_name_data*) data;
-  if (rec == nd->rec)
-    return true;
-  if (rec->type == rtems_rtl_unresolved_symbol)
-    ++nd->index;
-  return false;
+  rtems_rtl_unresolv_symbol* sym;
+  sym = *rtems_rtl_unresolved_name_bucket (unresolved, hash);
+  while (sym != NULL)
+  {
+    if (sym->hash == hash && strcmp (sym->name, name) == 0)
+      return sym;
+    sym = sym->next;
+  }
+  return NULL;
 }
 
-static int
-rtems_rtl_unresolved_find_index (rtems_rtl_unresolv_rec* rec)
+static void
+rtems_rtl_unresolved_del_name (rtems_rtl_unresolv_symbol* name)
 {
-  rtl_unresolved_name_data nd = {
-    .name = NULL,
-    .length = 0,
-    .rec = rec,
-    .index = 1,
-    .offset = 0
-  };
-  if (rtems_rtl_unresolved_iterate (rtems_rtl_unresolved_find_index_iterator,
-                                    &nd))
-    return nd.index;
-  return -1;
+  rtems_rtl_alloc_slab_del (RTEMS_RTL_ALLOC_EXTERNAL,
+                            sizeof (rtems_rtl_unresolv_symbol) + name->length,
+                            name);
 }
 
-static bool
-rtems_rtl_unresolved_reindex_iterator (rtems_rtl_unresolv_rec* rec,
-                                       void*                   data)
+static rtems_rtl_unresolv_symbol*
+rtems_rtl_unresolved_add_name (rtems_rtl_unresolved* unresolved,
+                               const char*           name,
+                               uint32_t              hash)
 {
-  rtl_unresolved_name_data* nd = (rtl_unresolved_name_data*) data;
-  /*
-   * Reindexing only effects the reloc records.
-   */
-  if (rec->type == rtems_rtl_unresolved_reloc)
+  rtems_rtl_unresolv_symbol** bucket;
+  rtems_rtl_unresolv_symbol*  sym;
+  size_t                      length = strlen (name) + 1;
+
+  sym = rtems_rtl_alloc_slab_new (RTEMS_RTL_ALLOC_EXTERNAL,
+                                  sizeof (rtems_rtl_unresolv_symbol) + length,
+                                  true);
+  if (sym == NULL)
   {
-    if (rec->rec.reloc.name >= nd->index)
-      rec->rec.reloc.name += nd->offset;
+    rtems_rtl_set_error (ENOMEM, "no memory for unresolved name");
+    return NULL;
   }
-  return false;
-}
 
-static void
-rtems_rtl_unresolved_reindex_names (uint16_t index, int offset)
-{
-  rtl_unresolved_name_data nd = {
-    .name = NULL,
-    .length = 0,
-    .rec = NULL,
-    .index = index,
-    .offset = offset
-  };
-  rtems_rtl_unresolved_iterate (rtems_rtl_unresolved_reindex_iterator,
-                                &nd);
+  sym->relocs = NULL;
+  sym->last = NULL;
+  sym->hash = hash;
+  sym->refs = 0;
+  sym->flags =
+    RTEMS_RTL_UNRESOLV_SYM_SEARCH_ARCHIVE | RTEMS_RTL_UNRESOLV_SYM_NEW;
+  sym->length = length;
+  memcpy ((void*) &sym->name[0], name, length);
+
+  if (unresolved->nnames >= unresolved->nbuckets)
+    rtems_rtl_unresolved_name_grow (unresolved);
+
+  bucket = rtems_rtl_unresolved_name_bucket (unresolved, hash);
+  sym->next = *bucket;
+  *bucket = sym;
+  ++unresolved->nnames;
+
+  return sym;
 }
 
 /**
@@ -240,124 +358,235 @@ rtems_rtl_unresolved_reindex_names (uint16_t index, int offset)
  */
 typedef struct rtems_rtl_unresolved_reloc_data
 {
-  uint16_t                name;     /**< Name index. */
-  rtems_rtl_unresolv_rec* name_rec; /**< Name record. */
-  rtems_rtl_obj_sym*      sym;      /**< The symbol record. */
+  uint32_t                   name;     /**< Name count. */
+  rtems_rtl_unresolv_symbol* name_rec; /**< Name record. */
 } rtems_rtl_unresolved_reloc_data;
 
 static bool
-rtems_rtl_unresolved_resolve_reloc (rtems_rtl_unresolv_rec* rec,
-                                    void*                   data)
+rtems_rtl_unresolved_resolve_reloc (rtems_rtl_unresolv_reloc*        reloc,
+                                    rtems_rtl_unresolved_reloc_data* rd)
 {
-  if (rec->type == rtems_rtl_unresolved_reloc)
-  {
-    List_t*             pending;
-    rtems_rtl_unresolved_reloc_data* rd;
+  List_t*            pending;
+  rtems_rtl_obj_sym* sym = NULL;
 
-    rd = (rtems_rtl_unresolved_reloc_data*) data;
+  if (rtems_rtl_trace (RTEMS_RTL_TRACE_UNRESOLVED))
+    printf ("rtl: unresolv: resolve reloc: %s\n",
+            rd->name_rec->name);
 
-    if (rec->rec.reloc.name == rd->name && rec->rec.reloc.obj != NULL)
-    {
+  /*
+   * The object file the symbol is exported from depends on the relocation
+   * record's object file. A local object file only exports its symbols to
+   * the object files loaded with it.
+   */
+  rtems_rtl_obj* obj = rtems_rtl_find_obj_with_symbol_for (rd->name_rec->name,
+                                                           reloc->obj);
+  if (obj)
+    sym = rtems_rtl_isymbol_obj_find (obj, rd->name_rec->name);
+
+  if (sym) {
+    if (rtems_rtl_trace (RTEMS_RTL_TRACE_UNRESOLVED))
+      printf("rtl: unresolv: found symbol %s in object -> %s\n",
+             rd->name_rec->name,
+             obj->oname);
+
+    if (rtems_rtl_isymbol_obj_mint(obj, reloc->obj, rd->name_rec->name)) {
+      if (rtems_rtl_trace (RTEMS_RTL_TRACE_CHERI))
+        printf("rtl: unresolv: minted symbol %s from object: %s -> object: %s\n",
+               rd->name_rec->name,
+               obj->oname,
+               reloc->obj->oname);
+    } else {
       if (rtems_rtl_trace (RTEMS_RTL_TRACE_UNRESOLVED))
-        printf ("rtl: unresolv: resolve reloc: %s\n",
-                rd->name_rec->rec.name.name);
+        printf("rtl: unresolv: failed to mint %s symbol from object: %s -> object: %s\n",
+               rd->name_rec->name,
+               obj->oname,
+               reloc->obj->oname);
+      return false;
+    }
+  } else {
+      if (rtems_rtl_trace (RTEMS_RTL_TRACE_UNRESOLVED))
+        printf("rtl: unresolv: not found: %s -> object: %s\n",
+               rd->name_rec->name,
+               reloc->obj->oname);
+      return false;
+  }
 
-      rtems_rtl_obj* obj = rtems_rtl_find_obj_with_symbol (rd->name_rec->rec.name.name);
-      if (obj) {
-        if (rtems_rtl_trace (RTEMS_RTL_TRACE_UNRESOLVED))
-          printf("rtl: unresolv: found symbol %s in object -> %s\n",
-                 rd->name_rec->rec.name.name,
-                 obj->oname);
-
-        if (rtems_rtl_isymbol_obj_mint(obj, rec->rec.reloc.obj, rd->name_rec->rec.name.name)) {
-          if (rtems_rtl_trace (RTEMS_RTL_TRACE_CHERI))
-            printf("rtl: unresolv: minted symbol %s from object: %s -> object: %s\n",
-                   rd->name_rec->rec.name.name,
-                   obj->oname,
-                   rec->rec.reloc.obj->oname);
-        } else {
-          if (rtems_rtl_trace (RTEMS_RTL_TRACE_UNRESOLVED))
-            printf("rtl: unresolv: failed to mint %s symbol from object: %s -> object: %s\n",
-                   rd->name_rec->rec.name.name,
-                   obj->oname,
-                   rec->rec.reloc.obj->oname);
-          return false;
-        }
-      } else {
-          if (rtems_rtl_trace (RTEMS_RTL_TRACE_UNRESOLVED))
-            printf("rtl: unresolv: failed to mint %s symbol from object: %s -> object: %s\n",
-                   rd->name_rec->rec.name.name,
-                   obj->oname,
-                   rec->rec.reloc.obj->oname);
-          return false;
-      }
+  if (!rtems_rtl_obj_relocate_unresolved (reloc, sym))
+    return false;
 
-      if (rtems_rtl_obj_relocate_unresolved (&rec->rec.reloc, rd->sym))
-      {
-        /*
-         * If all unresolved externals are resolved add the obj module
-         * to the pending queue. This will flush the object module's
-         * data from the cache and call it's constructors.
-         */
-        if (rec->rec.reloc.obj->unresolved == 0)
-        {
-          pending = rtems_rtl_pending_unprotected ();
-          uxListRemove (&rec->rec.reloc.obj->link);
-          vListInsertEnd (pending, &rec->rec.reloc.obj->link);
-        }
+  /*
+   * If all unresolved externals are resolved add the obj module
+   * to the pending queue. This will flush the object module's
+   * data from the cache and call it's constructors. The object file is on
+   * the objects list and readers walk that list so the move is write locked.
+   */
+  if (reloc->obj->unresolved == 0)
+  {
+    pending = rtems_rtl_pending_unprotected ();
+    rtems_rtl_write_lock ();
+    uxListRemove (&reloc->obj->link);
+    vListInsertEnd (pending, &reloc->obj->link);
+    rtems_rtl_write_unlock ();
+  }
 
-        /*
-         * Set the object pointer to NULL to indicate the record is
-         * not used anymore. Update the reference count of the name so
-         * it can garbage collected if not referenced. The sweep after
-         * relocating will remove the reloc records with obj set to
-         * NULL and names with a reference count of 0.
-         */
-        rec->rec.reloc.obj = NULL;
-        if (rd->name_rec != NULL && rd->name_rec->rec.name.refs > 0)
-          --rd->name_rec->rec.name.refs;
-      }
+  return true;
+}
+
+/**
+ * Resolve the relocation records in a name's chain. A resolved record is
+ * unlinked and released. Update the reference count of the name so it can
+ * be garbage collected if not referenced. The compaction after resolving
+ * removes names with a reference count of 0.
+ */
+static void
+rtems_rtl_unresolved_resolve_relocs (rtems_rtl_unresolved*            unresolved,
+                                     rtems_rtl_unresolved_reloc_data* rd)
+{
+  rtems_rtl_unresolv_reloc** link = &rd->name_rec->relocs;
+  rtems_rtl_unresolv_reloc*  last = NULL;
+  while (*link != NULL)
+  {
+    rtems_rtl_unresolv_reloc* reloc = *link;
+    if (rtems_rtl_unresolved_resolve_reloc (reloc, rd))
+    {
+      *link = reloc->next;
+      rtems_rtl_unresolved_rec_release (&unresolved->relocs, reloc);
+      if (rd->name_rec->refs > 0)
+        --rd->name_rec->refs;
+    }
+    else
+    {
+      last = reloc;
+      link = &reloc->next;
     }
   }
-  return false;
+  rd->name_rec->last = last;
+}
+
+static void
+rtems_rtl_unresolved_resolve_name (rtems_rtl_unresolv_symbol*       name,
+                                   rtems_rtl_unresolved_reloc_data* rd)
+{
+  ++rd->name;
+
+  rtems_rtl_load_work (1);
+
+  name->flags &= ~RTEMS_RTL_UNRESOLV_SYM_NEW;
+
+  if (rtems_rtl_trace (RTEMS_RTL_TRACE_UNRESOLVED))
+    printf ("rtl: unresolv: lookup: %" PRIu32 ": %s\n", rd->name, name->name);
+
+  /*
+   * Each relocation record is resolved with the symbol exported to its object
+   * file. A local object file does not export its symbols to all object files
+   * so the name is not looked up once for all the records.
+   */
+  if (name->relocs != NULL)
+  {
+    rd->name_rec = name;
+
+    rtems_rtl_unresolved_resolve_relocs (rtems_rtl_unresolved_unprotected (),
+                                         rd);
+
+    rd->name_rec = NULL;
+  }
 }
 
 static bool
 rtems_rtl_unresolved_resolve_iterator (rtems_rtl_unresolv_rec* rec,
                                        void*                   data)
+{
+  if (rec->type == rtems_rtl_unresolved_symbol)
+    rtems_rtl_unresolved_resolve_name (rec->rec.name,
+                                       (rtems_rtl_unresolved_reloc_data*) data);
+  return false;
+}
+
+static bool
+rtems_rtl_unresolved_resolve_new_iterator (rtems_rtl_unresolv_rec* rec,
+                                           void*                   data)
 {
   if (rec->type == rtems_rtl_unresolved_symbol)
   {
-    rtems_rtl_unresolved_reloc_data* rd;
-    rd = (rtems_rtl_unresolved_reloc_data*) data;
+    if ((rec->rec.name->flags & RTEMS_RTL_UNRESOLV_SYM_NEW) != 0)
+      rtems_rtl_unresolved_resolve_name (rec->rec.name,
+                                         (rtems_rtl_unresolved_reloc_data*) data);
+    return false;
+  }
+  /*
+   * The names are iterated first so stop at the first record.
+   */
+  return true;
+}
 
-    ++rd->name;
+/**
+ * Probe the unresolved names with the object file's global symbols. Only
+ * the names the object file exports can be resolved by loading it.
+ */
+static void
+rtems_rtl_unresolved_resolve_obj (rtems_rtl_unresolved*            unresolved,
+                                  rtems_rtl_obj*                   obj,
+                                  rtems_rtl_unresolved_reloc_data* rd)
+{
+  size_t s;
 
-    if (rtems_rtl_trace (RTEMS_RTL_TRACE_UNRESOLVED))
-      printf ("rtl: unresolv: lookup: %d: %s\n", rd->name, rec->rec.name.name);
+  obj->flags &= ~RTEMS_RTL_OBJ_RESOLVE_NEW;
 
-    // Search for a loaded object that has this symbol
-    rtems_rtl_obj* obj = rtems_rtl_find_obj_with_symbol (rec->rec.name.name);
-    if (obj) {
-      // Search the interface list for that symbol
-      rd->sym = rtems_rtl_isymbol_obj_find(obj, (rec->rec.name.name));
-    }
+  if (rtems_rtl_trace (RTEMS_RTL_TRACE_UNRESOLVED))
+    printf ("rtl: unresolv: probe: %s: %zu globals\n",
+            rtems_rtl_obj_oname (obj), obj->global_syms);
 
-    if (rd->sym)
-    {
-      if (rtems_rtl_trace (RTEMS_RTL_TRACE_UNRESOLVED))
-        printf ("rtl: unresolv: found: %s\n", rec->rec.name.name);
+  for (s = 0; s < obj->global_syms && unresolved->nnames > 0; ++s)
+  {
+    const char*                label = obj->global_table[s].name;
+    rtems_rtl_unresolv_symbol* name;
+    name = rtems_rtl_unresolved_find_name (unresolved,
+                                           label,
+                                           rtems_rtl_symbol_hash (label));
+    if (name != NULL && name->relocs != NULL)
+      rtems_rtl_unresolved_resolve_name (name, rd);
+  }
+}
 
-      rd->name_rec = rec;
+static rtems_rtl_obj*
+rtems_rtl_unresolved_new_obj (List_t* objects)
+{
+  ListItem_t* node = listGET_HEAD_ENTRY (objects);
+  while (listGET_END_MARKER (objects) != node)
+  {
+    rtems_rtl_obj* obj = (rtems_rtl_obj*) node;
+    if ((obj->flags & RTEMS_RTL_OBJ_RESOLVE_NEW) != 0)
+      return obj;
+    node = listGET_NEXT (node);
+  }
+  return NULL;
+}
 
-      rtems_rtl_unresolved_iterate (rtems_rtl_unresolved_resolve_reloc, rd);
+/**
+ * Resolve the names that can have changed since the last resolve. A name
+ * added since the last resolve is searched for in all the object files and
+ * the global symbols of an object file loaded since the last resolve are
+ * probed in the name table. Resolving moves object files from the objects
+ * list to the pending list so the lists are searched again for the next
+ * object file to probe.
+ */
+static void
+rtems_rtl_unresolved_resolve_delta (rtems_rtl_unresolved*            unresolved,
+                                    rtems_rtl_unresolved_reloc_data* rd)
+{
+  rtems_rtl_obj* obj;
 
-      rd->name_rec = NULL;
-      rd->sym = NULL;
-    }
-  }
+  rtems_rtl_unresolved_iterate (rtems_rtl_unresolved_resolve_new_iterator, rd);
 
-  return false;
+  while (true)
+  {
+    obj = rtems_rtl_unresolved_new_obj (rtems_rtl_objects_unprotected ());
+    if (obj == NULL)
+      obj = rtems_rtl_unresolved_new_obj (rtems_rtl_pending_unprotected ());
+    if (obj == NULL)
+      break;
+    rtems_rtl_unresolved_resolve_obj (unresolved, obj, rd);
+  }
 }
 
 /**
@@ -365,9 +594,10 @@ rtems_rtl_unresolved_resolve_iterator (rtems_rtl_unresolv_rec* rec,
  */
 typedef struct rtems_rtl_unresolved_archive_reloc_data
 {
-  uint16_t                 name;     /**< Name index. */
+  uint32_t                 name;     /**< Name count. */
   rtems_rtl_archive_search result;   /**< The result of the load. */
   rtems_rtl_archives*      archives; /**< The archives to search. */
+  rtems_rtl_archive_batch* batch;    /**< The batch if batch loading. */
 } rtems_rtl_unresolved_archive_reloc_data;
 
 static bool
@@ -381,19 +611,19 @@ rtems_rtl_unresolved_archive_iterator (rtems_rtl_unresolv_rec* rec,
 
     ++ard->name;
 
-    if ((rec->rec.name.flags & RTEMS_RTL_UNRESOLV_SYM_SEARCH_ARCHIVE) != 0)
+    if ((rec->rec.name->flags & RTEMS_RTL_UNRESOLV_SYM_SEARCH_ARCHIVE) != 0)
     {
       rtems_rtl_archive_search result;
 
       if (rtems_rtl_trace (RTEMS_RTL_TRACE_UNRESOLVED))
-        printf ("rtl: unresolv: archive lookup: %d: %s\n",
-                ard->name, rec->rec.name.name);
+        printf ("rtl: unresolv: archive lookup: %" PRIu32 ": %s\n",
+                ard->name, rec->rec.name->name);
 
       result = rtems_rtl_archive_obj_load (ard->archives,
-                                           rec->rec.name.name, true);
+                                           rec->rec.name->name, true);
       if (result != rtems_rtl_archive_search_not_found)
       {
-        rec->rec.name.flags &= ~RTEMS_RTL_UNRESOLV_SYM_SEARCH_ARCHIVE;
+        rec->rec.name->flags &= ~RTEMS_RTL_UNRESOLV_SYM_SEARCH_ARCHIVE;
         ard->result = result;
         return true;
       }
@@ -404,63 +634,76 @@ rtems_rtl_unresolved_archive_iterator (rtems_rtl_unresolv_rec* rec,
 }
 
 static bool
-rtems_rtl_unresolved_archive_search_iterator (rtems_rtl_unresolv_rec* rec,
-                                              void*                   data)
+rtems_rtl_unresolved_archive_batch_iterator (rtems_rtl_unresolv_rec* rec,
+                                             void*                   data)
 {
   if (rec->type == rtems_rtl_unresolved_symbol)
-    rec->rec.name.flags |= RTEMS_RTL_UNRESOLV_SYM_SEARCH_ARCHIVE;
+  {
+    rtems_rtl_unresolved_archive_reloc_data* ard;
+    ard = (rtems_rtl_unresolved_archive_reloc_data*) data;
+
+    ++ard->name;
+
+    if ((rec->rec.name->flags & RTEMS_RTL_UNRESOLV_SYM_SEARCH_ARCHIVE) != 0)
+    {
+      rtems_rtl_archive_search result;
+
+      if (rtems_rtl_trace (RTEMS_RTL_TRACE_UNRESOLVED))
+        printf ("rtl: unresolv: archive batch lookup: %" PRIu32 ": %s\n",
+                ard->name, rec->rec.name->name);
+
+      result = rtems_rtl_archive_batch_add (ard->archives,
+                                            ard->batch,
+                                            rec->rec.name->name);
+      if (result != rtems_rtl_archive_search_not_found)
+      {
+        rec->rec.name->flags &= ~RTEMS_RTL_UNRESOLV_SYM_SEARCH_ARCHIVE;
+        if (result != rtems_rtl_archive_search_found)
+        {
+          ard->result = result;
+          return true;
+        }
+      }
+    }
+  }
+
   return false;
 }
 
-static rtems_rtl_unresolv_block*
-rtems_rtl_unresolved_alloc_recs (rtems_rtl_unresolved* unresolved,
-                                 size_t                count)
+static bool
+rtems_rtl_unresolved_archive_search_iterator (rtems_rtl_unresolv_rec* rec,
+                                              void*                   data)
 {
-  ListItem_t* node = listGET_HEAD_ENTRY (&unresolved->blocks);
-  while (listGET_END_MARKER (&unresolved->blocks) != node)
-  {
-    rtems_rtl_unresolv_block* block = (rtems_rtl_unresolv_block*) node;
-
-    if (block->recs + count <= unresolved->block_recs)
-      return block;
-    node = listGET_NEXT (node);
-  }
-  return NULL;
+  if (rec->type == rtems_rtl_unresolved_symbol)
+    rec->rec.name->flags |= RTEMS_RTL_UNRESOLV_SYM_SEARCH_ARCHIVE;
+  return false;
 }
 
+
 static void
-rtems_rtl_unresolved_clean_block (rtems_rtl_unresolv_block* block,
-                                  rtems_rtl_unresolv_rec*   rec,
-                                  size_t                    count,
-                                  size_t                    recs_per_block)
-{
-  size_t index = rtems_rtl_unresolved_rec_index (block, rec);
-  size_t bytes =
-    (block->recs - index - count) * sizeof (rtems_rtl_unresolv_rec);
-  if (bytes)
-    memmove (rec, rec + count, bytes);
-  block->recs -= count;
-  bytes = count * sizeof (rtems_rtl_unresolv_rec);
-  memset (&block->rec[block->recs], 0, bytes);
-}
-
-static ListItem_t*
-rtems_rtl_unresolved_delete_block_if_empty (List_t*      blocks,
-                                            rtems_rtl_unresolv_block* block)
-{
-  ListItem_t* node = &block->link;
-  ListItem_t* next_node = listGET_NEXT (node);
-  /*
-   * Always leave a single block allocated. Eases possible heap fragmentation.
-   */
-  if (block->recs == 0 && listCURRENT_LIST_LENGTH (blocks) > 1)
+rtems_rtl_unresolved_remove_names (rtems_rtl_unresolved* unresolved)
+{
+  size_t b;
+  for (b = 0; b < unresolved->nbuckets; ++b)
   {
-    if (rtems_rtl_trace (RTEMS_RTL_TRACE_UNRESOLVED))
-      printf ("rtl: unresolv: block-del %p\n", block);
-    uxListRemove (node);
-    rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_EXTERNAL, block);
+    rtems_rtl_unresolv_symbol** link = &unresolved->names[b];
+    while (*link != NULL)
+    {
+      rtems_rtl_unresolv_symbol* name = *link;
+      if (name->refs == 0)
+      {
+        if (rtems_rtl_trace (RTEMS_RTL_TRACE_UNRESOLVED))
+          printf ("rtl: unresolv: remove name: %s\n", name->name);
+        *link = name->next;
+        --unresolved->nnames;
+        rtems_rtl_unresolved_del_name (name);
+      }
+      else
+      {
+        link = &name->next;
+      }
+    }
   }
-  return next_node;
 }
 
 static void
@@ -470,55 +713,13 @@ rtems_rtl_unresolved_compact (void)
   if (unresolved)
   {
     /*
-     * Iterate over the blocks removing any empty strings. If a string is
-     * removed update the indexes of all strings above this level.
+     * Remove the names that are not referenced. The records do not move so
+     * nothing else in the table changes. The blocks are only checked if
+     * records have been released.
      */
-    ListItem_t* node = listGET_HEAD_ENTRY (&unresolved->blocks);
-    uint16_t          index = 0;
-    while (listGET_END_MARKER (&unresolved->blocks) != node)
-    {
-      rtems_rtl_unresolv_block* block = (rtems_rtl_unresolv_block*) node;
-      rtems_rtl_unresolv_rec*   rec = rtems_rtl_unresolved_rec_first (block);
-      while (!rtems_rtl_unresolved_rec_is_last (block, rec))
-      {
-        bool next_rec = true;
-
-        if (rec->type == rtems_rtl_unresolved_symbol)
-        {
-          ++index;
-          if (rec->rec.name.refs == 0)
-          {
-            size_t name_recs;
-            if (rtems_rtl_trace (RTEMS_RTL_TRACE_UNRESOLVED))
-              printf ("rtl: unresolv: remove name: %s\n", rec->rec.name.name);
-            rtems_rtl_unresolved_reindex_names (index, -1);
-            /*
-             * Compact the block removing the name record.
-             */
-            name_recs = rtems_rtl_unresolved_symbol_recs (rec->rec.name.name);
-            rtems_rtl_unresolved_clean_block (block, rec, name_recs,
-                                              unresolved->block_recs);
-            --index;
-            next_rec = false;
-          }
-        }
-        else if (rec->type == rtems_rtl_unresolved_reloc)
-        {
-          if (rec->rec.reloc.obj == NULL)
-          {
-            rtems_rtl_unresolved_clean_block (block, rec, 1,
-                                              unresolved->block_recs);
-            next_rec = false;
-          }
-        }
-
-        if (next_rec)
-          rec = rtems_rtl_unresolved_rec_next (rec);
-      }
-
-      node = rtems_rtl_unresolved_delete_block_if_empty (&unresolved->blocks,
-                                                         block);
-    }
+    rtems_rtl_unresolved_remove_names (unresolved);
+    if (unresolved->relocs.released != 0)
+      rtems_rtl_unresolved_pool_compact (&unresolved->relocs);
   }
 }
 
@@ -527,21 +728,47 @@ rtems_rtl_unresolved_table_open (rtems_rtl_unresolved* unresolved,
                                  size_t                block_recs)
 {
   unresolved->marker = 0xdeadf00d;
-  unresolved->block_recs = block_recs;
-  vListInitialise (&unresolved->blocks);
-  return rtems_rtl_unresolved_block_alloc (unresolved);
+  unresolved->nbuckets = RTEMS_RTL_UNRESOLVED_NAME_BUCKETS;
+  unresolved->nnames = 0;
+  unresolved->delta = RTEMS_RTL_UNRESOLVED_DELTA;
+  rtems_rtl_unresolved_pool_open (&unresolved->relocs,
+                                  sizeof (rtems_rtl_unresolv_reloc),
+                                  block_recs);
+  rtems_rtl_unresolved_pool_open (&unresolved->tramps,
+                                  sizeof (rtems_rtl_tramp_reloc),
+                                  block_recs);
+  unresolved->names =
+    rtems_rtl_alloc_new (RTEMS_RTL_ALLOC_EXTERNAL,
+                         unresolved->nbuckets * sizeof (rtems_rtl_unresolv_symbol*),
+                         true);
+  if (unresolved->names == NULL)
+  {
+    rtems_rtl_set_error (ENOMEM, "no memory for unresolved names");
+    return false;
+  }
+  return rtems_rtl_unresolved_block_alloc (&unresolved->relocs);
 }
 
 void
 rtems_rtl_unresolved_table_close (rtems_rtl_unresolved* unresolved)
 {
-  ListItem_t* node = listGET_HEAD_ENTRY (&unresolved->blocks);
-  while (listGET_END_MARKER (&unresolved->blocks) != node)
+  size_t b;
+  rtems_rtl_unresolved_pool_close (&unresolved->relocs);
+  rtems_rtl_unresolved_pool_close (&unresolved->tramps);
+  for (b = 0; b < unresolved->nbuckets; ++b)
   {
-    ListItem_t* next = listGET_NEXT (node);
-    rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_EXTERNAL, node);
-    node = next;
+    rtems_rtl_unresolv_symbol* name = unresolved->names[b];
+    while (name != NULL)
+    {
+      rtems_rtl_unresolv_symbol* next = name->next;
+      rtems_rtl_unresolved_del_name (name);
+      name = next;
+    }
   }
+  rtems_rtl_alloc_del (RTEMS_RTL_ALLOC_EXTERNAL, unresolved->names);
+  unresolved->names = NULL;
+  unresolved->nbuckets = 0;
+  unresolved->nnames = 0;
 }
 
 bool
@@ -551,21 +778,32 @@ rtems_rtl_unresolved_iterate (rtems_rtl_unresolved_iterator iterator,
   rtems_rtl_unresolved* unresolved = rtems_rtl_unresolved_unprotected ();
   if (unresolved)
   {
-    ListItem_t* node = listGET_HEAD_ENTRY (&unresolved->blocks);
-    while (listGET_END_MARKER (&unresolved->blocks) != node)
-    {
-      rtems_rtl_unresolv_block* block = (rtems_rtl_unresolv_block*) node;
-      rtems_rtl_unresolv_rec*   rec = rtems_rtl_unresolved_rec_first (block);
+    size_t b;
 
-      while (!rtems_rtl_unresolved_rec_is_last (block, rec))
+    for (b = 0; b < unresolved->nbuckets; ++b)
+    {
+      rtems_rtl_unresolv_symbol* name = unresolved->names[b];
+      while (name != NULL)
       {
-        if (iterator (rec, data))
+        rtems_rtl_unresolv_rec rec = {
+          .type = rtems_rtl_unresolved_symbol,
+          .rec.name = name
+        };
+        name = name->next;
+        if (iterator (&rec, data))
           return true;
-        rec = rtems_rtl_unresolved_rec_next (rec);
       }
-
-      node = listGET_NEXT (node);
     }
+
+    if (rtems_rtl_unresolved_pool_iterate (&unresolved->relocs,
+                                           rtems_rtl_unresolved_reloc,
+                                           iterator, data))
+      return true;
+
+    if (rtems_rtl_unresolved_pool_iterate (&unresolved->tramps,
+                                           rtems_rtl_trampoline_reloc,
+                                           iterator, data))
+      return true;
   }
   return false;
 }
@@ -574,101 +812,64 @@ bool
 rtems_rtl_unresolved_add (rtems_rtl_obj*        obj,
                           const uint16_t        flags,
                           const char*           name,
-                          const uint16_t        sect,
+                          const uint32_t        sect,
                           const rtems_rtl_word* rel)
 {
-  rtems_rtl_unresolved*     unresolved;
-  rtems_rtl_unresolv_block* block;
-  rtems_rtl_unresolv_rec*   rec;
-  int                       name_index;
+  rtems_rtl_unresolved*      unresolved;
+  rtems_rtl_unresolv_symbol* sym;
+  rtems_rtl_unresolv_reloc*  reloc;
+  uint32_t                   hash;
 
   if (rtems_rtl_trace (RTEMS_RTL_TRACE_UNRESOLVED))
-    printf ("rtl: unresolv: add: %s(s:%d) -> %s\n",
+    printf ("rtl: unresolv: add: %s(s:%" PRIu32 ") -> %s\n",
             rtems_rtl_obj_oname (obj), sect, name);
 
   unresolved = rtems_rtl_unresolved_unprotected ();
   if (!unresolved)
     return false;
 
+  if (sect > RTEMS_RTL_UNRESOLV_RELOC_SECT_MAX || flags > 0xff)
+  {
+    rtems_rtl_set_error (EINVAL, "unresolved reloc section or flags invalid");
+    return false;
+  }
+
   /*
    * Is the name present?
    */
-  name_index = rtems_rtl_unresolved_find_name (name);
+  hash = rtems_rtl_symbol_hash (name);
+  sym = rtems_rtl_unresolved_find_name (unresolved, name, hash);
 
-  /*
-   * An index less than 0 means the name was not found.
-   */
-  if (name_index < 0)
+  if (sym == NULL)
   {
-    size_t name_recs;
-
-    name_recs = rtems_rtl_unresolved_symbol_recs (name);
-
-    /*
-     * Is there enough room to fit the name ? It not add a new block.
-     */
-    block = rtems_rtl_unresolved_alloc_recs (unresolved, name_recs);
-    if (block == NULL)
-    {
-      block = rtems_rtl_unresolved_block_alloc (unresolved);
-      if (!block)
-        return false;
-    }
-
-    /*
-     * Find the record in the block.
-     */
-    rec = rtems_rtl_unresolved_rec_first_free (block);
-
-    /*
-     * Enter the new record before reindexing so the iterator can see
-     * it and the iterator is called.
-     */
-    rec->type = rtems_rtl_unresolved_symbol;
-    rec->rec.name.refs = 1;
-    rec->rec.name.flags = RTEMS_RTL_UNRESOLV_SYM_SEARCH_ARCHIVE;
-    rec->rec.name.length = strlen (name) + 1;
-    memcpy ((void*) &rec->rec.name.name[0], name, rec->rec.name.length);
-    block->recs += name_recs;
-
-    /*
-     * Find the name index for the name and then reindex the names which
-     * are moved up because of the insertion.
-     */
-    name_index = rtems_rtl_unresolved_find_index (rec);
-    if (name_index < 0)
-    {
-      rtems_rtl_set_error (ENOMEM, "internal unresolved block error");
+    sym = rtems_rtl_unresolved_add_name (unresolved, name, hash);
+    if (sym == NULL)
       return false;
-    }
-
     obj->externals_syms++;
-
-    rtems_rtl_unresolved_reindex_names (name_index, 1);
   }
 
-  /*
-   * Find the first block with a spare record.
-   */
-  block = rtems_rtl_unresolved_alloc_recs (unresolved, 1);
-  if (block == NULL)
-  {
-    block = rtems_rtl_unresolved_block_alloc (unresolved);
-    if (!block)
-      return false;
-  }
+  reloc = rtems_rtl_unresolved_rec_alloc (&unresolved->relocs);
+  if (reloc == NULL)
+    return false;
 
-  rec = rtems_rtl_unresolved_rec_first_free (block);
-  rec->type = rtems_rtl_unresolved_reloc;
-  rec->rec.reloc.obj = obj;
-  rec->rec.reloc.flags = flags;
-  rec->rec.reloc.name = name_index;
-  rec->rec.reloc.sect = sect;
-  rec->rec.reloc.rel[0] = rel[0];
-  rec->rec.reloc.rel[1] = rel[1];
-  rec->rec.reloc.rel[2] = rel[2];
+  reloc->obj = obj;
+  reloc->flags = flags;
+  reloc->sect = sect;
+  reloc->rel[0] = rel[0];
+  reloc->rel[1] = rel[1];
+  reloc->rel[2] = rel[2];
 
-  ++block->recs;
+  /*
+   * Append the record to the name's chain so the relocations are resolved
+   * in the order they are added.
+   */
+  reloc->next = NULL;
+  if (sym->last == NULL)
+    sym->relocs = reloc;
+  else
+    sym->last->next = reloc;
+  sym->last = reloc;
+  ++sym->refs;
 
   return true;
 }
@@ -676,11 +877,16 @@ rtems_rtl_unresolved_add (rtems_rtl_obj*        obj,
 void
 rtems_rtl_unresolved_resolve (void)
 {
-  bool resolving = true;
+  rtems_rtl_unresolved* unresolved;
+  bool                  resolving = true;
 
   if (rtems_rtl_trace (RTEMS_RTL_TRACE_UNRESOLVED))
     printf ("rtl: unresolv: global resolve\n");
 
+  unresolved = rtems_rtl_unresolved_unprotected ();
+  if (!unresolved)
+    return;
+
   /*
    * The resolving process is two separate stages, The first stage is to
    * iterate over the unresolved symbols searching the global symbol table. If
@@ -690,23 +896,50 @@ rtems_rtl_unresolved_resolve (void)
    * in an archve load the object file. Loading an object file stops the
    * search of the archives for symbols and stage one is performed again. The
    * process repeats until no more symbols are resolved or there is an error.
+   *
+   * Stage one only looks at the names added and the object files loaded since
+   * the last resolve if the table is resolving by delta. Nothing else can
+   * change the result of a lookup.
+   *
+   * If the archives are batch loaded the second stage searches the archives
+   * for all the symbols and then loads the object files found in archive file
+   * order. Stage one is then performed once for all the object files loaded.
    */
   while (resolving)
   {
     rtems_rtl_unresolved_reloc_data rd = {
       .name = 0,
-      .name_rec = NULL,
-      .sym = NULL
+      .name_rec = NULL
     };
     rtems_rtl_unresolved_archive_reloc_data ard = {
       .name = 0,
       .result = rtems_rtl_archive_search_not_found,
-      .archives = rtems_rtl_archives_unprotected ()
+      .archives = rtems_rtl_archives_unprotected (),
+      .batch = NULL
     };
 
-    rtems_rtl_unresolved_iterate (rtems_rtl_unresolved_resolve_iterator, &rd);
+    if (unresolved->delta)
+      rtems_rtl_unresolved_resolve_delta (unresolved, &rd);
+    else
+      rtems_rtl_unresolved_iterate (rtems_rtl_unresolved_resolve_iterator, &rd);
     rtems_rtl_unresolved_compact ();
-    rtems_rtl_unresolved_iterate (rtems_rtl_unresolved_archive_iterator, &ard);
+
+    if (ard.archives->batch_load)
+    {
+      rtems_rtl_archive_batch batch;
+      rtems_rtl_archive_batch_init (&batch);
+      ard.batch = &batch;
+      rtems_rtl_unresolved_iterate (rtems_rtl_unresolved_archive_batch_iterator,
+                                    &ard);
+      if (ard.result == rtems_rtl_archive_search_not_found)
+        ard.result = rtems_rtl_archive_batch_load (ard.archives, &batch);
+      rtems_rtl_archive_batch_free (&batch);
+    }
+    else
+    {
+      rtems_rtl_unresolved_iterate (rtems_rtl_unresolved_archive_iterator,
+                                    &ard);
+    }
 
     resolving = ard.result == rtems_rtl_archive_search_loaded;
   }
@@ -718,41 +951,33 @@ rtems_rtl_unresolved_resolve (void)
 bool
 rtems_rtl_trampoline_add (rtems_rtl_obj*        obj,
                           const uint16_t        flags,
-                          const uint16_t        sect,
+                          const uint32_t        sect,
                           const rtems_rtl_word  symvalue,
                           const rtems_rtl_word* rel)
 {
-  rtems_rtl_unresolved*     unresolved;
-  rtems_rtl_unresolv_block* block;
-  rtems_rtl_unresolv_rec*   rec;
+  rtems_rtl_unresolved*  unresolved;
+  rtems_rtl_tramp_reloc* tramp;
 
   if (rtems_rtl_trace (RTEMS_RTL_TRACE_UNRESOLVED))
-    printf ("rtl: tramp: add: %s sect:%d flags:%04x\n",
+    printf ("rtl: tramp: add: %s sect:%" PRIu32 " flags:%04x\n",
             rtems_rtl_obj_oname (obj), sect, flags);
 
   unresolved = rtems_rtl_unresolved_unprotected ();
   if (!unresolved)
     return false;
 
-  block = rtems_rtl_unresolved_alloc_recs (unresolved, 1);
-  if (block == NULL)
-  {
-    block = rtems_rtl_unresolved_block_alloc (unresolved);
-    if (!block)
-      return false;
-  }
+  tramp = rtems_rtl_unresolved_rec_alloc (&unresolved->tramps);
+  if (tramp == NULL)
+    return false;
 
-  rec = rtems_rtl_unresolved_rec_first_free (block);
-  rec->type = rtems_rtl_trampoline_reloc;
-  rec->rec.tramp.obj = obj;
-  rec->rec.tramp.flags = flags;
-  rec->rec.tramp.sect = sect;
-  rec->rec.tramp.symvalue = symvalue;
-  rec->rec.tramp.rel[0] = rel[0];
-  rec->rec.tramp.rel[1] = rel[1];
-  rec->rec.tramp.rel[2] = rel[2];
-
-  ++block->recs;
+  tramp->obj = obj;
+  tramp->next = NULL;
+  tramp->flags = flags;
+  tramp->sect = sect;
+  tramp->symvalue = symvalue;
+  tramp->rel[0] = rel[0];
+  tramp->rel[1] = rel[1];
+  tramp->rel[2] = rel[2];
 
   return true;
 }
@@ -763,37 +988,31 @@ rtems_rtl_trampoline_remove (rtems_rtl_obj* obj)
   rtems_rtl_unresolved* unresolved = rtems_rtl_unresolved_unprotected ();
   if (unresolved)
   {
+    rtems_rtl_unresolv_pool* pool = &unresolved->tramps;
+
     /*
-     * Iterate over the blocks clearing any trampoline records.
+     * Iterate over the blocks releasing any trampoline records for the
+     * object file.
      */
-    ListItem_t* node = listGET_HEAD_ENTRY (&unresolved->blocks);
-    while (listGET_END_MARKER (&unresolved->blocks) != node)
+    ListItem_t* node = listGET_HEAD_ENTRY (&pool->blocks);
+    while (listGET_END_MARKER (&pool->blocks) != node)
     {
       rtems_rtl_unresolv_block* block = (rtems_rtl_unresolv_block*) node;
-      rtems_rtl_unresolv_rec*   rec = rtems_rtl_unresolved_rec_first (block);
+      uint32_t                  r;
 
-      /*
-       * Search the table for a trampoline record and if found clean the
-       * record moving the remaining records down the block.
-       */
-      while (!rtems_rtl_unresolved_rec_is_last (block, rec))
+      for (r = 0; r < block->recs; ++r)
       {
-        bool next_rec = true;
-
-        if (rec->type == rtems_rtl_trampoline_reloc && rec->rec.tramp.obj == obj)
-        {
-            rtems_rtl_unresolved_clean_block (block, rec, 1,
-                                              unresolved->block_recs);
-            next_rec = false;
-        }
-
-        if (next_rec)
-          rec = rtems_rtl_unresolved_rec_next (rec);
+        rtems_rtl_unresolv_link* rec;
+        rec = rtems_rtl_unresolved_pool_rec (pool, block, r);
+        if (rec->obj == obj)
+          rtems_rtl_unresolved_rec_release (pool, rec);
       }
 
-      node = rtems_rtl_unresolved_delete_block_if_empty (&unresolved->blocks,
-                                                         block);
+      node = listGET_NEXT (node);
     }
+
+    if (pool->released != 0)
+      rtems_rtl_unresolved_pool_compact (pool);
   }
 }
 
@@ -820,22 +1039,34 @@ rtems_rtl_unresolved_dump_iterator (rtems_rtl_unresolv_rec* rec,
     break;
   case rtems_rtl_unresolved_symbol:
     ++dd->names;
-    printf (" %3zu: 1:  name: %3zu refs:%4d: flags:%04x %s (%d)\n",
+    printf (" %3zu: 1:  name: %3zu refs:%4" PRIu32 ": flags:%04x %s (%" PRIu32 ")\n",
             dd->rec, dd->names,
-            rec->rec.name.refs,
-            rec->rec.name.flags,
-            rec->rec.name.name,
-            rec->rec.name.length);
+            rec->rec.name->refs,
+            rec->rec.name->flags,
+            rec->rec.name->name,
+            rec->rec.name->length);
+    if (dd->show_relocs)
+    {
+      const rtems_rtl_unresolv_reloc* reloc = rec->rec.name->relocs;
+      while (reloc != NULL)
+      {
+        printf ("      2:relocR: obj:%s sect:%" PRIu32 "\n",
+                reloc->obj->oname, reloc->sect);
+        reloc = reloc->next;
+      }
+    }
     break;
   case rtems_rtl_unresolved_reloc:
+    /*
+     * Dumped with the name.
+     */
+    break;
   case rtems_rtl_trampoline_reloc:
     if (dd->show_relocs)
-      printf (" %3d: 2:reloc%c: obj:%s name:%2d: sect:%d\n",
-              rec->type == rtems_rtl_unresolved_reloc ? 'R' : 'T',
+      printf (" %3d: 3:relocT: obj:%s sect:%" PRIu32 "\n",
               (int) dd->rec,
-              rec->rec.reloc.obj == NULL ? "resolved" : rec->rec.reloc.obj->oname,
-              rec->rec.reloc.name,
-              rec->rec.reloc.sect);
+              rec->rec.tramp->obj->oname,
+              rec->rec.tramp->sect);
     break;
   default:
     printf (" %03zu: %d: unknown\n", dd->rec, rec->type);
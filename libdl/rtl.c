@@ -19,10 +19,12 @@
 #include "waf_config.h"
 #endif
 
+#include <dlfcn.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <errno.h>
+#include <inttypes.h>
 
 #include <rtl/rtl.h>
 #include <rtl/rtl-allocator.h>
@@ -119,6 +121,21 @@ rtems_rtl_data_init (void)
        */
       rtems_rtl_alloc_initialise (&rtl->allocator);
 
+      /*
+       * The load scratch memory. The generation starts at 1 so a holder
+       * of scratch memory can use 0 as not held.
+       */
+      rtems_rtl_arena_init (&rtl->scratch,
+                            RTEMS_RTL_ALLOC_OBJECT,
+                            RTEMS_RTL_SCRATCH_CHUNK_SIZE);
+      rtl->scratch_gen = 1;
+
+      /*
+       * The load slice.
+       */
+      rtl->slice.work = configRTL_LOAD_SLICE_WORK;
+      rtl->slice.delay = configRTL_LOAD_SLICE_DELAY;
+
       /*
        * Create the RTL lock.
        */
@@ -264,6 +281,12 @@ rtems_rtl_data_init (void)
       rtl->base->flags |= RTEMS_RTL_OBJ_LOCKED | RTEMS_RTL_OBJ_BASE;
 
       vListInsertEnd (&rtl->objects, &rtl->base->link);
+
+      /*
+       * Create the reader and writer locks.
+       */
+      rtl->writer = xSemaphoreCreateMutex ();
+      rtl->drained = xSemaphoreCreateBinary ();
     }
 
     //rtems_libio_unlock ();
@@ -335,6 +358,40 @@ rtems_rtl_unresolved_unprotected (void)
   return &rtl->unresolved;
 }
 
+void*
+rtems_rtl_scratch_alloc (size_t size, bool zero)
+{
+  if (!rtl)
+  {
+    rtems_rtl_set_error (ENOENT, "no rtl");
+    return NULL;
+  }
+  return rtems_rtl_arena_alloc (&rtl->scratch, size, zero);
+}
+
+uint32_t
+rtems_rtl_scratch_generation (void)
+{
+  if (!rtl)
+    return 0;
+  return rtl->scratch_gen;
+}
+
+/**
+ * Release the scratch memory at the end of a load.
+ */
+static void
+rtems_rtl_scratch_release (void)
+{
+  if (rtl->scratch.chunks != NULL)
+  {
+    rtems_rtl_arena_release (&rtl->scratch);
+    ++rtl->scratch_gen;
+    if (rtl->scratch_gen == 0)
+      rtl->scratch_gen = 1;
+  }
+}
+
 rtems_rtl_archives*
 rtems_rtl_archives_unprotected (void)
 {
@@ -430,6 +487,64 @@ rtems_rtl_obj_update_flags (uint32_t clear, uint32_t set)
                            &flags);
 }
 
+void
+rtems_rtl_load_slice_set (uint32_t work, TickType_t delay)
+{
+  if (rtems_rtl_lock ())
+  {
+    rtl->slice.work = work;
+    rtl->slice.delay = delay;
+    rtl->slice.done = 0;
+    rtl->slice.longest = 0;
+    rtl->slice.yields = 0;
+    rtems_rtl_unlock ();
+  }
+}
+
+void
+rtems_rtl_load_slice_get (rtems_rtl_load_slice* slice)
+{
+  if (rtems_rtl_lock ())
+  {
+    *slice = rtl->slice;
+    rtems_rtl_unlock ();
+  }
+}
+
+/**
+ * End the current slice recording the longest slice.
+ */
+static void
+rtems_rtl_load_slice_end (void)
+{
+  uint32_t time = rtems_rtl_clock () - rtl->slice.start;
+  if (time > rtl->slice.longest)
+    rtl->slice.longest = time;
+  rtl->slice.done = 0;
+}
+
+void
+rtems_rtl_load_work (uint32_t work)
+{
+  if (rtl->slice.work == 0)
+    return;
+
+  rtl->slice.done += work;
+
+  if (rtl->slice.done >= rtl->slice.work)
+  {
+    rtems_rtl_load_slice_end ();
+    ++rtl->slice.yields;
+
+    if (rtl->slice.delay == 0)
+      taskYIELD ();
+    else
+      vTaskDelay (rtl->slice.delay);
+
+    rtl->slice.start = rtems_rtl_clock ();
+  }
+}
+
 rtems_rtl_data*
 rtems_rtl_lock (void)
 {
@@ -447,6 +562,69 @@ rtems_rtl_unlock (void)
   xSemaphoreGiveRecursive (rtl->lock);
 }
 
+rtems_rtl_data*
+rtems_rtl_read_lock (void)
+{
+  if (!rtems_rtl_data_init ())
+    return NULL;
+
+  /*
+   * Pass through the writer lock so a reader waits while a writer holds it.
+   */
+  xSemaphoreTake (rtl->writer, portMAX_DELAY);
+  taskENTER_CRITICAL ();
+  ++rtl->readers;
+  taskEXIT_CRITICAL ();
+  xSemaphoreGive (rtl->writer);
+
+  return rtl;
+}
+
+void
+rtems_rtl_read_unlock (void)
+{
+  bool drained;
+
+  taskENTER_CRITICAL ();
+  --rtl->readers;
+  drained = rtl->readers == 0 && rtl->writing != 0;
+  taskEXIT_CRITICAL ();
+
+  if (drained)
+    xSemaphoreGive (rtl->drained);
+}
+
+void
+rtems_rtl_write_lock (void)
+{
+  /*
+   * Only the holder of the RTL lock can write so the nesting count does not
+   * need protecting. A give of the drained semaphore can be left over from
+   * an earlier write lock so check the readers each time it is taken.
+   */
+  if (rtl->writing++ == 0)
+  {
+    xSemaphoreTake (rtl->writer, portMAX_DELAY);
+    while (true)
+    {
+      UBaseType_t readers;
+      taskENTER_CRITICAL ();
+      readers = rtl->readers;
+      taskEXIT_CRITICAL ();
+      if (readers == 0)
+        break;
+      xSemaphoreTake (rtl->drained, portMAX_DELAY);
+    }
+  }
+}
+
+void
+rtems_rtl_write_unlock (void)
+{
+  if (--rtl->writing == 0)
+    xSemaphoreGive (rtl->writer);
+}
+
 rtems_rtl_obj*
 rtems_rtl_check_handle (void* handle)
 {
@@ -467,10 +645,27 @@ rtems_rtl_check_handle (void* handle)
   return NULL;
 }
 
+static rtems_rtl_obj*
+rtems_rtl_find_obj_in (List_t* objects, const char* aname, const char* oname)
+{
+  ListItem_t* node = listGET_HEAD_ENTRY (objects);
+
+  while (listGET_END_MARKER (objects) != node)
+  {
+    rtems_rtl_obj* obj = (rtems_rtl_obj*) node;
+    if ((aname == NULL && strcmp (obj->oname, oname) == 0) ||
+        (aname != NULL && obj->aname[0] != 0 &&
+         strcmp (obj->aname, aname) == 0 && strcmp (obj->oname, oname) == 0))
+      return obj;
+    node = listGET_NEXT (node);
+  }
+
+  return NULL;
+}
+
 rtems_rtl_obj*
 rtems_rtl_find_obj (const char* name)
 {
-  ListItem_t* node;
   rtems_rtl_obj*    found = NULL;
   const char*       aname = NULL;
   const char*       oname = NULL;
@@ -479,20 +674,13 @@ rtems_rtl_find_obj (const char* name)
   if (!rtems_rtl_parse_name (name, &aname, &oname, &ooffset))
     return NULL;
 
-  node = listGET_HEAD_ENTRY (&rtl->objects);
+  found = rtems_rtl_find_obj_in (&rtl->objects, aname, oname);
 
-  while (listGET_END_MARKER (&rtl->objects) != node)
-  {
-    rtems_rtl_obj* obj = (rtems_rtl_obj*) node;
-    if ((aname == NULL && strcmp (obj->oname, oname) == 0) ||
-        (aname != NULL && obj->aname[0] != 0 &&
-         strcmp (obj->aname, aname) == 0 && strcmp (obj->oname, oname) == 0))
-    {
-      found = obj;
-      break;
-    }
-    node = listGET_NEXT (node);
-  }
+  /*
+   * An object file loaded earlier in a batch is still pending.
+   */
+  if (found == NULL)
+    found = rtems_rtl_find_obj_in (&rtl->pending, aname, oname);
 
   if (aname != NULL)
     rtems_rtl_alloc_del(RTEMS_RTL_ALLOC_OBJECT, (void*) aname);
@@ -503,29 +691,48 @@ rtems_rtl_find_obj (const char* name)
   return found;
 }
 
+/**
+ * Find the object file in a list that exports a symbol to an object file. The
+ * symbols of a local object file are not searched unless the object file the
+ * symbol is for was loaded with it.
+ */
+static rtems_rtl_obj*
+rtems_rtl_find_obj_with_symbol_in (List_t*              objects,
+                                   const char*          sym,
+                                   const rtems_rtl_obj* scope)
+{
+  ListItem_t* node = listGET_HEAD_ENTRY (objects);
+
+  while (listGET_END_MARKER (objects) != node)
+  {
+    rtems_rtl_obj* obj = (rtems_rtl_obj*) node;
+    if (((obj->flags & RTEMS_RTL_OBJ_LOCAL) == 0 ||
+         (scope != NULL && scope->load_group == obj->load_group)) &&
+        rtems_rtl_gsymbol_obj_find (obj, sym))
+      return obj;
+    node = listGET_NEXT (node);
+  }
+
+  return NULL;
+}
+
 rtems_rtl_obj*
 rtems_rtl_find_obj_with_symbol (const char* sym)
 {
+  return rtems_rtl_find_obj_with_symbol_for (sym, NULL);
+}
+
+rtems_rtl_obj*
+rtems_rtl_find_obj_with_symbol_for (const char* sym, const rtems_rtl_obj* obj)
+{
+  rtems_rtl_obj* found = NULL;
   if (sym != NULL)
   {
-    ListItem_t* node = listGET_HEAD_ENTRY (&rtl->objects);
-    while (listGET_END_MARKER (&rtl->objects) != node)
-    {
-      rtems_rtl_obj* obj = (rtems_rtl_obj*) node;
-      if (rtems_rtl_gsymbol_obj_find (obj, sym))
-        return obj;
-      node = listGET_NEXT (node);
-    }
-    node = listGET_HEAD_ENTRY (&rtl->pending);
-    while (listGET_END_MARKER (&rtl->pending) != node)
-    {
-      rtems_rtl_obj* obj = (rtems_rtl_obj*) node;
-      if (rtems_rtl_gsymbol_obj_find (obj, sym))
-        return obj;
-      node = listGET_NEXT (node);
-    }
+    found = rtems_rtl_find_obj_with_symbol_in (&rtl->objects, sym, obj);
+    if (found == NULL)
+      found = rtems_rtl_find_obj_with_symbol_in (&rtl->pending, sym, obj);
   }
-  return NULL;
+  return found;
 }
 
 rtems_rtl_obj*
@@ -540,7 +747,22 @@ rtems_rtl_load_object (const char* name, int mode)
    * See if the object module has already been loaded.
    */
   obj = rtems_rtl_find_obj (name);
-  if (!obj)
+  if (obj != NULL)
+  {
+    /*
+     * A global load of a local object file exports its symbols. Probe its
+     * symbols in the unresolved table as they are new to the other object
+     * files.
+     */
+    if ((mode & RTLD_GLOBAL) != 0 && (obj->flags & RTEMS_RTL_OBJ_LOCAL) != 0)
+    {
+      if (rtems_rtl_trace (RTEMS_RTL_TRACE_LOAD))
+        printf ("rtl: load: global: %s\n", rtems_rtl_obj_oname (obj));
+      obj->flags &= ~RTEMS_RTL_OBJ_LOCAL;
+      obj->flags |= RTEMS_RTL_OBJ_RESOLVE_NEW;
+    }
+  }
+  else
   {
     /*
      * Allocate a new object file descriptor and attempt to load it.
@@ -554,6 +776,22 @@ rtems_rtl_load_object (const char* name, int mode)
 
     vListInsertEnd (&rtl->pending, &obj->link);
 
+    /*
+     * Calls to functions that cannot be resolved are bound on the first call
+     * if the load is lazy.
+     */
+    if ((mode & RTLD_LAZY) != 0)
+      obj->flags |= RTEMS_RTL_OBJ_LAZY;
+
+#if !configCHERI_COMPARTMENTALIZATION && !configMPU_COMPARTMENTALIZATION
+    /*
+     * The global symbols of a local load are only exported to the object
+     * files loaded with it. A compartment's interface is global.
+     */
+    if ((mode & RTLD_LOCAL) != 0)
+      obj->flags |= RTEMS_RTL_OBJ_LOCAL;
+#endif
+
     /*
      * Find the file in the file system using the search path. The fname field
      * will point to a valid file name if found.
@@ -579,8 +817,10 @@ rtems_rtl_load_object (const char* name, int mode)
      */
     if (obj->unresolved != 0)
     {
+      rtems_rtl_write_lock ();
       uxListRemove (&obj->link);
       vListInsertEnd (&rtl->objects, &obj->link);
+      rtems_rtl_write_unlock ();
     }
 
     rtems_rtl_obj_caches_flush ();
@@ -594,76 +834,215 @@ rtems_rtl_load_object (const char* name, int mode)
   return obj;
 }
 
-rtems_rtl_obj*
-rtems_rtl_load (const char* name, int mode)
+/**
+ * Resolve the object files loaded on to the pending list then move them to
+ * the objects list and run their constructors.
+ */
+static void
+rtems_rtl_load_pending (void)
 {
-  rtems_rtl_obj* obj;
+  ListItem_t* node;
 
-  /*
-   * Refesh the archives.
-   */
-  rtems_rtl_archives_refresh (&rtl->archives);
+  rtems_rtl_unresolved_resolve ();
 
   /*
-   * Collect the loaded object files.
+   * Iterator over the pending list of object files that have been loaded.
    */
-  vListInitialise (&rtl->pending);
-
-  obj = rtems_rtl_load_object (name, mode);
-  if (obj != NULL)
+  node = listGET_HEAD_ENTRY (&rtl->pending);
+  while (listGET_END_MARKER (&rtl->pending) != node)
   {
-    ListItem_t* node;
+    rtems_rtl_obj* pobj = (rtems_rtl_obj*) node;
+
+    /*
+     * Move to the next pending object file and place this object file on the
+     * RTL's objects list.
+     */
+    node = listGET_NEXT (&pobj->link);
+    rtems_rtl_write_lock ();
+    uxListRemove (&pobj->link);
+    vListInsertEnd (&rtl->objects, &pobj->link);
+    rtems_rtl_write_unlock ();
+
+    rtems_rtl_obj_post_resolve_reloc (pobj);
 
-    rtems_rtl_unresolved_resolve ();
+    /*
+     * Make sure the object file and cache is synchronized.
+     */
+    rtems_rtl_obj_synchronize_cache (pobj);
 
     /*
-     * Iterator over the pending list of object files that have been loaded.
+     * Run any local constructors if they have not been run. Unlock the linker
+     * to avoid any dead locks if the object file needs to load files or
+     * update the symbol table. We also do not want a constructor to unload
+     * this object file.
      */
-    node = listGET_HEAD_ENTRY (&rtl->pending);
-    while (listGET_END_MARKER (&rtl->pending) != node)
+    if ((pobj->flags & RTEMS_RTL_OBJ_CTOR_RUN) == 0)
     {
-      rtems_rtl_obj* pobj = (rtems_rtl_obj*) node;
+      pobj->flags |= RTEMS_RTL_OBJ_LOCKED | RTEMS_RTL_OBJ_CTOR_RUN;
+      rtems_rtl_unlock ();
+      rtems_rtl_obj_run_ctors (pobj);
+      rtems_rtl_lock ();
+      pobj->flags &= ~RTEMS_RTL_OBJ_LOCKED;
+    }
+  }
+}
 
-      /*
-       * Move to the next pending object file and place this object file on the
-       * RTL's objects list.
-       */
-      node = listGET_NEXT (&pobj->link);
-      uxListRemove (&pobj->link);
-      vListInsertEnd (&rtl->objects, &pobj->link);
+size_t
+rtems_rtl_load_batch (const char**     names,
+                      size_t           count,
+                      int              mode,
+                      rtems_rtl_obj**  objs)
+{
+  size_t loaded = 0;
+  size_t n;
 
-      rtems_rtl_obj_post_resolve_reloc (pobj);
+  /*
+   * Refesh the archives if the refresh mode requires it.
+   */
+  rtems_rtl_archives_refresh_check (&rtl->archives);
 
-      /*
-       * Make sure the object file and cache is synchronized.
-       */
-      rtems_rtl_obj_synchronize_cache (pobj);
+  /*
+   * Start a load slice.
+   */
+  rtl->slice.done = 0;
+  rtl->slice.start = rtems_rtl_clock ();
 
-      /*
-       * Run any local constructors if they have not been run. Unlock the linker
-       * to avoid any dead locks if the object file needs to load files or
-       * update the symbol table. We also do not want a constructor to unload
-       * this object file.
-       */
-      if ((pobj->flags & RTEMS_RTL_OBJ_CTOR_RUN) == 0)
+  /*
+   * The object files loaded in the batch are a load group.
+   */
+  ++rtl->load_group;
+
+  /*
+   * Collect the loaded object files.
+   */
+  vListInitialise (&rtl->pending);
+
+  for (n = 0; n < count; ++n)
+  {
+    objs[n] = rtems_rtl_load_object (names[n], mode);
+    if (objs[n] != NULL)
+      ++loaded;
+  }
+
+  if (loaded > 0)
+  {
+    rtems_rtl_load_pending ();
+
+    for (n = 0; n < count; ++n)
+    {
+      if (objs[n] != NULL && !rtems_rtl_obj_post_resolve_reloc (objs[n]))
       {
-        pobj->flags |= RTEMS_RTL_OBJ_LOCKED | RTEMS_RTL_OBJ_CTOR_RUN;
-        rtems_rtl_unlock ();
-        rtems_rtl_obj_run_ctors (pobj);
-        rtems_rtl_lock ();
-        pobj->flags &= ~RTEMS_RTL_OBJ_LOCKED;
+        objs[n] = NULL;
+        --loaded;
       }
     }
+  }
 
-    if (!rtems_rtl_obj_post_resolve_reloc (obj)) {
-      return NULL;
-    }
+  /*
+   * The load has finished so close the archives and release the scratch
+   * memory.
+   */
+  rtems_rtl_archives_release (&rtl->archives);
+  rtems_rtl_scratch_release ();
+
+  if (rtl->slice.work != 0)
+  {
+    rtems_rtl_load_slice_end ();
+    if (rtems_rtl_trace (RTEMS_RTL_TRACE_LOAD))
+      printf ("rtl: load: slice: yields=%" PRIu32 " longest=%" PRIu32 "\n",
+              rtl->slice.yields, rtl->slice.longest);
+  }
+
+  return loaded;
+}
+
+rtems_rtl_obj*
+rtems_rtl_load_symbol (const char* name, const rtems_rtl_obj* scope)
+{
+  rtems_rtl_obj* obj;
+  List_t         held;
+  bool           nested;
+  uint32_t       group;
+
+  obj = rtems_rtl_find_obj_with_symbol_for (name, scope);
+  if (obj != NULL)
+    return obj;
+
+  /*
+   * A constructor run by a load can call a function that is not bound. The
+   * load is walking its pending list so the object files it has still to
+   * construct are held while the symbol's object file is loaded and then
+   * returned in order. The load walking the list releases the archives and
+   * the scratch memory.
+   */
+  nested = listCURRENT_LIST_LENGTH (&rtl->pending) != 0;
+
+  vListInitialise (&held);
+  while (listCURRENT_LIST_LENGTH (&rtl->pending) != 0)
+  {
+    ListItem_t* node = listGET_HEAD_ENTRY (&rtl->pending);
+    uxListRemove (node);
+    vListInsertEnd (&held, node);
   }
 
+  rtems_rtl_archives_refresh_check (&rtl->archives);
+
+  rtl->slice.done = 0;
+  rtl->slice.start = rtems_rtl_clock ();
+
+  /*
+   * The object file loaded for an object file's call is in the caller's load
+   * group so it can use the symbols of a local load.
+   */
+  group = rtl->load_group;
+  if (scope != NULL)
+    rtl->load_group = scope->load_group;
+  else
+    ++rtl->load_group;
+
+  vListInitialise (&rtl->pending);
+
+  if (rtems_rtl_archive_obj_load (&rtl->archives,
+                                  name, true) == rtems_rtl_archive_search_loaded)
+  {
+    rtems_rtl_load_pending ();
+    obj = rtems_rtl_find_obj_with_symbol_for (name, scope);
+  }
+
+  if (scope != NULL)
+    rtl->load_group = group;
+
+  while (listCURRENT_LIST_LENGTH (&held) != 0)
+  {
+    ListItem_t* node = listGET_HEAD_ENTRY (&held);
+    uxListRemove (node);
+    vListInsertEnd (&rtl->pending, node);
+  }
+
+  if (!nested)
+  {
+    rtems_rtl_archives_release (&rtl->archives);
+    rtems_rtl_scratch_release ();
+  }
+
+  if (rtl->slice.work != 0)
+    rtems_rtl_load_slice_end ();
+
+  if (rtems_rtl_trace (RTEMS_RTL_TRACE_LOAD))
+    printf ("rtl: load: symbol: %s: %s\n",
+            name, obj == NULL ? "not found" : rtems_rtl_obj_oname (obj));
 
   return obj;
 }
 
+rtems_rtl_obj*
+rtems_rtl_load (const char* name, int mode)
+{
+  rtems_rtl_obj* obj;
+  rtems_rtl_load_batch (&name, 1, mode, &obj);
+  return obj;
+}
+
 bool
 rtems_rtl_unload_object (rtems_rtl_obj* obj)
 {
@@ -719,6 +1098,8 @@ rtems_rtl_unload (rtems_rtl_obj* obj)
 
     vListInitialise (&unloading);
 
+    rtems_rtl_write_lock ();
+
     while (orphaned_found)
     {
       orphaned_found = false;
@@ -745,6 +1126,8 @@ rtems_rtl_unload (rtems_rtl_obj* obj)
       }
     }
 
+    rtems_rtl_write_unlock ();
+
     /*
      * Call the desctructors unlocked. An RTL call will not deadlock.
      */
@@ -872,6 +1255,37 @@ rtems_rtl_path_prepend (const char* path)
   return rtems_rtl_path_update (true, path);
 }
 
+bool
+rtems_rtl_archives_refresh_mode (rtems_rtl_archive_refresh mode,
+                                 TickType_t                interval)
+{
+  if (!rtems_rtl_lock ())
+    return false;
+  rtems_rtl_archives_set_refresh (&rtl->archives, mode, interval);
+  rtems_rtl_unlock ();
+  return true;
+}
+
+bool
+rtems_rtl_archives_update (void)
+{
+  if (!rtems_rtl_lock ())
+    return false;
+  rtems_rtl_archives_changed (&rtl->archives);
+  rtems_rtl_unlock ();
+  return true;
+}
+
+bool
+rtems_rtl_archives_batch_load (bool batch)
+{
+  if (!rtems_rtl_lock ())
+    return false;
+  rtems_rtl_archives_set_batch (&rtl->archives, batch);
+  rtems_rtl_unlock ();
+  return true;
+}
+
 void
 rtems_rtl_base_sym_global_add (const unsigned char* esyms,
                                unsigned int         size)